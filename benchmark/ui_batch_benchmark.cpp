@@ -0,0 +1,221 @@
+// Batch benchmark for `/ddb/batch`.
+//
+// Starts the extension's HttpServer in-process on a local port, creates a few
+// tables, and times a set of small independent queries like those the UI runs
+// when it loads (catalog, settings, table previews): sent one `/ddb/run` at a
+// time, and sent together in one `/ddb/batch`, where they run concurrently.
+// Results are written to stdout as one JSON object per line.
+//
+// Usage: ui_batch_benchmark [--port=N] [--queries=N[,N...]]
+//                           [--repetitions=N]
+
+#include "ui_extension.hpp"
+
+#include <duckdb.hpp>
+#include <duckdb/common/serializer/binary_serializer.hpp>
+#include <duckdb/common/serializer/memory_stream.hpp>
+
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#include "httplib.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace httplib = duckdb_httplib_openssl;
+
+namespace duckdb {
+namespace ui {
+
+struct BatchOptions {
+  uint16_t port = 14217;
+  vector<idx_t> query_counts = {10, 40};
+  idx_t repetitions = 5;
+};
+
+constexpr idx_t BATCH_BENCHMARK_TABLES = 8;
+
+static const char *STARTUP_QUERIES[] = {
+    "SELECT * FROM duckdb_databases()",
+    "SELECT * FROM duckdb_schemas()",
+    "SELECT * FROM duckdb_tables()",
+    "SELECT * FROM duckdb_columns()",
+    "SELECT * FROM duckdb_settings()",
+    "SELECT * FROM duckdb_functions() WHERE function_type = 'scalar'"};
+
+// Encoded like the body of a `/ddb/batch` (see BatchRequest).
+struct BenchmarkBatchQuery {
+  std::string sql;
+
+  void Serialize(Serializer &serializer) const {
+    serializer.WriteProperty(101, "sql", sql);
+  }
+};
+
+struct BenchmarkBatchRequest {
+  vector<BenchmarkBatchQuery> queries;
+
+  void Serialize(Serializer &serializer) const {
+    serializer.WriteProperty(100, "queries", queries);
+  }
+};
+
+static void Query(Connection &connection, const std::string &sql) {
+  auto result = connection.Query(sql);
+  if (result->HasError()) {
+    result->ThrowError();
+  }
+}
+
+static vector<std::string> MakeQueries(idx_t query_count) {
+  vector<std::string> queries;
+  const idx_t startup_count =
+      sizeof(STARTUP_QUERIES) / sizeof(STARTUP_QUERIES[0]);
+  for (idx_t i = 0; i < query_count; ++i) {
+    if (i < startup_count) {
+      queries.push_back(STARTUP_QUERIES[i]);
+    } else {
+      queries.push_back(StringUtil::Format(
+          "SELECT * FROM ui_batch_benchmark_%d LIMIT 1000",
+          (i - startup_count) % BATCH_BENCHMARK_TABLES));
+    }
+  }
+  return queries;
+}
+
+static httplib::Headers MakeHeaders(const BatchOptions &options) {
+  return {{"Origin", StringUtil::Format("http://localhost:%d", options.port)},
+          {"X-DuckDB-UI-Connection-Name", "ui_batch_benchmark"},
+          {"X-DuckDB-UI-Request-Description", "ui_batch_benchmark"}};
+}
+
+static double Median(vector<double> timings_ms) {
+  std::sort(timings_ms.begin(), timings_ms.end());
+  return timings_ms[timings_ms.size() / 2];
+}
+
+// Returns the number of frames in a streamed response body.
+static idx_t CountFrames(const std::string &body) {
+  idx_t count = 0;
+  idx_t position = 0;
+  while (position + 4 <= body.size()) {
+    const auto *bytes =
+        reinterpret_cast<const uint8_t *>(body.data() + position);
+    const uint32_t length = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) |
+                            (static_cast<uint32_t>(bytes[3]) << 24);
+    position += 4 + length;
+    ++count;
+  }
+  return count;
+}
+
+static double MeasureSerial(httplib::Client &client,
+                            const BatchOptions &options,
+                            const vector<std::string> &queries) {
+  const auto start = std::chrono::steady_clock::now();
+  for (auto &sql : queries) {
+    auto res = client.Post("/ddb/run", MakeHeaders(options), sql, "text/plain");
+    if (!res || res->status != 200) {
+      throw IOException("Run failed");
+    }
+  }
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+static double MeasureBatch(httplib::Client &client, const BatchOptions &options,
+                           const vector<std::string> &queries) {
+  BenchmarkBatchRequest request;
+  for (auto &sql : queries) {
+    request.queries.push_back({sql});
+  }
+  MemoryStream body;
+  BinarySerializer::Serialize(request, body);
+
+  const auto start = std::chrono::steady_clock::now();
+  auto res = client.Post(
+      "/ddb/batch", MakeHeaders(options),
+      reinterpret_cast<const char *>(body.GetData()), body.GetPosition(),
+      "application/octet-stream");
+  if (!res || res->status != 200 || CountFrames(res->body) != queries.size()) {
+    throw IOException("Batch failed");
+  }
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+} // namespace ui
+} // namespace duckdb
+
+int main(int argc, char **argv) {
+  using namespace duckdb;
+
+  ui::BatchOptions options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (StringUtil::StartsWith(arg, "--port=")) {
+      options.port = static_cast<uint16_t>(std::stoi(arg.substr(7)));
+    } else if (StringUtil::StartsWith(arg, "--queries=")) {
+      options.query_counts.clear();
+      for (auto &count : StringUtil::Split(arg.substr(10), ',')) {
+        options.query_counts.push_back(std::stoull(count));
+      }
+    } else if (StringUtil::StartsWith(arg, "--repetitions=")) {
+      options.repetitions = MaxValue<idx_t>(1, std::stoull(arg.substr(14)));
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--port=N] [--queries=N[,N...]] [--repetitions=N]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  DuckDB db(nullptr);
+  db.LoadStaticExtension<UiExtension>();
+  Connection connection(db);
+  ui::Query(connection,
+            StringUtil::Format("SET ui_local_port = %d", options.port));
+  auto result = connection.Query("CALL start_ui_server()");
+  if (result->HasError()) {
+    result->ThrowError();
+  }
+  std::cerr << result->GetValue(0, 0).ToString() << std::endl;
+
+  for (idx_t i = 0; i < ui::BATCH_BENCHMARK_TABLES; ++i) {
+    ui::Query(connection,
+              StringUtil::Format("CREATE TABLE ui_batch_benchmark_%d AS "
+                                 "SELECT range AS i, hash(range) AS h, "
+                                 "'value ' || range::VARCHAR AS s "
+                                 "FROM range(100000)",
+                                 i));
+  }
+
+  httplib::Client client("localhost", options.port);
+  client.set_keep_alive(true);
+  client.set_read_timeout(std::chrono::minutes(10));
+
+  for (auto query_count : options.query_counts) {
+    auto queries = ui::MakeQueries(query_count);
+    vector<double> serial_ms;
+    vector<double> batch_ms;
+    for (idx_t i = 0; i < options.repetitions; ++i) {
+      serial_ms.push_back(ui::MeasureSerial(client, options, queries));
+      batch_ms.push_back(ui::MeasureBatch(client, options, queries));
+    }
+    const auto median_serial_ms = ui::Median(serial_ms);
+    const auto median_batch_ms = ui::Median(batch_ms);
+    std::cout << StringUtil::Format(
+                     "{\"queries\": %d, \"serial_ms\": %.3f, "
+                     "\"batch_ms\": %.3f, \"speedup\": %.2f}",
+                     query_count, median_serial_ms, median_batch_ms,
+                     median_batch_ms > 0 ? median_serial_ms / median_batch_ms
+                                         : 0.0)
+              << std::endl;
+  }
+
+  connection.Query("CALL stop_ui_server()");
+  return 0;
+}
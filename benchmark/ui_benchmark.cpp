@@ -0,0 +1,328 @@
+// Serialization microbenchmark for the `/ddb/run` result format.
+//
+// Builds representative DataChunks for a range of types and row counts, then
+// measures how long a `ChunkSerializer` takes to encode them, as `/ddb/run`
+// does, with a given number of threads. By default each case runs with the
+// chunks as fetched and again combined into batches, as `/ddb/run` does.
+// Results are written to stdout as one JSON object per line so they can be
+// collected and compared over time.
+//
+// Usage: ui_benchmark [--rows=N[,N...]] [--min-seconds=S] [--case=NAME]
+//                     [--batch-rows=N[,N...]] [--threads=N[,N...]]
+
+#include "chunk_coalescer.hpp"
+#include "utils/serialization.hpp"
+
+#include <duckdb.hpp>
+#include <duckdb/common/serializer/memory_stream.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+// Count heap allocations made through operator new. DuckDB's own buffer
+// allocations go through its Allocator (malloc) and are not included.
+static std::atomic<uint64_t> allocation_count{0};
+
+void *operator new(std::size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace duckdb {
+namespace ui {
+
+struct BenchmarkCase {
+  const char *name;
+  // `%d` is replaced by the row count.
+  const char *sql;
+  // Post-processing applied to each fetched chunk.
+  enum class Shape { FLAT, DICTIONARY, CONSTANT } shape;
+};
+
+static const BenchmarkCase BENCHMARK_CASES[] = {
+    {"integers",
+     "SELECT range::INTEGER AS i, (range * 7)::BIGINT AS b, "
+     "(range %% 3 = 0) AS flag FROM range(%d)",
+     BenchmarkCase::Shape::FLAT},
+    {"decimals",
+     "SELECT (range / 100)::DECIMAL(18, 2) AS d18, "
+     "(range / 3)::DECIMAL(38, 10) AS d38 FROM range(%d)",
+     BenchmarkCase::Shape::FLAT},
+    {"long_strings",
+     "SELECT repeat('duckdb-ui-', 10) || range::VARCHAR AS s FROM "
+     "range(%d)",
+     BenchmarkCase::Shape::FLAT},
+    {"lists",
+     "SELECT [range, range + 1, range + 2] AS l, "
+     "[range::VARCHAR, 'x'] AS sl FROM range(%d)",
+     BenchmarkCase::Shape::FLAT},
+    {"structs",
+     "SELECT {'a': range, 'b': range::VARCHAR, 'c': range / 2} AS s FROM "
+     "range(%d)",
+     BenchmarkCase::Shape::FLAT},
+    {"maps",
+     "SELECT MAP {range::VARCHAR: range, 'k': range + 1} AS m FROM "
+     "range(%d)",
+     BenchmarkCase::Shape::FLAT},
+    {"null_heavy",
+     "SELECT CASE WHEN range %% 10 = 0 THEN range END AS i, "
+     "CASE WHEN range %% 10 = 0 THEN range::VARCHAR END AS s FROM "
+     "range(%d)",
+     BenchmarkCase::Shape::FLAT},
+    {"dictionary",
+     "SELECT 'category-' || (range %% 16)::VARCHAR AS s, range %% 16 AS i "
+     "FROM range(%d)",
+     BenchmarkCase::Shape::DICTIONARY},
+    {"constant", "SELECT 42 AS i, 'constant' AS s FROM range(%d)",
+     BenchmarkCase::Shape::CONSTANT},
+    // A selective filter leaves a few rows in every chunk.
+    {"filtered",
+     "SELECT range AS i, range::VARCHAR AS s, range / 7 AS d FROM range(%d) "
+     "WHERE hash(range) %% 97 = 0",
+     BenchmarkCase::Shape::FLAT},
+};
+
+// Replaces every vector of the chunk with a dictionary vector selecting from
+// the first 16 rows, or with a constant vector holding the first row.
+static void Reshape(DataChunk &chunk, BenchmarkCase::Shape shape) {
+  if (shape == BenchmarkCase::Shape::FLAT || chunk.size() == 0) {
+    return;
+  }
+  for (auto &vector : chunk.data) {
+    if (shape == BenchmarkCase::Shape::CONSTANT) {
+      vector.Reference(vector.GetValue(0));
+      continue;
+    }
+    SelectionVector sel(chunk.size());
+    const idx_t dictionary_size = MinValue<idx_t>(16, chunk.size());
+    for (idx_t i = 0; i < chunk.size(); ++i) {
+      sel.set_index(i, i % dictionary_size);
+    }
+    vector.Slice(sel, chunk.size());
+  }
+}
+
+// Fetches the result as `/ddb/run` does, streaming, so chunks keep the sizes
+// the query produced them in. If `batch_rows` isn't zero, the chunks are
+// combined into batches of that many rows.
+static SuccessResult BuildResult(Connection &connection,
+                                 const BenchmarkCase &benchmark_case,
+                                 idx_t row_count, idx_t batch_rows,
+                                 vector<unique_ptr<DataChunk>> &chunks) {
+  auto result =
+      connection.SendQuery(StringUtil::Format(benchmark_case.sql, row_count));
+  if (result->HasError()) {
+    result->ThrowError();
+  }
+
+  SuccessResult success_result;
+  success_result.column_names_and_types = {result->names, result->types};
+  if (batch_rows > 0) {
+    ChunkCoalescer coalescer(result->types, batch_rows, 0);
+    while (auto chunk = result->Fetch()) {
+      Reshape(*chunk, benchmark_case.shape);
+      coalescer.Append(*chunk, success_result.chunks);
+    }
+    coalescer.Finish(success_result.chunks);
+    return success_result;
+  }
+  while (auto chunk = result->Fetch()) {
+    Reshape(*chunk, benchmark_case.shape);
+    vector<Vector> vectors;
+    for (auto &vector : chunk->data) {
+      Vector reference(vector.GetType());
+      reference.Reference(vector);
+      vectors.push_back(std::move(reference));
+    }
+    success_result.chunks.push_back(
+        {static_cast<uint16_t>(chunk->size()), std::move(vectors)});
+    // Keep the chunk alive; the vectors above reference its buffers.
+    chunks.push_back(std::move(chunk));
+  }
+  return success_result;
+}
+
+// Chunks referencing the vectors of `chunks`, for a ChunkSerializer to take.
+static vector<Chunk> ReferenceChunks(const vector<Chunk> &chunks) {
+  vector<Chunk> references;
+  references.reserve(chunks.size());
+  for (auto &chunk : chunks) {
+    vector<Vector> vectors;
+    for (auto &vector : chunk.vectors) {
+      Vector reference(vector.GetType());
+      reference.Reference(vector);
+      vectors.push_back(std::move(reference));
+    }
+    references.push_back({chunk.row_count, std::move(vectors)});
+  }
+  return references;
+}
+
+// Serializes the result as `/ddb/run` does: the chunks through a
+// ChunkSerializer, then the rest of the result around them. Returns the size
+// in bytes.
+static idx_t Serialize(ClientContext &context, SuccessResult &result,
+                       vector<Chunk> &chunks) {
+  MemoryStream stream;
+  ChunkSerializer serializer(context, stream);
+  serializer.Append(chunks);
+  std::string head;
+  std::string tail;
+  serializer.SerializeResult(result, head, tail);
+  return head.size() + stream.GetPosition() + tail.size();
+}
+
+static void RunCase(Connection &connection,
+                    const BenchmarkCase &benchmark_case, idx_t row_count,
+                    idx_t batch_rows, idx_t threads, double min_seconds) {
+  auto set_threads =
+      connection.Query(StringUtil::Format("SET threads = %d", threads));
+  if (set_threads->HasError()) {
+    set_threads->ThrowError();
+  }
+
+  vector<unique_ptr<DataChunk>> chunks;
+  const auto build_start = std::chrono::steady_clock::now();
+  auto success_result =
+      BuildResult(connection, benchmark_case, row_count, batch_rows, chunks);
+  // The serializer takes the chunks; each run gets references to these.
+  const auto result_chunks = std::move(success_result.chunks);
+  success_result.chunks.clear();
+  const auto build_ms = std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - build_start)
+                            .count();
+
+  // Batching must neither drop nor repeat rows.
+  idx_t result_rows = 0;
+  for (auto &chunk : result_chunks) {
+    result_rows += chunk.row_count;
+  }
+  auto expected = connection.Query(StringUtil::Format(
+      "SELECT count(*) FROM (%s)",
+      StringUtil::Format(benchmark_case.sql, row_count)));
+  if (expected->HasError()) {
+    expected->ThrowError();
+  }
+  const auto expected_rows = expected->GetValue(0, 0).GetValue<int64_t>();
+  if (result_rows != static_cast<idx_t>(expected_rows)) {
+    throw InternalException("Case %s: %d rows serialized, %d expected",
+                            benchmark_case.name, result_rows, expected_rows);
+  }
+
+  // Warm up the allocator and caches.
+  {
+    auto references = ReferenceChunks(result_chunks);
+    Serialize(*connection.context, success_result, references);
+  }
+
+  // Only serializing is timed and counted, not making the references.
+  idx_t iterations = 0;
+  idx_t bytes = 0;
+  uint64_t allocations = 0;
+  double seconds = 0;
+  while (iterations < 3 || seconds < min_seconds) {
+    auto references = ReferenceChunks(result_chunks);
+    const auto allocations_before =
+        allocation_count.load(std::memory_order_relaxed);
+    const auto start = std::chrono::steady_clock::now();
+    bytes = Serialize(*connection.context, success_result, references);
+    seconds += std::chrono::duration<double>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+    allocations +=
+        allocation_count.load(std::memory_order_relaxed) - allocations_before;
+    ++iterations;
+  }
+
+  const auto chunk_count = result_chunks.size();
+  const double seconds_per_iteration = seconds / iterations;
+  std::cout << StringUtil::Format(
+                   "{\"case\": \"%s\", \"rows\": %d, \"batch_rows\": %d, "
+                   "\"threads\": %d, \"chunks\": %d, \"bytes\": %d, "
+                   "\"fetch_ms\": %.3f, "
+                   "\"iterations\": %d, "
+                   "\"seconds_per_iteration\": %.6f, \"mb_per_second\": %.2f, "
+                   "\"rows_per_second\": %.0f, \"allocations_per_chunk\": "
+                   "%.2f}",
+                   benchmark_case.name, row_count, batch_rows, threads,
+                   chunk_count, bytes, build_ms, iterations,
+                   seconds_per_iteration,
+                   bytes / seconds_per_iteration / 1e6,
+                   row_count / seconds_per_iteration,
+                   chunk_count == 0
+                       ? 0.0
+                       : static_cast<double>(allocations) /
+                             (iterations * chunk_count))
+            << std::endl;
+}
+
+} // namespace ui
+} // namespace duckdb
+
+int main(int argc, char **argv) {
+  using namespace duckdb;
+
+  vector<idx_t> row_counts = {1000, 100000, 1000000};
+  // Chunks as fetched, then batched as by default (`ui_result_batch_rows`).
+  vector<idx_t> batch_row_counts = {0, 2048};
+  vector<idx_t> thread_counts = {1};
+  double min_seconds = 1.0;
+  std::string only_case;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (StringUtil::StartsWith(arg, "--rows=")) {
+      row_counts.clear();
+      for (auto &count : StringUtil::Split(arg.substr(7), ',')) {
+        row_counts.push_back(std::stoull(count));
+      }
+    } else if (StringUtil::StartsWith(arg, "--min-seconds=")) {
+      min_seconds = std::stod(arg.substr(14));
+    } else if (StringUtil::StartsWith(arg, "--case=")) {
+      only_case = arg.substr(7);
+    } else if (StringUtil::StartsWith(arg, "--batch-rows=")) {
+      batch_row_counts.clear();
+      for (auto &count : StringUtil::Split(arg.substr(13), ',')) {
+        batch_row_counts.push_back(std::stoull(count));
+      }
+    } else if (StringUtil::StartsWith(arg, "--threads=")) {
+      thread_counts.clear();
+      for (auto &count : StringUtil::Split(arg.substr(10), ',')) {
+        thread_counts.push_back(std::stoull(count));
+      }
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--rows=N[,N...]] [--min-seconds=S] [--case=NAME]"
+                   " [--batch-rows=N[,N...]] [--threads=N[,N...]]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  DuckDB db(nullptr);
+  Connection connection(db);
+  for (auto &benchmark_case : ui::BENCHMARK_CASES) {
+    if (!only_case.empty() && only_case != benchmark_case.name) {
+      continue;
+    }
+    for (auto row_count : row_counts) {
+      for (auto batch_rows : batch_row_counts) {
+        for (auto threads : thread_counts) {
+          ui::RunCase(connection, benchmark_case, row_count, batch_rows,
+                      threads, min_seconds);
+        }
+      }
+    }
+  }
+  return 0;
+}
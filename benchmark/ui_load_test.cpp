@@ -0,0 +1,255 @@
+// End-to-end load generator for the UI HTTP API.
+//
+// Starts the extension's HttpServer in-process on a local port, then drives
+// concurrent `/ddb/run`, `/ddb/tokenize`, `/ddb/interrupt` and `/localEvents`
+// traffic against it with the headers the UI sends. For each concurrency level
+// it reports throughput and latency percentiles per endpoint, one JSON object
+// per line on stdout.
+//
+// Usage: ui_load_test [--port=N] [--concurrency=N[,N...]] [--seconds=S]
+//                     [--event-streams=N] [--query=SQL]
+
+#include "ui_extension.hpp"
+
+#include <duckdb.hpp>
+
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#include "httplib.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace httplib = duckdb_httplib_openssl;
+
+namespace duckdb {
+namespace ui {
+
+enum class LoadEndpoint : uint8_t { RUN = 0, TOKENIZE, INTERRUPT, EVENTS };
+constexpr idx_t LOAD_ENDPOINT_COUNT = 4;
+
+static const char *LoadEndpointPath(LoadEndpoint endpoint) {
+  switch (endpoint) {
+  case LoadEndpoint::RUN:
+    return "/ddb/run";
+  case LoadEndpoint::TOKENIZE:
+    return "/ddb/tokenize";
+  case LoadEndpoint::INTERRUPT:
+    return "/ddb/interrupt";
+  default:
+    return "/localEvents";
+  }
+}
+
+struct LoadOptions {
+  uint16_t port = 14213;
+  vector<idx_t> concurrency_levels = {1, 2, 4, 8, 16};
+  double seconds = 5;
+  idx_t event_streams = 2;
+  std::string query = "SELECT * FROM range(1000) t(i), (SELECT 'x' AS s)";
+};
+
+// Latencies (in ms) and error counts, per endpoint. Each worker owns one, so
+// recording needs no synchronization.
+struct LoadSamples {
+  std::array<vector<double>, LOAD_ENDPOINT_COUNT> latencies_ms;
+  std::array<idx_t, LOAD_ENDPOINT_COUNT> errors = {};
+
+  void Merge(const LoadSamples &other) {
+    for (idx_t i = 0; i < LOAD_ENDPOINT_COUNT; ++i) {
+      latencies_ms[i].insert(latencies_ms[i].end(),
+                             other.latencies_ms[i].begin(),
+                             other.latencies_ms[i].end());
+      errors[i] += other.errors[i];
+    }
+  }
+};
+
+static httplib::Headers MakeHeaders(const LoadOptions &options,
+                                    const std::string &connection_name) {
+  return {{"Origin", StringUtil::Format("http://localhost:%d", options.port)},
+          {"X-DuckDB-UI-Connection-Name", connection_name},
+          {"X-DuckDB-UI-Request-Description", "ui_load_test"},
+          {"X-DuckDB-UI-Result-Row-Limit", "2048"}};
+}
+
+template <typename Func>
+static void Measure(LoadSamples &samples, LoadEndpoint endpoint, Func func) {
+  const auto start = std::chrono::steady_clock::now();
+  const bool ok = func();
+  const auto elapsed_ms = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+  auto i = static_cast<idx_t>(endpoint);
+  if (ok) {
+    samples.latencies_ms[i].push_back(elapsed_ms);
+  } else {
+    samples.errors[i]++;
+  }
+}
+
+// Issues a mix of 7 runs, 2 tokenizes and 1 interrupt per 10 requests.
+static void RunWorker(const LoadOptions &options, idx_t worker_index,
+                      const std::atomic<bool> &stop, LoadSamples &samples) {
+  httplib::Client client("localhost", options.port);
+  client.set_keep_alive(true);
+  const auto connection_name =
+      StringUtil::Format("ui_load_test_%d", worker_index);
+  const auto headers = MakeHeaders(options, connection_name);
+
+  for (idx_t n = 0; !stop; ++n) {
+    const auto slot = n % 10;
+    if (slot < 7) {
+      Measure(samples, LoadEndpoint::RUN, [&] {
+        auto res = client.Post("/ddb/run", headers, options.query,
+                               "text/plain");
+        return res && res->status == 200;
+      });
+    } else if (slot < 9) {
+      Measure(samples, LoadEndpoint::TOKENIZE, [&] {
+        auto res = client.Post("/ddb/tokenize", headers, options.query,
+                               "text/plain");
+        return res && res->status == 200;
+      });
+    } else {
+      Measure(samples, LoadEndpoint::INTERRUPT, [&] {
+        auto res = client.Post("/ddb/interrupt", headers, "", "text/plain");
+        return res && res->status == 200;
+      });
+    }
+  }
+}
+
+// Repeatedly opens an event stream and waits for its first message (an event,
+// or the keep-alive sent when the server's wait times out). Streams refused
+// because of the server's cap on concurrent waits are counted as errors.
+static void RunEventWorker(const LoadOptions &options,
+                           const std::atomic<bool> &stop,
+                           LoadSamples &samples) {
+  httplib::Client client("localhost", options.port);
+  const auto headers = MakeHeaders(options, "");
+  while (!stop) {
+    Measure(samples, LoadEndpoint::EVENTS, [&] {
+      bool received = false;
+      client.Get("/localEvents", headers,
+                 [&](const char *, size_t length) {
+                   received = length > 0;
+                   return false; // one message is enough
+                 });
+      return received;
+    });
+  }
+}
+
+static double Percentile(const vector<double> &sorted, double percentile) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  auto index = static_cast<idx_t>(percentile * (sorted.size() - 1));
+  return sorted[index];
+}
+
+static void RunLevel(const LoadOptions &options, idx_t concurrency) {
+  std::atomic<bool> stop{false};
+  vector<LoadSamples> samples(concurrency + options.event_streams);
+  vector<std::thread> threads;
+  for (idx_t i = 0; i < concurrency; ++i) {
+    threads.emplace_back(RunWorker, std::cref(options), i, std::cref(stop),
+                         std::ref(samples[i]));
+  }
+  for (idx_t i = 0; i < options.event_streams; ++i) {
+    threads.emplace_back(RunEventWorker, std::cref(options), std::cref(stop),
+                         std::ref(samples[concurrency + i]));
+  }
+
+  std::this_thread::sleep_for(
+      std::chrono::duration<double>(options.seconds));
+  stop = true;
+  // Event streams end on the next message; create a table to trigger a
+  // catalog change event instead of waiting for the keep-alive timeout.
+  httplib::Client client("localhost", options.port);
+  client.Post("/ddb/run", MakeHeaders(options, ""),
+              "CREATE OR REPLACE TABLE ui_load_test_wakeup AS SELECT 1",
+              "text/plain");
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  LoadSamples total;
+  for (auto &worker_samples : samples) {
+    total.Merge(worker_samples);
+  }
+  for (idx_t i = 0; i < LOAD_ENDPOINT_COUNT; ++i) {
+    auto &latencies = total.latencies_ms[i];
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << StringUtil::Format(
+                     "{\"concurrency\": %d, \"endpoint\": \"%s\", "
+                     "\"requests\": %d, \"errors\": %d, "
+                     "\"requests_per_second\": %.1f, \"p50_ms\": %.3f, "
+                     "\"p95_ms\": %.3f, \"p99_ms\": %.3f}",
+                     concurrency,
+                     LoadEndpointPath(static_cast<LoadEndpoint>(i)),
+                     latencies.size(), total.errors[i],
+                     latencies.size() / options.seconds,
+                     Percentile(latencies, 0.50), Percentile(latencies, 0.95),
+                     Percentile(latencies, 0.99))
+              << std::endl;
+  }
+}
+
+} // namespace ui
+} // namespace duckdb
+
+int main(int argc, char **argv) {
+  using namespace duckdb;
+
+  ui::LoadOptions options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (StringUtil::StartsWith(arg, "--port=")) {
+      options.port = static_cast<uint16_t>(std::stoi(arg.substr(7)));
+    } else if (StringUtil::StartsWith(arg, "--concurrency=")) {
+      options.concurrency_levels.clear();
+      for (auto &level : StringUtil::Split(arg.substr(14), ',')) {
+        options.concurrency_levels.push_back(std::stoull(level));
+      }
+    } else if (StringUtil::StartsWith(arg, "--seconds=")) {
+      options.seconds = std::stod(arg.substr(10));
+    } else if (StringUtil::StartsWith(arg, "--event-streams=")) {
+      options.event_streams = std::stoull(arg.substr(16));
+    } else if (StringUtil::StartsWith(arg, "--query=")) {
+      options.query = arg.substr(8);
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--port=N] [--concurrency=N[,N...]] [--seconds=S]"
+                   " [--event-streams=N] [--query=SQL]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  DuckDB db(nullptr);
+  db.LoadStaticExtension<UiExtension>();
+  Connection connection(db);
+  auto result = connection.Query(
+      StringUtil::Format("SET ui_local_port = %d", options.port));
+  if (result->HasError()) {
+    result->ThrowError();
+  }
+  result = connection.Query("CALL start_ui_server()");
+  if (result->HasError()) {
+    result->ThrowError();
+  }
+  std::cerr << result->GetValue(0, 0).ToString() << std::endl;
+
+  for (auto concurrency : options.concurrency_levels) {
+    ui::RunLevel(options, concurrency);
+  }
+
+  connection.Query("CALL stop_ui_server()");
+  return 0;
+}
@@ -0,0 +1,179 @@
+// Result table benchmark for `/ddb/run`.
+//
+// Starts the extension's HttpServer in-process on a local port and runs
+// queries that copy their entire result into a result table, once through the
+// direct CREATE TABLE AS path and once through the appender path (by turning
+// `ui_direct_result_tables` off). Each timing covers the run and a follow-up
+// run on the same connection, which waits for the result table to be
+// complete. Each path is run once untimed first, and both must fill tables
+// with the same number of rows. Results are written to stdout as one JSON
+// object per line.
+//
+// Usage: ui_result_table_benchmark [--port=N] [--rows=N[,N...]]
+//                                  [--repetitions=N] [--query=SQL]
+
+#include "ui_extension.hpp"
+
+#include <duckdb.hpp>
+#include <duckdb/common/types/blob.hpp>
+
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#include "httplib.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace httplib = duckdb_httplib_openssl;
+
+namespace duckdb {
+namespace ui {
+
+struct ResultTableOptions {
+  uint16_t port = 14214;
+  vector<idx_t> row_counts = {100000, 1000000, 10000000};
+  idx_t repetitions = 5;
+  // `%d` is replaced by the row count.
+  std::string query = "SELECT range AS i, range * 2 AS j, "
+                      "'row ' || range::VARCHAR AS s FROM range(%d)";
+};
+
+static std::string EncodeBase64(const std::string &str) {
+  return Blob::ToBase64(string_t(str));
+}
+
+static httplib::Headers MakeHeaders(const ResultTableOptions &options,
+                                    const std::string &table_name) {
+  httplib::Headers headers = {
+      {"Origin", StringUtil::Format("http://localhost:%d", options.port)},
+      {"X-DuckDB-UI-Connection-Name", "ui_result_table_benchmark"},
+      {"X-DuckDB-UI-Request-Description", "ui_result_table_benchmark"},
+      {"X-DuckDB-UI-Result-Row-Limit", "2048"}};
+  if (!table_name.empty()) {
+    headers.emplace("X-DuckDB-UI-Result-Table-Name", EncodeBase64(table_name));
+  }
+  return headers;
+}
+
+static bool Post(httplib::Client &client, const ResultTableOptions &options,
+                 const std::string &table_name, const std::string &sql) {
+  auto res = client.Post("/ddb/run", MakeHeaders(options, table_name), sql,
+                         "text/plain");
+  return res && res->status == 200;
+}
+
+// Returns the median time (in ms) to create and wait for a result table, and
+// sets `table_rows` to the rows in the tables.
+static double MeasurePath(Connection &connection,
+                          const ResultTableOptions &options, bool direct,
+                          idx_t row_count, idx_t &table_rows) {
+  auto result = connection.Query(StringUtil::Format(
+      "SET GLOBAL ui_direct_result_tables = %s", direct ? "true" : "false"));
+  if (result->HasError()) {
+    result->ThrowError();
+  }
+
+  httplib::Client client("localhost", options.port);
+  client.set_keep_alive(true);
+  client.set_read_timeout(std::chrono::minutes(10));
+  const auto sql = StringUtil::Format(options.query, row_count);
+
+  vector<double> timings_ms;
+  // The first run warms up the connection and caches, and isn't timed.
+  for (idx_t i = 0; i <= options.repetitions; ++i) {
+    const auto table_name =
+        StringUtil::Format("ui_result_table_benchmark_%d", i);
+    const auto start = std::chrono::steady_clock::now();
+    // The second run waits for the result table of the first to be complete.
+    if (!Post(client, options, table_name, sql) ||
+        !Post(client, options, "",
+              StringUtil::Format("SELECT count(*) FROM memory.main.%s",
+                                 table_name))) {
+      throw IOException("Run failed on table %s", table_name);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    if (i > 0) {
+      timings_ms.push_back(
+          std::chrono::duration<double, std::milli>(elapsed).count());
+    }
+    auto count = connection.Query(StringUtil::Format(
+        "SELECT count(*) FROM memory.main.%s", table_name));
+    if (count->HasError()) {
+      count->ThrowError();
+    }
+    table_rows = count->GetValue(0, 0).GetValue<int64_t>();
+    Post(client, options, "",
+         StringUtil::Format("DROP TABLE memory.main.%s", table_name));
+  }
+  std::sort(timings_ms.begin(), timings_ms.end());
+  return timings_ms[timings_ms.size() / 2];
+}
+
+} // namespace ui
+} // namespace duckdb
+
+int main(int argc, char **argv) {
+  using namespace duckdb;
+
+  ui::ResultTableOptions options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (StringUtil::StartsWith(arg, "--port=")) {
+      options.port = static_cast<uint16_t>(std::stoi(arg.substr(7)));
+    } else if (StringUtil::StartsWith(arg, "--rows=")) {
+      options.row_counts.clear();
+      for (auto &rows : StringUtil::Split(arg.substr(7), ',')) {
+        options.row_counts.push_back(std::stoull(rows));
+      }
+    } else if (StringUtil::StartsWith(arg, "--repetitions=")) {
+      options.repetitions = MaxValue<idx_t>(1, std::stoull(arg.substr(14)));
+    } else if (StringUtil::StartsWith(arg, "--query=")) {
+      options.query = arg.substr(8);
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--port=N] [--rows=N[,N...]] [--repetitions=N]"
+                   " [--query=SQL]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  DuckDB db(nullptr);
+  db.LoadStaticExtension<UiExtension>();
+  Connection connection(db);
+  auto result = connection.Query(
+      StringUtil::Format("SET ui_local_port = %d", options.port));
+  if (result->HasError()) {
+    result->ThrowError();
+  }
+  result = connection.Query("CALL start_ui_server()");
+  if (result->HasError()) {
+    result->ThrowError();
+  }
+  std::cerr << result->GetValue(0, 0).ToString() << std::endl;
+
+  for (auto row_count : options.row_counts) {
+    idx_t appender_rows = 0;
+    idx_t direct_rows = 0;
+    auto appender_ms =
+        ui::MeasurePath(connection, options, false, row_count, appender_rows);
+    auto direct_ms =
+        ui::MeasurePath(connection, options, true, row_count, direct_rows);
+    if (appender_rows != direct_rows) {
+      throw InternalException("Result tables differ: %d rows appended, %d "
+                              "rows with CREATE TABLE AS",
+                              appender_rows, direct_rows);
+    }
+    std::cout << StringUtil::Format(
+                     "{\"rows\": %d, \"table_rows\": %d, "
+                     "\"appender_ms\": %.3f, "
+                     "\"direct_ms\": %.3f, \"speedup\": %.2f}",
+                     row_count, direct_rows, appender_ms, direct_ms,
+                     direct_ms > 0 ? appender_ms / direct_ms : 0.0)
+              << std::endl;
+  }
+
+  connection.Query("CALL stop_ui_server()");
+  return 0;
+}
@@ -0,0 +1,185 @@
+// Sorted preview benchmark for `/ddb/run`.
+//
+// Starts the extension's HttpServer in-process on a local port, creates a
+// large table, and times preview runs of sorted queries over it, with the
+// result row limit applied in the plan (`ui_push_row_limits`) and without
+// (fetching and truncating). Each way is run once untimed first. Besides the
+// time of the whole request, the server's own execute and fetch times are
+// read from its Server-Timing header, which leaves out the HTTP overhead both
+// ways share. Results are written to stdout as one JSON object per line.
+//
+// Usage: ui_row_limit_benchmark [--port=N] [--rows=N[,N...]]
+//                               [--row-limit=N] [--repetitions=N]
+
+#include "ui_extension.hpp"
+
+#include <duckdb.hpp>
+
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#include "httplib.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace httplib = duckdb_httplib_openssl;
+
+namespace duckdb {
+namespace ui {
+
+struct RowLimitOptions {
+  uint16_t port = 14215;
+  vector<idx_t> row_counts = {1000000, 10000000, 50000000};
+  idx_t row_limit = 1000;
+  idx_t repetitions = 5;
+};
+
+static const char *ROW_LIMIT_QUERIES[] = {
+    "SELECT * FROM ui_row_limit_benchmark ORDER BY h",
+    "SELECT * FROM ui_row_limit_benchmark ORDER BY s DESC, i",
+    "SELECT g, count(*) AS n FROM ui_row_limit_benchmark GROUP BY g "
+    "ORDER BY n DESC, g"};
+
+// Median times, in ms, of the runs of one way.
+struct PreviewTimings {
+  double total_ms;
+  // Execute and fetch phases, from the Server-Timing header.
+  double server_ms;
+};
+
+// The sum of the `execute` and `fetch` durations of a Server-Timing header.
+static double GetServerMs(const std::string &server_timing) {
+  double ms = 0;
+  for (auto &entry : StringUtil::Split(server_timing, ',')) {
+    auto trimmed = entry;
+    StringUtil::Trim(trimmed);
+    for (auto phase : {"execute;dur=", "fetch;dur="}) {
+      if (StringUtil::StartsWith(trimmed, phase)) {
+        ms += std::stod(trimmed.substr(strlen(phase)));
+      }
+    }
+  }
+  return ms;
+}
+
+static double Median(vector<double> values) {
+  std::sort(values.begin(), values.end());
+  return values[values.size() / 2];
+}
+
+static void Query(Connection &connection, const std::string &sql) {
+  auto result = connection.Query(sql);
+  if (result->HasError()) {
+    result->ThrowError();
+  }
+}
+
+// Returns the median times of a preview run of `sql`.
+static PreviewTimings MeasurePreview(Connection &connection,
+                                     const RowLimitOptions &options, bool push,
+                                     const std::string &sql) {
+  Query(connection,
+        StringUtil::Format("SET GLOBAL ui_push_row_limits = %s",
+                           push ? "true" : "false"));
+
+  httplib::Client client("localhost", options.port);
+  client.set_keep_alive(true);
+  client.set_read_timeout(std::chrono::minutes(10));
+  const httplib::Headers headers = {
+      {"Origin", StringUtil::Format("http://localhost:%d", options.port)},
+      {"X-DuckDB-UI-Connection-Name", "ui_row_limit_benchmark"},
+      {"X-DuckDB-UI-Request-Description", "ui_row_limit_benchmark"},
+      {"X-DuckDB-UI-Run-Mode", "preview"},
+      {"X-DuckDB-UI-Result-Row-Limit",
+       StringUtil::Format("%d", options.row_limit)}};
+
+  vector<double> total_ms;
+  vector<double> server_ms;
+  // The first run warms up the connection and caches, and isn't timed.
+  for (idx_t i = 0; i <= options.repetitions; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    auto res = client.Post("/ddb/run", headers, sql, "text/plain");
+    if (!res || res->status != 200) {
+      throw IOException("Run failed: %s", sql);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    if (i > 0) {
+      total_ms.push_back(
+          std::chrono::duration<double, std::milli>(elapsed).count());
+      server_ms.push_back(
+          GetServerMs(res->get_header_value("Server-Timing")));
+    }
+  }
+  return {Median(std::move(total_ms)), Median(std::move(server_ms))};
+}
+
+} // namespace ui
+} // namespace duckdb
+
+int main(int argc, char **argv) {
+  using namespace duckdb;
+
+  ui::RowLimitOptions options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (StringUtil::StartsWith(arg, "--port=")) {
+      options.port = static_cast<uint16_t>(std::stoi(arg.substr(7)));
+    } else if (StringUtil::StartsWith(arg, "--rows=")) {
+      options.row_counts.clear();
+      for (auto &rows : StringUtil::Split(arg.substr(7), ',')) {
+        options.row_counts.push_back(std::stoull(rows));
+      }
+    } else if (StringUtil::StartsWith(arg, "--row-limit=")) {
+      options.row_limit = std::stoull(arg.substr(12));
+    } else if (StringUtil::StartsWith(arg, "--repetitions=")) {
+      options.repetitions = MaxValue<idx_t>(1, std::stoull(arg.substr(14)));
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--port=N] [--rows=N[,N...]] [--row-limit=N]"
+                   " [--repetitions=N]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  DuckDB db(nullptr);
+  db.LoadStaticExtension<UiExtension>();
+  Connection connection(db);
+  ui::Query(connection,
+            StringUtil::Format("SET ui_local_port = %d", options.port));
+  auto result = connection.Query("CALL start_ui_server()");
+  if (result->HasError()) {
+    result->ThrowError();
+  }
+  std::cerr << result->GetValue(0, 0).ToString() << std::endl;
+
+  for (auto row_count : options.row_counts) {
+    ui::Query(connection,
+              StringUtil::Format(
+                  "CREATE OR REPLACE TABLE ui_row_limit_benchmark AS "
+                  "SELECT range AS i, hash(range) AS h, range %% 1000 AS g, "
+                  "'value ' || (range * 7919 %% %d)::VARCHAR AS s "
+                  "FROM range(%d)",
+                  row_count, row_count));
+    for (auto sql : ui::ROW_LIMIT_QUERIES) {
+      auto fetch = ui::MeasurePreview(connection, options, false, sql);
+      auto pushed = ui::MeasurePreview(connection, options, true, sql);
+      std::cout << StringUtil::Format(
+                       "{\"rows\": %d, \"row_limit\": %d, \"query\": \"%s\", "
+                       "\"fetch_ms\": %.3f, \"pushed_ms\": %.3f, "
+                       "\"speedup\": %.2f, \"fetch_server_ms\": %.3f, "
+                       "\"pushed_server_ms\": %.3f}",
+                       row_count, options.row_limit, sql, fetch.total_ms,
+                       pushed.total_ms,
+                       pushed.total_ms > 0 ? fetch.total_ms / pushed.total_ms
+                                           : 0.0,
+                       fetch.server_ms, pushed.server_ms)
+                << std::endl;
+    }
+  }
+
+  connection.Query("CALL stop_ui_server()");
+  return 0;
+}
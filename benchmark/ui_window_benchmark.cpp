@@ -0,0 +1,190 @@
+// Held result window benchmark for `/ddb/window`.
+//
+// Starts the extension's HttpServer in-process on a local port, creates a
+// large table, and holds the result of selecting all of it. It then times
+// scrolling through that result re-sorted on a column: through `/ddb/window`
+// (the first window sorts and caches the row indexes, later ones only copy
+// the visible rows) and by re-running the query with ORDER BY, LIMIT and
+// OFFSET. Results are written to stdout as one JSON object per line.
+//
+// Usage: ui_window_benchmark [--port=N] [--rows=N[,N...]]
+//                            [--window=N] [--windows=N]
+
+#include "ui_extension.hpp"
+
+#include <duckdb.hpp>
+
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#include "httplib.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace httplib = duckdb_httplib_openssl;
+
+namespace duckdb {
+namespace ui {
+
+struct WindowOptions {
+  uint16_t port = 14216;
+  vector<idx_t> row_counts = {1000000, 10000000};
+  idx_t window = 100;
+  idx_t windows = 50;
+};
+
+static void Query(Connection &connection, const std::string &sql) {
+  auto result = connection.Query(sql);
+  if (result->HasError()) {
+    result->ThrowError();
+  }
+}
+
+static httplib::Headers MakeHeaders(const WindowOptions &options) {
+  return {{"Origin", StringUtil::Format("http://localhost:%d", options.port)},
+          {"X-DuckDB-UI-Connection-Name", "ui_window_benchmark"},
+          {"X-DuckDB-UI-Request-Description", "ui_window_benchmark"}};
+}
+
+static double ElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+static double Median(vector<double> timings_ms) {
+  std::sort(timings_ms.begin(), timings_ms.end());
+  return timings_ms[timings_ms.size() / 2];
+}
+
+} // namespace ui
+} // namespace duckdb
+
+int main(int argc, char **argv) {
+  using namespace duckdb;
+
+  ui::WindowOptions options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (StringUtil::StartsWith(arg, "--port=")) {
+      options.port = static_cast<uint16_t>(std::stoi(arg.substr(7)));
+    } else if (StringUtil::StartsWith(arg, "--rows=")) {
+      options.row_counts.clear();
+      for (auto &rows : StringUtil::Split(arg.substr(7), ',')) {
+        options.row_counts.push_back(std::stoull(rows));
+      }
+    } else if (StringUtil::StartsWith(arg, "--window=")) {
+      options.window = MaxValue<idx_t>(1, std::stoull(arg.substr(9)));
+    } else if (StringUtil::StartsWith(arg, "--windows=")) {
+      options.windows = MaxValue<idx_t>(1, std::stoull(arg.substr(10)));
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--port=N] [--rows=N[,N...]] [--window=N] [--windows=N]"
+                << std::endl;
+      return 1;
+    }
+  }
+
+  DuckDB db(nullptr);
+  db.LoadStaticExtension<UiExtension>();
+  Connection connection(db);
+  ui::Query(connection,
+            StringUtil::Format("SET ui_local_port = %d", options.port));
+  auto result = connection.Query("CALL start_ui_server()");
+  if (result->HasError()) {
+    result->ThrowError();
+  }
+  std::cerr << result->GetValue(0, 0).ToString() << std::endl;
+
+  httplib::Client client("localhost", options.port);
+  client.set_keep_alive(true);
+  client.set_read_timeout(std::chrono::minutes(10));
+  std::mt19937_64 random(42);
+
+  for (auto row_count : options.row_counts) {
+    ui::Query(connection,
+              StringUtil::Format(
+                  "CREATE OR REPLACE TABLE ui_window_benchmark AS "
+                  "SELECT range AS i, hash(range) AS h, "
+                  "'value ' || (range * 7919 %% %d)::VARCHAR AS s "
+                  "FROM range(%d)",
+                  row_count, row_count));
+
+    auto run_headers = ui::MakeHeaders(options);
+    run_headers.emplace("X-DuckDB-UI-Hold-Result", "true");
+    run_headers.emplace("X-DuckDB-UI-Result-Row-Limit",
+                        StringUtil::Format("%d", options.window));
+    auto start = std::chrono::steady_clock::now();
+    auto res = client.Post("/ddb/run", run_headers,
+                           "SELECT * FROM ui_window_benchmark", "text/plain");
+    if (!res || res->status != 200) {
+      throw IOException("Run failed");
+    }
+    const auto hold_ms = ui::ElapsedMs(start);
+
+    std::uniform_int_distribution<idx_t> offsets(
+        0, row_count > options.window ? row_count - options.window : 0);
+    vector<idx_t> window_offsets;
+    for (idx_t i = 0; i < options.windows; ++i) {
+      window_offsets.push_back(offsets(random));
+    }
+
+    // Sorted on `h`, descending; the first window builds the row indexes.
+    vector<double> window_ms;
+    double first_window_ms = 0;
+    for (idx_t i = 0; i < window_offsets.size(); ++i) {
+      auto window_headers = ui::MakeHeaders(options);
+      window_headers.emplace("X-DuckDB-UI-Window-Offset",
+                             StringUtil::Format("%d", window_offsets[i]));
+      window_headers.emplace("X-DuckDB-UI-Window-Limit",
+                             StringUtil::Format("%d", options.window));
+      window_headers.emplace("X-DuckDB-UI-Sort-Count", "1");
+      window_headers.emplace("X-DuckDB-UI-Sort-Column-0", "1");
+      window_headers.emplace("X-DuckDB-UI-Sort-Descending-0", "true");
+      start = std::chrono::steady_clock::now();
+      res = client.Post("/ddb/window", window_headers, "", "text/plain");
+      if (!res || res->status != 200) {
+        throw IOException("Window failed");
+      }
+      if (i == 0) {
+        first_window_ms = ui::ElapsedMs(start);
+      } else {
+        window_ms.push_back(ui::ElapsedMs(start));
+      }
+    }
+
+    // The same windows, by re-running the query. Not holding the result.
+    vector<double> rerun_ms;
+    for (auto offset : window_offsets) {
+      start = std::chrono::steady_clock::now();
+      res = client.Post(
+          "/ddb/run", ui::MakeHeaders(options),
+          StringUtil::Format("SELECT * FROM ui_window_benchmark "
+                             "ORDER BY h DESC LIMIT %d OFFSET %d",
+                             options.window, offset),
+          "text/plain");
+      if (!res || res->status != 200) {
+        throw IOException("Run failed");
+      }
+      rerun_ms.push_back(ui::ElapsedMs(start));
+    }
+
+    const auto median_window_ms =
+        window_ms.empty() ? first_window_ms : ui::Median(window_ms);
+    const auto median_rerun_ms = ui::Median(rerun_ms);
+    std::cout << StringUtil::Format(
+                     "{\"rows\": %d, \"window\": %d, \"hold_ms\": %.3f, "
+                     "\"first_window_ms\": %.3f, \"window_ms\": %.3f, "
+                     "\"rerun_ms\": %.3f, \"speedup\": %.2f}",
+                     row_count, options.window, hold_ms, first_window_ms,
+                     median_window_ms, median_rerun_ms,
+                     median_window_ms > 0 ? median_rerun_ms / median_window_ms
+                                          : 0.0)
+              << std::endl;
+  }
+
+  connection.Query("CALL stop_ui_server()");
+  return 0;
+}
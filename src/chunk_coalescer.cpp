@@ -0,0 +1,89 @@
+#include "chunk_coalescer.hpp"
+
+#include <limits>
+
+namespace duckdb {
+namespace ui {
+
+// `Chunk::row_count` is a uint16_t.
+constexpr idx_t MAX_BATCH_ROWS = std::numeric_limits<uint16_t>::max();
+
+// Used for nested values, whose size we don't compute.
+constexpr idx_t NESTED_VALUE_SIZE_ESTIMATE = 16;
+
+ChunkCoalescer::ChunkCoalescer(const duckdb::vector<LogicalType> &_types,
+                               idx_t _target_rows, idx_t _target_bytes)
+    : types(_types),
+      target_rows(MinValue(MaxValue<idx_t>(_target_rows, 1), MAX_BATCH_ROWS)),
+      target_bytes(_target_bytes), batch_bytes(0) {}
+
+void ChunkCoalescer::Append(DataChunk &chunk,
+                            duckdb::vector<Chunk> &batches) {
+  if (chunk.size() == 0) {
+    return;
+  }
+  const auto chunk_bytes = target_bytes > 0 ? EstimateSize(chunk) : 0;
+  const auto large_enough =
+      chunk.size() >= target_rows ||
+      (target_bytes > 0 && chunk_bytes >= target_bytes);
+
+  // Keep the rows in order: a pending batch goes out before anything after it.
+  if (batch && (large_enough || batch->size() + chunk.size() > target_rows)) {
+    Finish(batches);
+  }
+  if (large_enough) {
+    Emit(chunk, batches);
+    return;
+  }
+
+  if (!batch) {
+    batch = make_uniq<DataChunk>();
+    batch->Initialize(Allocator::DefaultAllocator(), types, target_rows);
+    batch_bytes = 0;
+  }
+  batch->Append(chunk, true);
+  batch_bytes += chunk_bytes;
+  if (batch->size() >= target_rows ||
+      (target_bytes > 0 && batch_bytes >= target_bytes)) {
+    Finish(batches);
+  }
+}
+
+void ChunkCoalescer::Finish(duckdb::vector<Chunk> &batches) {
+  if (batch && batch->size() > 0) {
+    Emit(*batch, batches);
+  }
+  batch.reset();
+  batch_bytes = 0;
+}
+
+idx_t ChunkCoalescer::EstimateSize(DataChunk &chunk) {
+  idx_t size = 0;
+  for (auto &vector : chunk.data) {
+    auto physical_type = vector.GetType().InternalType();
+    if (physical_type == PhysicalType::VARCHAR) {
+      UnifiedVectorFormat format;
+      vector.ToUnifiedFormat(chunk.size(), format);
+      auto strings = UnifiedVectorFormat::GetData<string_t>(format);
+      for (idx_t i = 0; i < chunk.size(); ++i) {
+        auto index = format.sel->get_index(i);
+        if (format.validity.RowIsValid(index)) {
+          size += strings[index].GetSize();
+        }
+      }
+    } else if (TypeIsConstantSize(physical_type)) {
+      size += GetTypeIdSize(physical_type) * chunk.size();
+    } else {
+      size += NESTED_VALUE_SIZE_ESTIMATE * chunk.size();
+    }
+  }
+  return size;
+}
+
+void ChunkCoalescer::Emit(DataChunk &chunk, duckdb::vector<Chunk> &batches) {
+  batches.push_back(
+      {static_cast<uint16_t>(chunk.size()), std::move(chunk.data)});
+}
+
+} // namespace ui
+} // namespace duckdb
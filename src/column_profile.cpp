@@ -0,0 +1,334 @@
+#include "column_profile.hpp"
+
+#include <duckdb/common/bit_utils.hpp>
+#include <duckdb/common/operator/comparison_operators.hpp>
+#include <duckdb/common/types/vector.hpp>
+#include <duckdb/common/vector_operations/vector_operations.hpp>
+
+#include <cmath>
+#include <type_traits>
+
+namespace duckdb {
+namespace ui {
+
+DistinctCountSketch::DistinctCountSketch() { registers.fill(0); }
+
+void DistinctCountSketch::Insert(hash_t hash) {
+  const auto index = hash >> (64 - PRECISION);
+  // Set a sentinel bit so the rank is bounded for all-zero remainders.
+  const uint64_t remainder =
+      (hash << PRECISION) | (uint64_t(1) << (PRECISION - 1));
+  const auto rank =
+      static_cast<uint8_t>(CountZeros<uint64_t>::Leading(remainder) + 1);
+  if (rank > registers[index]) {
+    registers[index] = rank;
+  }
+}
+
+idx_t DistinctCountSketch::Estimate() const {
+  const double m = static_cast<double>(REGISTER_COUNT);
+  double sum = 0;
+  idx_t zero_count = 0;
+  for (auto rank : registers) {
+    sum += std::ldexp(1.0, -static_cast<int>(rank));
+    if (rank == 0) {
+      ++zero_count;
+    }
+  }
+  const double alpha = 0.7213 / (1 + 1.079 / m);
+  double estimate = alpha * m * m / sum;
+  // Small-range correction (linear counting).
+  if (estimate <= 2.5 * m && zero_count > 0) {
+    estimate = m * std::log(m / static_cast<double>(zero_count));
+  }
+  return static_cast<idx_t>(std::llround(estimate));
+}
+
+void StreamingHistogram::Add(double value) {
+  if (!std::isfinite(value)) {
+    return;
+  }
+  if (initialized) {
+    Insert(value);
+    return;
+  }
+  buffer.push_back(value);
+  if (buffer.size() == INITIAL_BUFFER_SIZE) {
+    Initialize();
+  }
+}
+
+void StreamingHistogram::Initialize() {
+  auto min = buffer[0];
+  auto max = buffer[0];
+  for (auto value : buffer) {
+    min = MinValue(min, value);
+    max = MaxValue(max, value);
+  }
+  lower = min;
+  // Size the buckets so that the maximum falls into the last one.
+  bucket_width = (max - min) / static_cast<double>(BUCKET_COUNT - 1);
+  if (bucket_width <= 0 || !std::isfinite(bucket_width)) {
+    bucket_width = 1;
+  }
+  initialized = true;
+  for (auto value : buffer) {
+    Insert(value);
+  }
+  buffer.clear();
+}
+
+void StreamingHistogram::Insert(double value) {
+  while (value < lower) {
+    // Double the bucket width, keeping the current range as the upper half.
+    auto previous = counts;
+    counts.fill(0);
+    for (idx_t i = 0; i < BUCKET_COUNT / 2; ++i) {
+      counts[BUCKET_COUNT / 2 + i] = previous[2 * i] + previous[2 * i + 1];
+    }
+    lower -= bucket_width * BUCKET_COUNT;
+    bucket_width *= 2;
+  }
+  while (value >= lower + bucket_width * BUCKET_COUNT) {
+    // Double the bucket width, keeping the current range as the lower half.
+    for (idx_t i = 0; i < BUCKET_COUNT / 2; ++i) {
+      counts[i] = counts[2 * i] + counts[2 * i + 1];
+    }
+    for (idx_t i = BUCKET_COUNT / 2; i < BUCKET_COUNT; ++i) {
+      counts[i] = 0;
+    }
+    bucket_width *= 2;
+  }
+  const auto position = (value - lower) / bucket_width;
+  idx_t index = 0;
+  if (position >= static_cast<double>(BUCKET_COUNT - 1)) {
+    index = BUCKET_COUNT - 1;
+  } else if (position > 0) {
+    index = static_cast<idx_t>(position);
+  }
+  counts[index]++;
+}
+
+bool StreamingHistogram::Finalize(double &out_lower, double &out_bucket_width,
+                                  duckdb::vector<idx_t> &out_counts) {
+  if (!initialized) {
+    if (buffer.empty()) {
+      return false;
+    }
+    Initialize();
+  }
+  out_lower = lower;
+  out_bucket_width = bucket_width;
+  out_counts.assign(counts.begin(), counts.end());
+  return true;
+}
+
+template <class T, bool = std::is_arithmetic<T>::value &&
+                          !std::is_same<T, bool>::value>
+struct HistogramInput {
+  static void Add(StreamingHistogram &histogram, const T &value,
+                  double divisor) {
+    histogram.Add(static_cast<double>(value) / divisor);
+  }
+};
+
+template <class T> struct HistogramInput<T, false> {
+  static void Add(StreamingHistogram &, const T &, double) {}
+};
+
+template <class T>
+static Value ValueFromPhysical(const LogicalType &type, const T &value) {
+  // Going through a vector gives the right logical value for any type sharing
+  // this physical representation (decimals, dates, enums, blobs, ...).
+  Vector vector(type, 1);
+  FlatVector::GetData<T>(vector)[0] = value;
+  return vector.GetValue(0);
+}
+
+template <class T>
+static void UpdateTyped(const LogicalType &type, UnifiedVectorFormat &format,
+                        idx_t count, Value &min, Value &max,
+                        StreamingHistogram *histogram, double divisor) {
+  auto data = UnifiedVectorFormat::GetData<T>(format);
+  bool found = false;
+  T chunk_min = T();
+  T chunk_max = T();
+  for (idx_t i = 0; i < count; ++i) {
+    const auto idx = format.sel->get_index(i);
+    if (!format.validity.RowIsValid(idx)) {
+      continue;
+    }
+    const auto &value = data[idx];
+    if (!found) {
+      chunk_min = value;
+      chunk_max = value;
+      found = true;
+    } else if (LessThan::Operation(value, chunk_min)) {
+      chunk_min = value;
+    } else if (GreaterThan::Operation(value, chunk_max)) {
+      chunk_max = value;
+    }
+    if (histogram) {
+      HistogramInput<T>::Add(*histogram, value, divisor);
+    }
+  }
+  if (!found) {
+    return;
+  }
+
+  // Only one conversion per chunk; the comparisons above are on raw values.
+  auto chunk_min_value = ValueFromPhysical<T>(type, chunk_min);
+  if (min.IsNull() || chunk_min_value < min) {
+    min = std::move(chunk_min_value);
+  }
+  auto chunk_max_value = ValueFromPhysical<T>(type, chunk_max);
+  if (max.IsNull() || max < chunk_max_value) {
+    max = std::move(chunk_max_value);
+  }
+}
+
+static bool SupportsHistogram(const LogicalType &type) {
+  if (!type.IsNumeric()) {
+    return false;
+  }
+  switch (type.InternalType()) {
+  case PhysicalType::INT128:
+  case PhysicalType::UINT128:
+    return false;
+  default:
+    return true;
+  }
+}
+
+ColumnProfiler::ColumnProfiler(const duckdb::vector<LogicalType> &types_p)
+    : types(types_p) {
+  states.resize(types.size());
+  for (idx_t i = 0; i < types.size(); ++i) {
+    states[i].has_histogram = SupportsHistogram(types[i]);
+  }
+}
+
+void ColumnProfiler::Update(DataChunk &chunk) {
+  for (idx_t i = 0; i < chunk.ColumnCount(); ++i) {
+    UpdateColumn(i, chunk.data[i], chunk.size());
+  }
+}
+
+void ColumnProfiler::UpdateColumn(idx_t column_index, Vector &vector,
+                                  idx_t count) {
+  auto &type = types[column_index];
+  auto &state = states[column_index];
+
+  UnifiedVectorFormat format;
+  vector.ToUnifiedFormat(count, format);
+
+  Vector hashes(LogicalType::HASH, count);
+  VectorOperations::Hash(vector, hashes, count);
+  UnifiedVectorFormat hash_format;
+  hashes.ToUnifiedFormat(count, hash_format);
+  auto hash_data = UnifiedVectorFormat::GetData<hash_t>(hash_format);
+
+  for (idx_t i = 0; i < count; ++i) {
+    if (!format.validity.RowIsValid(format.sel->get_index(i))) {
+      state.null_count++;
+      continue;
+    }
+    state.distinct.Insert(hash_data[hash_format.sel->get_index(i)]);
+  }
+
+  auto histogram = state.has_histogram ? &state.histogram : nullptr;
+  double divisor = 1;
+  if (type.id() == LogicalTypeId::DECIMAL) {
+    divisor = std::pow(10.0, DecimalType::GetScale(type));
+  }
+
+  switch (type.InternalType()) {
+  case PhysicalType::BOOL:
+    UpdateTyped<bool>(type, format, count, state.min, state.max, histogram,
+                      divisor);
+    break;
+  case PhysicalType::INT8:
+    UpdateTyped<int8_t>(type, format, count, state.min, state.max, histogram,
+                        divisor);
+    break;
+  case PhysicalType::INT16:
+    UpdateTyped<int16_t>(type, format, count, state.min, state.max, histogram,
+                         divisor);
+    break;
+  case PhysicalType::INT32:
+    UpdateTyped<int32_t>(type, format, count, state.min, state.max, histogram,
+                         divisor);
+    break;
+  case PhysicalType::INT64:
+    UpdateTyped<int64_t>(type, format, count, state.min, state.max, histogram,
+                         divisor);
+    break;
+  case PhysicalType::UINT8:
+    UpdateTyped<uint8_t>(type, format, count, state.min, state.max, histogram,
+                         divisor);
+    break;
+  case PhysicalType::UINT16:
+    UpdateTyped<uint16_t>(type, format, count, state.min, state.max,
+                          histogram, divisor);
+    break;
+  case PhysicalType::UINT32:
+    UpdateTyped<uint32_t>(type, format, count, state.min, state.max,
+                          histogram, divisor);
+    break;
+  case PhysicalType::UINT64:
+    UpdateTyped<uint64_t>(type, format, count, state.min, state.max,
+                          histogram, divisor);
+    break;
+  case PhysicalType::INT128:
+    UpdateTyped<hugeint_t>(type, format, count, state.min, state.max,
+                           histogram, divisor);
+    break;
+  case PhysicalType::UINT128:
+    UpdateTyped<uhugeint_t>(type, format, count, state.min, state.max,
+                            histogram, divisor);
+    break;
+  case PhysicalType::FLOAT:
+    UpdateTyped<float>(type, format, count, state.min, state.max, histogram,
+                       divisor);
+    break;
+  case PhysicalType::DOUBLE:
+    UpdateTyped<double>(type, format, count, state.min, state.max, histogram,
+                        divisor);
+    break;
+  case PhysicalType::INTERVAL:
+    UpdateTyped<interval_t>(type, format, count, state.min, state.max,
+                            histogram, divisor);
+    break;
+  case PhysicalType::VARCHAR:
+    UpdateTyped<string_t>(type, format, count, state.min, state.max,
+                          histogram, divisor);
+    break;
+  default:
+    // Nested types only get null and distinct counts.
+    break;
+  }
+}
+
+duckdb::vector<ColumnProfile> ColumnProfiler::Finalize() {
+  duckdb::vector<ColumnProfile> profiles;
+  for (auto &state : states) {
+    ColumnProfile profile;
+    profile.null_count = state.null_count;
+    profile.distinct_count = state.distinct.Estimate();
+    if (!state.min.IsNull()) {
+      profile.has_min_max = true;
+      profile.min = state.min.ToString();
+      profile.max = state.max.ToString();
+    }
+    if (state.has_histogram) {
+      profile.has_histogram = state.histogram.Finalize(
+          profile.histogram_lower, profile.histogram_bucket_width,
+          profile.histogram_counts);
+    }
+    profiles.push_back(std::move(profile));
+  }
+  return profiles;
+}
+
+} // namespace ui
+} // namespace duckdb
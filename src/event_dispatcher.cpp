@@ -5,6 +5,8 @@
 #define CPPHTTPLIB_OPENSSL_SUPPORT
 #include "httplib.hpp"
 
+#include <algorithm>
+
 namespace httplib = duckdb_httplib_openssl;
 
 // Chosen to be no more than half of the lesser of the two limits:
@@ -19,57 +21,252 @@ namespace ui {
 constexpr const char *EMPTY_SSE_MESSAGE = ":\r\r";
 constexpr idx_t EMPTY_SSE_MESSAGE_LENGTH = 3;
 
-bool EventDispatcher::WaitEvent(httplib::DataSink *sink) {
-  std::unique_lock<std::mutex> lock(mutex);
-  // Don't allow too many simultaneous waits, because each consumes a thread in
-  // the httplib thread pool, and also browsers limit the number of server-sent
-  // event connections.
-  if (closed || wait_count >= MAX_EVENT_WAIT_COUNT) {
-    return false;
-  }
-  int target_id = next_id;
-  wait_count++;
-  cv.wait_for(lock, std::chrono::seconds(5));
-  wait_count--;
-  if (closed) {
-    return false;
+EventDispatcher::EventDispatcher(ServerMetrics &_metrics)
+    : metrics(_metrics),
+      flush_thread(&EventDispatcher::FlushCatalogChangedEventsLoop, this) {}
+
+EventDispatcher::~EventDispatcher() { Close(); }
+
+uint64_t EventDispatcher::GetNextEventId() {
+  std::lock_guard<std::mutex> guard(mutex);
+  return next_id;
+}
+
+bool EventDispatcher::WaitEvent(httplib::DataSink *sink,
+                                uint64_t &next_event_id) {
+  std::vector<std::string> messages;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    // Don't allow too many simultaneous waits, because each consumes a thread
+    // in the httplib thread pool, and also browsers limit the number of
+    // server-sent event connections.
+    if (closed || wait_count >= MAX_EVENT_WAIT_COUNT) {
+      return false;
+    }
+    wait_count++;
+    cv.wait_for(lock, std::chrono::seconds(5),
+                [&] { return closed || next_id > next_event_id; });
+    wait_count--;
+    if (closed) {
+      return false;
+    }
+    for (auto &event : recent_events) {
+      if (event.first >= next_event_id) {
+        messages.push_back(event.second);
+      }
+    }
+    next_event_id = next_id;
   }
-  if (current_id == target_id) {
-    sink->write(message.data(), message.size());
-  } else {
+
+  if (messages.empty()) {
     // Our wait timer expired. Write an empty, no-op message.
     // This enables detecting when the client is gone.
-    sink->write(EMPTY_SSE_MESSAGE, EMPTY_SSE_MESSAGE_LENGTH);
+    return sink->write(EMPTY_SSE_MESSAGE, EMPTY_SSE_MESSAGE_LENGTH);
+  }
+  for (auto &message : messages) {
+    if (!sink->write(message.data(), message.size())) {
+      return false;
+    }
   }
   return true;
 }
 
-void EventDispatcher::SendEvent(const std::string &_message) {
-  std::lock_guard<std::mutex> guard(mutex);
-  if (closed) {
-    return;
+void EventDispatcher::SendEvent(const std::string &message) {
+  std::vector<Listener> to_notify;
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (closed) {
+      return;
+    }
+
+    recent_events.emplace_back(next_id++, message);
+    if (recent_events.size() > MAX_RECENT_EVENTS) {
+      recent_events.pop_front();
+    }
+    cv.notify_all();
+    for (auto &listener : listeners) {
+      to_notify.push_back(listener.second);
+    }
   }
+  for (auto &listener : to_notify) {
+    listener(message);
+  }
+}
 
-  current_id = next_id++;
-  message = _message;
-  cv.notify_all();
+uint64_t EventDispatcher::AddListener(Listener listener) {
+  std::lock_guard<std::mutex> guard(mutex);
+  auto listener_id = next_listener_id++;
+  listeners[listener_id] = std::move(listener);
+  return listener_id;
+}
+
+void EventDispatcher::RemoveListener(uint64_t listener_id) {
+  std::lock_guard<std::mutex> guard(mutex);
+  listeners.erase(listener_id);
 }
 
 void EventDispatcher::SendConnectedEvent(const std::string &token) {
   SendEvent(StringUtil::Format("event: ConnectedEvent\ndata: %s\n\n", token));
 }
 
-void EventDispatcher::SendCatalogChangedEvent() {
-  SendEvent("event: CatalogChangeEvent\ndata:\n\n");
+// The data is the id of the database instance whose catalog changed.
+void EventDispatcher::DoSendCatalogChangedEvent(
+    const std::string &instance_id) {
+  metrics.RecordCatalogEventDelivered();
+  SendEvent(StringUtil::Format("event: CatalogChangeEvent\ndata: %s\n\n",
+                               instance_id));
+}
+
+void EventDispatcher::SendCatalogChangedEvent(
+    const std::string &instance_id, std::chrono::milliseconds debounce,
+    std::chrono::milliseconds max_delay) {
+  metrics.RecordCatalogEventRaised();
+  const auto now = clock::now();
+  {
+    std::lock_guard<std::mutex> guard(catalog_changes_mutex);
+    auto &change = catalog_changes[instance_id];
+    change.debounce = debounce;
+    change.max_delay = max_delay;
+    const bool is_quiet = change.last_sent == clock::time_point() ||
+                          now - change.last_sent >= debounce;
+    if (change.is_pending || !is_quiet) {
+      if (!change.is_pending) {
+        change.is_pending = true;
+        change.first_raised = now;
+      }
+      change.last_raised = now;
+      // Wake the flush thread if this is due before anything else.
+      const auto due =
+          std::min(now + debounce, change.first_raised + max_delay);
+      if (due < next_flush) {
+        next_flush = due;
+        catalog_changes_cv.notify_one();
+      }
+      return;
+    }
+    change.last_sent = now;
+  }
+  DoSendCatalogChangedEvent(instance_id);
+}
+
+EventDispatcher::clock::time_point
+EventDispatcher::FlushCatalogChangedEvents() {
+  const auto now = clock::now();
+  auto next_due = clock::time_point::max();
+  std::vector<std::string> to_send;
+  {
+    std::lock_guard<std::mutex> guard(catalog_changes_mutex);
+    for (auto &entry : catalog_changes) {
+      auto &change = entry.second;
+      if (!change.is_pending) {
+        continue;
+      }
+      const auto due = std::min(change.last_raised + change.debounce,
+                                change.first_raised + change.max_delay);
+      if (due <= now) {
+        change.is_pending = false;
+        change.last_sent = now;
+        to_send.push_back(entry.first);
+      } else {
+        next_due = std::min(next_due, due);
+      }
+    }
+    next_flush = next_due;
+  }
+  for (auto &instance_id : to_send) {
+    DoSendCatalogChangedEvent(instance_id);
+  }
+  return next_due;
+}
+
+void EventDispatcher::FlushCatalogChangedEventsLoop() {
+  std::unique_lock<std::mutex> lock(catalog_changes_mutex);
+  while (!stop_flushing) {
+    if (next_flush == clock::time_point::max()) {
+      catalog_changes_cv.wait(lock);
+    } else if (clock::now() < next_flush) {
+      catalog_changes_cv.wait_until(lock, next_flush);
+    } else {
+      lock.unlock();
+      FlushCatalogChangedEvents();
+      lock.lock();
+    }
+  }
+}
+
+static std::string QuoteJSONString(const std::string &str) {
+  std::string result = "\"";
+  for (auto c : str) {
+    switch (c) {
+    case '"':
+      result += "\\\"";
+      break;
+    case '\\':
+      result += "\\\\";
+      break;
+    case '\n':
+      result += "\\n";
+      break;
+    case '\r':
+      result += "\\r";
+      break;
+    case '\t':
+      result += "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        result += StringUtil::Format("\\u%04x", static_cast<int>(c));
+      } else {
+        result += c;
+      }
+    }
+  }
+  return result + "\"";
+}
+
+void EventDispatcher::SendResultTableCompleteEvent(
+    const std::string &database_name, const std::string &schema_name,
+    const std::string &table_name, uint64_t row_count,
+    const std::string &error) {
+  auto data = StringUtil::Format(
+      "{\"databaseName\":%s,\"schemaName\":%s,\"tableName\":%s,"
+      "\"rowCount\":%d,\"error\":%s}",
+      QuoteJSONString(database_name), QuoteJSONString(schema_name),
+      QuoteJSONString(table_name), row_count,
+      error.empty() ? std::string("null") : QuoteJSONString(error));
+  SendEvent(StringUtil::Format(
+      "event: ResultTableCompleteEvent\ndata: %s\n\n", data));
+}
+
+void EventDispatcher::SendIngestProgressEvent(const std::string &ingest_id,
+                                              const std::string &phase,
+                                              uint64_t byte_count,
+                                              uint64_t row_count,
+                                              const std::string &error) {
+  auto data = StringUtil::Format(
+      "{\"ingestId\":%s,\"phase\":%s,\"byteCount\":%d,\"rowCount\":%d,"
+      "\"error\":%s}",
+      QuoteJSONString(ingest_id), QuoteJSONString(phase), byte_count,
+      row_count, error.empty() ? std::string("null") : QuoteJSONString(error));
+  SendEvent(
+      StringUtil::Format("event: IngestProgressEvent\ndata: %s\n\n", data));
 }
 
 void EventDispatcher::Close() {
+  {
+    std::lock_guard<std::mutex> guard(catalog_changes_mutex);
+    stop_flushing = true;
+    catalog_changes_cv.notify_one();
+  }
+  if (flush_thread.joinable()) {
+    flush_thread.join();
+  }
+
   std::lock_guard<std::mutex> guard(mutex);
   if (closed) {
     return;
   }
 
-  current_id = next_id++;
   closed = true;
   cv.notify_all();
 }
@@ -0,0 +1,442 @@
+#include "held_result.hpp"
+
+#include <duckdb/common/types/column/column_data_collection_segment.hpp>
+#include <duckdb/common/types/string_heap.hpp>
+#include <duckdb/common/vector_operations/vector_operations.hpp>
+#include <duckdb/function/create_sort_key.hpp>
+#include <duckdb/storage/buffer_manager.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+namespace duckdb {
+namespace ui {
+
+WindowFilterOperator ParseWindowFilterOperator(const std::string &name) {
+  if (name == "=") {
+    return WindowFilterOperator::EQUAL;
+  }
+  if (name == "!=") {
+    return WindowFilterOperator::NOT_EQUAL;
+  }
+  if (name == "<") {
+    return WindowFilterOperator::LESS_THAN;
+  }
+  if (name == "<=") {
+    return WindowFilterOperator::LESS_THAN_OR_EQUAL;
+  }
+  if (name == ">") {
+    return WindowFilterOperator::GREATER_THAN;
+  }
+  if (name == ">=") {
+    return WindowFilterOperator::GREATER_THAN_OR_EQUAL;
+  }
+  if (name == "is_null") {
+    return WindowFilterOperator::IS_NULL;
+  }
+  if (name == "is_not_null") {
+    return WindowFilterOperator::IS_NOT_NULL;
+  }
+  if (name == "contains") {
+    return WindowFilterOperator::CONTAINS;
+  }
+  throw InvalidInputException("Unknown filter operator: %s", name);
+}
+
+std::string WindowSpec::ToString() const {
+  std::string result;
+  for (auto &sort_key : sort_keys) {
+    result += StringUtil::Format("s%d%s;", sort_key.column,
+                                 sort_key.descending ? "d" : "a");
+  }
+  // Values are length-prefixed, so no value can look like another filter.
+  for (auto &filter : filters) {
+    result += StringUtil::Format("f%d:%d:%d:", filter.column,
+                                 static_cast<uint8_t>(filter.op),
+                                 filter.value.size());
+    result += filter.value;
+  }
+  return result;
+}
+
+HeldResult::HeldResult(ClientContext &context,
+                       duckdb::vector<std::string> _names,
+                       duckdb::vector<LogicalType> _types)
+    : buffer_manager(BufferManager::GetBufferManager(context)),
+      names(std::move(_names)), types(std::move(_types)),
+      collection(make_uniq<ColumnDataCollection>(buffer_manager, types)) {}
+
+void HeldResult::Append(DataChunk &chunk) { collection->Append(chunk); }
+
+void HeldResult::FetchWindow(const WindowSpec &spec, idx_t offset,
+                             idx_t limit, SuccessResult &result) {
+  for (auto &sort_key : spec.sort_keys) {
+    if (sort_key.column >= types.size()) {
+      throw InvalidInputException("Invalid sort column: %d", sort_key.column);
+    }
+  }
+  for (auto &filter : spec.filters) {
+    if (filter.column >= types.size()) {
+      throw InvalidInputException("Invalid filter column: %d", filter.column);
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(mutex);
+  if (chunk_starts.empty()) {
+    chunk_starts = GetChunkStarts(*collection);
+  }
+  auto view = GetView(spec);
+  const idx_t view_row_count =
+      view ? view->rows->Count() : collection->Count();
+
+  result.column_names_and_types = {names, types};
+  result.total_row_count = view_row_count;
+  result.total_row_count_is_estimate = false;
+
+  const idx_t end = offset < view_row_count
+                        ? offset + MinValue(limit, view_row_count - offset)
+                        : offset;
+  // One chunk's worth at a time.
+  duckdb::vector<idx_t> rows(STANDARD_VECTOR_SIZE);
+  for (idx_t start = offset; start < end; start += STANDARD_VECTOR_SIZE) {
+    const idx_t count = MinValue<idx_t>(STANDARD_VECTOR_SIZE, end - start);
+    if (view) {
+      ReadView(*view, start, count, rows.data());
+    } else {
+      std::iota(rows.begin(), rows.begin() + count, start);
+    }
+    DataChunk chunk;
+    Gather(rows.data(), count, chunk);
+    result.chunks.push_back(
+        {static_cast<uint16_t>(count), std::move(chunk.data)});
+  }
+}
+
+shared_ptr<HeldResult::View> HeldResult::GetView(const WindowSpec &spec) {
+  if (spec.IsIdentity()) {
+    return nullptr;
+  }
+  const auto key = spec.ToString();
+  for (auto it = views.begin(); it != views.end(); ++it) {
+    if (it->first == key) {
+      views.splice(views.begin(), views, it);
+      return views.front().second;
+    }
+  }
+
+  RowIndexes rows;
+  if (spec.filters.empty()) {
+    rows = AllocateRowIndexes(collection->Count());
+    rows.count = collection->Count();
+    std::iota(rows.Get(), rows.Get() + rows.count, 0);
+  } else {
+    rows = Filter(spec.filters);
+  }
+  if (!spec.sort_keys.empty()) {
+    Sort(spec.sort_keys, rows);
+  }
+
+  auto view = make_shared_ptr<View>();
+  view->rows = make_shared_ptr<ColumnDataCollection>(
+      buffer_manager, duckdb::vector<LogicalType>{LogicalType::UBIGINT});
+  DataChunk chunk;
+  chunk.Initialize(Allocator::DefaultAllocator(), {LogicalType::UBIGINT});
+  for (idx_t start = 0; start < rows.count; start += STANDARD_VECTOR_SIZE) {
+    const idx_t count =
+        MinValue<idx_t>(STANDARD_VECTOR_SIZE, rows.count - start);
+    memcpy(FlatVector::GetData<uint64_t>(chunk.data[0]), rows.Get() + start,
+           count * sizeof(idx_t));
+    chunk.SetCardinality(count);
+    view->rows->Append(chunk);
+  }
+  view->chunk_starts = GetChunkStarts(*view->rows);
+  views.emplace_front(key, view);
+  if (views.size() > MAX_CACHED_VIEWS) {
+    views.pop_back();
+  }
+  return view;
+}
+
+HeldResult::RowIndexes HeldResult::AllocateRowIndexes(idx_t capacity) {
+  RowIndexes rows;
+  rows.data =
+      buffer_manager.GetBufferAllocator().Allocate(capacity * sizeof(idx_t));
+  return rows;
+}
+
+void HeldResult::ReadView(const View &view, idx_t offset, idx_t count,
+                          idx_t *rows) {
+  DataChunk chunk;
+  chunk.Initialize(Allocator::DefaultAllocator(), {LogicalType::UBIGINT});
+  idx_t copied = 0;
+  while (copied < count) {
+    // The collection may not fill every chunk, so look the chunk up.
+    const auto position = offset + copied;
+    const idx_t chunk_index =
+        std::upper_bound(view.chunk_starts.begin(), view.chunk_starts.end(),
+                         position) -
+        view.chunk_starts.begin() - 1;
+    const auto chunk_offset = position - view.chunk_starts[chunk_index];
+    chunk.Reset();
+    view.rows->FetchChunk(chunk_index, chunk);
+    if (chunk.size() <= chunk_offset) {
+      throw InternalException("Row index %d is out of range", position);
+    }
+    chunk.data[0].Flatten(chunk.size());
+    const auto to_copy = MinValue(count - copied, chunk.size() - chunk_offset);
+    memcpy(rows + copied,
+           FlatVector::GetData<uint64_t>(chunk.data[0]) + chunk_offset,
+           to_copy * sizeof(idx_t));
+    copied += to_copy;
+  }
+}
+
+// Sets `matches[i]` to false for the rows of `column` that don't pass
+// `filter`.
+static void ApplyFilter(const WindowFilter &filter, Vector &column,
+                        idx_t count, duckdb::vector<bool> &matches) {
+  switch (filter.op) {
+  case WindowFilterOperator::IS_NULL:
+  case WindowFilterOperator::IS_NOT_NULL: {
+    UnifiedVectorFormat format;
+    column.ToUnifiedFormat(count, format);
+    const auto want_null = filter.op == WindowFilterOperator::IS_NULL;
+    for (idx_t i = 0; i < count; ++i) {
+      const auto is_null =
+          !format.validity.RowIsValid(format.sel->get_index(i));
+      matches[i] = matches[i] && is_null == want_null;
+    }
+    return;
+  }
+  case WindowFilterOperator::CONTAINS: {
+    Vector text(LogicalType::VARCHAR, count);
+    if (column.GetType().id() == LogicalTypeId::VARCHAR) {
+      text.Reference(column);
+    } else {
+      VectorOperations::DefaultCast(column, text, count);
+    }
+    UnifiedVectorFormat format;
+    text.ToUnifiedFormat(count, format);
+    auto strings = UnifiedVectorFormat::GetData<string_t>(format);
+    const auto needle = StringUtil::Lower(filter.value);
+    for (idx_t i = 0; i < count; ++i) {
+      if (!matches[i]) {
+        continue;
+      }
+      const auto index = format.sel->get_index(i);
+      matches[i] = format.validity.RowIsValid(index) &&
+                   StringUtil::Lower(strings[index].GetString())
+                           .find(needle) != std::string::npos;
+    }
+    return;
+  }
+  default:
+    break;
+  }
+
+  // Comparisons follow SQL: NULL never matches.
+  Vector constant(Value(filter.value).DefaultCastAs(column.GetType()));
+  Vector comparison(LogicalType::BOOLEAN, count);
+  switch (filter.op) {
+  case WindowFilterOperator::EQUAL:
+    VectorOperations::Equals(column, constant, comparison, count);
+    break;
+  case WindowFilterOperator::NOT_EQUAL:
+    VectorOperations::NotEquals(column, constant, comparison, count);
+    break;
+  case WindowFilterOperator::LESS_THAN:
+    VectorOperations::LessThan(column, constant, comparison, count);
+    break;
+  case WindowFilterOperator::LESS_THAN_OR_EQUAL:
+    VectorOperations::LessThanEquals(column, constant, comparison, count);
+    break;
+  case WindowFilterOperator::GREATER_THAN:
+    VectorOperations::GreaterThan(column, constant, comparison, count);
+    break;
+  case WindowFilterOperator::GREATER_THAN_OR_EQUAL:
+    VectorOperations::GreaterThanEquals(column, constant, comparison, count);
+    break;
+  default:
+    throw InternalException("Unexpected filter operator");
+  }
+  UnifiedVectorFormat format;
+  comparison.ToUnifiedFormat(count, format);
+  auto values = UnifiedVectorFormat::GetData<bool>(format);
+  for (idx_t i = 0; i < count; ++i) {
+    const auto index = format.sel->get_index(i);
+    matches[i] =
+        matches[i] && format.validity.RowIsValid(index) && values[index];
+  }
+}
+
+HeldResult::RowIndexes
+HeldResult::Filter(const duckdb::vector<WindowFilter> &filters) {
+  // Only scan the filtered columns; `positions` maps a filter to its column
+  // in the scanned chunk.
+  duckdb::vector<column_t> column_ids;
+  duckdb::vector<idx_t> positions;
+  for (auto &filter : filters) {
+    auto it = std::find(column_ids.begin(), column_ids.end(), filter.column);
+    positions.push_back(it - column_ids.begin());
+    if (it == column_ids.end()) {
+      column_ids.push_back(filter.column);
+    }
+  }
+
+  // Room for every row; the matching ones are copied to the view right after.
+  auto rows = AllocateRowIndexes(collection->Count());
+  ColumnDataScanState state;
+  collection->InitializeScan(state, column_ids);
+  DataChunk chunk;
+  collection->InitializeScanChunk(state, chunk);
+  duckdb::vector<bool> matches;
+  idx_t row_base = 0;
+  while (collection->Scan(state, chunk)) {
+    const auto count = chunk.size();
+    matches.assign(count, true);
+    for (idx_t i = 0; i < filters.size(); ++i) {
+      ApplyFilter(filters[i], chunk.data[positions[i]], count, matches);
+    }
+    for (idx_t i = 0; i < count; ++i) {
+      if (matches[i]) {
+        rows.Get()[rows.count++] = row_base + i;
+      }
+    }
+    row_base += count;
+  }
+  return rows;
+}
+
+// Sort keys compare as unsigned bytes; a key that is a prefix of another comes
+// first.
+static bool SortKeyLessThan(const string_t &left, const string_t &right) {
+  const auto left_size = left.GetSize();
+  const auto right_size = right.GetSize();
+  const auto cmp = memcmp(left.GetData(), right.GetData(),
+                          MinValue(left_size, right_size));
+  return cmp == 0 ? left_size < right_size : cmp < 0;
+}
+
+// A row's sort key, pointing into a StringHeap.
+struct SortEntry {
+  string_t key;
+  idx_t row;
+};
+
+void HeldResult::Sort(const duckdb::vector<WindowSortKey> &sort_keys,
+                      RowIndexes &rows) {
+  // Encode the sort columns of every row in `rows` (which are in ascending
+  // order) as one memcmp-able key, so sorting doesn't depend on the types.
+  duckdb::vector<column_t> column_ids;
+  duckdb::vector<OrderModifiers> modifiers;
+  for (auto &sort_key : sort_keys) {
+    column_ids.push_back(sort_key.column);
+    modifiers.emplace_back(sort_key.descending ? OrderType::DESCENDING
+                                               : OrderType::ASCENDING,
+                           OrderByNullType::NULLS_LAST);
+  }
+
+  // The keys of every row can be large, so they count against the memory
+  // limit, like the entries pointing to them.
+  StringHeap heap(buffer_manager.GetBufferAllocator());
+  auto entry_data = buffer_manager.GetBufferAllocator().Allocate(
+      rows.count * sizeof(SortEntry));
+  auto entries = reinterpret_cast<SortEntry *>(entry_data.get());
+  auto row_indexes = rows.Get();
+  ColumnDataScanState state;
+  collection->InitializeScan(state, column_ids);
+  DataChunk chunk;
+  collection->InitializeScanChunk(state, chunk);
+  idx_t row_base = 0;
+  idx_t next = 0;
+  while (next < rows.count && collection->Scan(state, chunk)) {
+    const auto count = chunk.size();
+    if (row_indexes[next] < row_base + count) {
+      Vector keys(LogicalType::BLOB, count);
+      CreateSortKeyHelpers::CreateSortKey(chunk, modifiers, keys);
+      auto key_data = FlatVector::GetData<string_t>(keys);
+      for (; next < rows.count && row_indexes[next] < row_base + count;
+           ++next) {
+        entries[next].key =
+            heap.AddBlob(key_data[row_indexes[next] - row_base]);
+        entries[next].row = row_indexes[next];
+      }
+    }
+    row_base += count;
+  }
+
+  std::sort(entries, entries + next,
+            [](const SortEntry &left, const SortEntry &right) {
+              if (SortKeyLessThan(left.key, right.key)) {
+                return true;
+              }
+              if (SortKeyLessThan(right.key, left.key)) {
+                return false;
+              }
+              return left.row < right.row;
+            });
+  for (idx_t i = 0; i < next; ++i) {
+    row_indexes[i] = entries[i].row;
+  }
+}
+
+void HeldResult::Gather(const idx_t *rows, idx_t row_count,
+                        DataChunk &target) {
+  // Visit the rows in collection order, so each chunk is fetched once, then
+  // put them back in the requested order.
+  duckdb::vector<idx_t> order(row_count);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&](idx_t left, idx_t right) { return rows[left] < rows[right]; });
+
+  DataChunk gathered;
+  gathered.Initialize(Allocator::DefaultAllocator(), types, row_count);
+  DataChunk source;
+  source.Initialize(Allocator::DefaultAllocator(), types);
+  SelectionVector source_sel(row_count);
+  SelectionVector target_sel(row_count);
+  idx_t i = 0;
+  while (i < row_count) {
+    const auto chunk_index =
+        std::upper_bound(chunk_starts.begin(), chunk_starts.end(),
+                         rows[order[i]]) -
+        chunk_starts.begin() - 1;
+    source.Reset();
+    collection->FetchChunk(chunk_index, source);
+    const auto chunk_start = chunk_starts[chunk_index];
+    const auto chunk_end = chunk_start + source.size();
+    idx_t run = 0;
+    for (; i + run < row_count && rows[order[i + run]] < chunk_end; ++run) {
+      source_sel.set_index(run, rows[order[i + run]] - chunk_start);
+      target_sel.set_index(order[i + run], gathered.size() + run);
+    }
+    for (idx_t c = 0; c < types.size(); ++c) {
+      VectorOperations::Copy(source.data[c], gathered.data[c], source_sel, run,
+                             0, gathered.size());
+    }
+    gathered.SetCardinality(gathered.size() + run);
+    i += run;
+  }
+
+  target.Initialize(Allocator::DefaultAllocator(), types, row_count);
+  for (idx_t c = 0; c < types.size(); ++c) {
+    VectorOperations::Copy(gathered.data[c], target.data[c], target_sel,
+                           row_count, 0, 0);
+  }
+  target.SetCardinality(row_count);
+}
+
+duckdb::vector<idx_t> HeldResult::GetChunkStarts(ColumnDataCollection &rows) {
+  duckdb::vector<idx_t> starts;
+  idx_t row_index = 0;
+  for (auto &segment : rows.GetSegments()) {
+    for (auto &chunk_data : segment->chunk_data) {
+      starts.push_back(row_index);
+      row_index += chunk_data.count;
+    }
+  }
+  return starts;
+}
+
+} // namespace ui
+} // namespace duckdb
@@ -1,8 +1,12 @@
 #include "http_server.hpp"
 
+#include "chunk_coalescer.hpp"
+#include "column_profile.hpp"
 #include "event_dispatcher.hpp"
+#include "held_result.hpp"
 #include "settings.hpp"
 #include "state.hpp"
+#include "upload_file.hpp"
 #include "utils/encoding.hpp"
 #include "utils/env.hpp"
 #include "utils/helpers.hpp"
@@ -15,25 +19,132 @@
 #include <duckdb/common/enums/database_modification_type.hpp>
 #include <duckdb/main/settings.hpp>
 #endif
+#if DUCKDB_VERSION_AT_LEAST(1, 3, 0)
+#include <duckdb/execution/physical_plan_generator.hpp>
+#endif
 #include <duckdb/common/http_util.hpp>
 #include <duckdb/common/serializer/binary_serializer.hpp>
 #include <duckdb/common/serializer/memory_stream.hpp>
+#include <duckdb/common/types/hash.hpp>
+#include <duckdb/common/types/timestamp.hpp>
+#include <duckdb/common/types/uuid.hpp>
+#include <duckdb/execution/physical_operator.hpp>
 #include <duckdb/main/attached_database.hpp>
 #include <duckdb/main/client_data.hpp>
+#include <duckdb/main/prepared_statement_data.hpp>
+#include <duckdb/parallel/task_executor.hpp>
+#include <duckdb/parallel/task_scheduler.hpp>
+#include <duckdb/parser/expression/constant_expression.hpp>
+#include <duckdb/parser/keyword_helper.hpp>
+#include <duckdb/parser/expression/star_expression.hpp>
 #include <duckdb/parser/parsed_data/create_table_info.hpp>
 #include <duckdb/parser/parser.hpp>
+#include <duckdb/parser/query_node/select_node.hpp>
+#include <duckdb/parser/result_modifier.hpp>
+#include <duckdb/parser/statement/create_statement.hpp>
+#include <duckdb/parser/statement/select_statement.hpp>
+#include <duckdb/parser/tableref/basetableref.hpp>
+#include <duckdb/storage/buffer_manager.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace duckdb {
 namespace ui {
 
+// Response to a request whose database instance can't be found.
+static std::string MissingDatabaseError(const httplib::Request &req) {
+  auto instance_id = req.get_header_value("X-DuckDB-UI-Instance");
+  if (!instance_id.empty()) {
+    return StringUtil::Format("Unknown UI instance: %s", instance_id);
+  }
+  return "Database was invalidated, UI needs to be restarted";
+}
+
+// Rows returned in preview mode when no result row limit is given.
+constexpr int DEFAULT_PREVIEW_ROW_LIMIT = 1000;
+
+// Bytes of a ResponseBuffer sent at a time.
+constexpr idx_t RESPONSE_SEND_SIZE = 64 * 1024;
+
+// Least time between progress events while an upload is received.
+constexpr std::chrono::milliseconds INGEST_PROGRESS_INTERVAL(250);
+
+// Result tables written at the same time; further runs wait for a writer.
+constexpr idx_t RESULT_TABLE_WRITER_THREADS = 4;
+
 unique_ptr<HttpServer> HttpServer::server_instance;
 
+// Execute tasks until the result is ready (or there's an error).
+static PendingExecutionResult ExecuteTasks(PendingQueryResult &pending) {
+  auto exec_result = PendingExecutionResult::RESULT_NOT_READY;
+  while (!PendingQueryResult::IsResultReady(exec_result)) {
+    exec_result = pending.ExecuteTask();
+    if (exec_result == PendingExecutionResult::BLOCKED ||
+        exec_result == PendingExecutionResult::NO_TASKS_AVAILABLE) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  return exec_result;
+}
+
+// `SELECT * FROM database.schema.table`
+static unique_ptr<SelectStatement>
+MakeSelectAllStatement(const std::string &database_name,
+                       const std::string &schema_name,
+                       const std::string &table_name) {
+  auto table_ref = make_uniq<BaseTableRef>();
+  table_ref->catalog_name = AsCatalogIdentifier(database_name);
+  table_ref->schema_name = AsCatalogIdentifier(schema_name);
+  table_ref->table_name = AsCatalogIdentifier(table_name);
+  auto select_node = make_uniq<SelectNode>();
+  select_node->select_list.push_back(make_uniq<StarExpression>());
+  select_node->from_table = std::move(table_ref);
+  auto select_statement = make_uniq<SelectStatement>();
+  select_statement->node = std::move(select_node);
+  return select_statement;
+}
+
+// Whether results keep the order of the query (`preserve_insertion_order`).
+static bool PreservesInsertionOrder(ClientContext &context) {
+  Value value;
+  if (!context.TryGetCurrentSetting("preserve_insertion_order", value)) {
+    return true;
+  }
+  return !value.IsNull() && value.GetValue<bool>();
+}
+
+// Adds `LIMIT row_limit` to a query that has no LIMIT yet. Returns whether it
+// was added.
+static bool TryAddRowLimit(SelectStatement &statement, idx_t row_limit) {
+  auto &modifiers = statement.node->modifiers;
+  for (auto &modifier : modifiers) {
+    if (modifier->type == ResultModifierType::LIMIT_MODIFIER ||
+        modifier->type == ResultModifierType::LIMIT_PERCENT_MODIFIER) {
+      return false;
+    }
+  }
+  auto limit_modifier = make_uniq<LimitModifier>();
+  limit_modifier->limit = make_uniq<ConstantExpression>(
+      Value::BIGINT(static_cast<int64_t>(row_limit)));
+  modifiers.push_back(std::move(limit_modifier));
+  return true;
+}
+
 HttpServer *HttpServer::GetInstance(ClientContext &context) {
   if (server_instance) {
     // We already have an instance, make sure we're running on the right DB
     server_instance->UpdateDatabaseInstance(context.db);
   } else {
     server_instance = make_uniq<HttpServer>(context.db);
+    server_instance->AddDatabaseInstance(context.db);
     std::atexit(HttpServer::StopInstance);
   }
   return server_instance.get();
@@ -46,25 +157,33 @@ void HttpServer::UpdateDatabaseInstanceIfRunning(
   }
 }
 
-void HttpServer::UpdateDatabaseInstance(
-    shared_ptr<DatabaseInstance> context_db) {
-  const auto current_db = server_instance->LockDatabaseInstance();
-  if (current_db == context_db) {
-    return;
-  }
-
-  bool has_watcher = !!server_instance->watcher;
-  if (has_watcher) {
-    server_instance->watcher->Stop();
-    server_instance->watcher = nullptr;
+void HttpServer::AddDatabaseInstanceIfRunning(
+    shared_ptr<DatabaseInstance> db) {
+  if (server_instance) {
+    server_instance->AddDatabaseInstance(db);
   }
+}
 
-  server_instance->ddb_instance = context_db;
+// The watcher polls every registered instance, so switching the default one
+// doesn't need to restart it.
+void HttpServer::UpdateDatabaseInstance(
+    shared_ptr<DatabaseInstance> context_db) {
+  AddDatabaseInstance(context_db);
+  std::lock_guard<std::mutex> guard(instances_mutex);
+  ddb_instance = context_db;
+}
 
-  if (has_watcher) {
-    server_instance->watcher = make_uniq<Watcher>(*this);
-    server_instance->watcher->Start();
+void HttpServer::AddDatabaseInstance(const shared_ptr<DatabaseInstance> &db) {
+  std::lock_guard<std::mutex> guard(instances_mutex);
+  // Forget instances that are gone.
+  for (auto it = instances.begin(); it != instances.end();) {
+    if (it->second.expired()) {
+      it = instances.erase(it);
+    } else {
+      ++it;
+    }
   }
+  instances[UIStorageExtensionInfo::GetState(*db).GetInstanceId()] = db;
 }
 
 bool HttpServer::IsRunningOnMachine(ClientContext &context) {
@@ -103,16 +222,21 @@ const HttpServer &HttpServer::Start(ClientContext &context, bool *was_started) {
 
   const auto remote_url = GetRemoteUrl(context);
   const auto port = GetLocalPort(context);
+  const auto socket_path = GetSocketPath(context);
+  const auto websocket_port = GetWebSocketPort(context);
   auto &http_util = HTTPUtil::Get(*context.db);
   // FIXME - https://github.com/duckdb/duckdb/pull/17655 will remove `unused`
   auto http_params = http_util.InitializeParameters(context, "unused");
   auto server = GetInstance(context);
-  server->DoStart(port, remote_url, std::move(http_params));
+  server->DoStart(port, remote_url, socket_path, websocket_port,
+                  std::move(http_params));
   return *server;
 }
 
 void HttpServer::DoStart(const uint16_t _local_port,
                          const std::string &_remote_url,
+                         const std::string &_socket_path,
+                         uint16_t websocket_port,
                          unique_ptr<HTTPParams> _http_params) {
   if (Started()) {
     throw std::runtime_error("HttpServer already started");
@@ -120,15 +244,43 @@ void HttpServer::DoStart(const uint16_t _local_port,
 
   local_port = _local_port;
   local_url = StringUtil::Format("http://localhost:%d", local_port);
+  event_dispatcher = make_uniq<EventDispatcher>(metrics);
+
+  // Bind the optional listeners first, so a failure is reported to the caller.
+  if (websocket_port != 0) {
+    websocket_server = make_uniq<WebSocketServer>(*this, local_url);
+    try {
+      websocket_server->Start(websocket_port);
+    } catch (...) {
+      websocket_server.reset();
+      throw;
+    }
+  }
+  if (!_socket_path.empty()) {
+    socket_path = _socket_path;
+    try {
+      BindSocket();
+    } catch (...) {
+      socket_path = "";
+      websocket_server.reset();
+      throw;
+    }
+  }
+
   remote_url = _remote_url;
   http_params = std::move(_http_params);
+  result_table_writer_pool.Start(RESULT_TABLE_WRITER_THREADS);
   user_agent =
       StringUtil::Format("duckdb-ui/%s-%s(%s)", DuckDB::LibraryVersion(),
                          UI_EXTENSION_VERSION, DuckDB::Platform());
-  event_dispatcher = make_uniq<EventDispatcher>();
   main_thread = make_uniq<std::thread>(&HttpServer::Run, this);
+  if (!socket_path.empty()) {
+    socket_thread = make_uniq<std::thread>(&HttpServer::RunSocket, this);
+  }
   watcher = make_uniq<Watcher>(*this);
   watcher->Start();
+  query_log_flusher = make_uniq<QueryLogFlusher>(*this);
+  query_log_flusher->Start();
 }
 
 bool HttpServer::Stop() {
@@ -147,19 +299,50 @@ void HttpServer::DoStop() {
     watcher = nullptr;
   }
 
-  // Then, stop the event dispatcher
+  // WebSocket connections run requests and receive events.
+  if (websocket_server) {
+    websocket_server->Stop();
+    websocket_server.reset();
+  }
+
+  // Then, stop the event dispatcher, which ends the event streams
   if (event_dispatcher) {
     event_dispatcher->Close();
   }
 
   server.stop();
+  socket_server.stop();
 
   if (main_thread) {
     main_thread->join();
     main_thread.reset();
   }
+  if (socket_thread) {
+    socket_thread->join();
+    socket_thread.reset();
+  }
+
+  // No request is in flight anymore, so no result table writer is added after
+  // these are cancelled.
+  CancelResultTableWriters();
+  result_table_writer_pool.Stop();
+  // Requests are done, so no more runs are logged.
+  if (query_log_flusher) {
+    query_log_flusher->Stop();
+    query_log_flusher.reset();
+  }
+#ifndef _WIN32
+  if (!socket_path.empty()) {
+    unlink(socket_path.c_str());
+  }
+#endif
+  socket_path = "";
 
-  ddb_instance.reset();
+  {
+    std::lock_guard<std::mutex> guard(instances_mutex);
+    ddb_instance.reset();
+    instances.clear();
+  }
   http_params = nullptr;
   event_dispatcher = nullptr;
   remote_url = "";
@@ -171,39 +354,145 @@ std::string HttpServer::LocalUrl() const {
 }
 
 shared_ptr<DatabaseInstance> HttpServer::LockDatabaseInstance() {
+  std::lock_guard<std::mutex> guard(instances_mutex);
   return ddb_instance.lock();
 }
 
+shared_ptr<DatabaseInstance>
+HttpServer::LockDatabaseInstance(const httplib::Request &req) {
+  auto instance_id = req.get_header_value("X-DuckDB-UI-Instance");
+  if (instance_id.empty()) {
+    return LockDatabaseInstance();
+  }
+  std::lock_guard<std::mutex> guard(instances_mutex);
+  auto it = instances.find(instance_id);
+  if (it == instances.end()) {
+    return nullptr;
+  }
+  return it->second.lock();
+}
+
+vector<std::pair<std::string, shared_ptr<DatabaseInstance>>>
+HttpServer::LockDatabaseInstances() {
+  vector<std::pair<std::string, shared_ptr<DatabaseInstance>>> result;
+  std::lock_guard<std::mutex> guard(instances_mutex);
+  for (auto &instance : instances) {
+    auto db = instance.second.lock();
+    if (db) {
+      result.emplace_back(instance.first, std::move(db));
+    }
+  }
+  return result;
+}
+
 void HttpServer::Run() {
-  server.Get("/info", [&](const httplib::Request &req, httplib::Response &res) {
+  RegisterRoutes(server);
+  server.listen("localhost", local_port);
+}
+
+void HttpServer::RunSocket() { socket_server.listen_after_bind(); }
+
+void HttpServer::BindSocket() {
+#ifdef _WIN32
+  throw NotImplementedException(
+      "Unix domain sockets are not supported on Windows");
+#else
+  // A socket file can be left behind by a process that exited without
+  // stopping the server; only replace it if nothing answers on it.
+  httplib::Client client(socket_path, 80);
+  client.set_address_family(AF_UNIX);
+  client.set_connection_timeout(std::chrono::seconds(1));
+  if (client.Get("/info")) {
+    throw IOException("A UI server is already listening on %s", socket_path);
+  }
+  // Never remove anything but a socket, in case the path is mistyped.
+  struct stat existing;
+  if (lstat(socket_path.c_str(), &existing) == 0) {
+    if (!S_ISSOCK(existing.st_mode)) {
+      throw IOException("%s exists and is not a socket", socket_path);
+    }
+    unlink(socket_path.c_str());
+  }
+
+  RegisterRoutes(socket_server);
+  socket_server.set_address_family(AF_UNIX);
+  // Only the current user can connect. On Linux, the socket file is created
+  // with the mode of the socket, so it's never accessible to others. The
+  // process-wide umask is left alone: other threads may be creating files.
+  socket_server.set_socket_options(
+      [](socket_t sock) { fchmod(sock, S_IRUSR | S_IWUSR); });
+  if (!socket_server.bind_to_port(socket_path, 80)) {
+    throw IOException("Could not listen on %s", socket_path);
+  }
+  // Elsewhere the mode of the socket is ignored; set it on the file.
+  if (chmod(socket_path.c_str(), S_IRUSR | S_IWUSR) != 0) {
+    socket_server.stop();
+    unlink(socket_path.c_str());
+    throw IOException("Could not restrict access to %s", socket_path);
+  }
+#endif
+}
+
+void HttpServer::RegisterRoutes(httplib::Server &target) {
+  target.Get("/info", [&](const httplib::Request &req, httplib::Response &res) {
     HandleGetInfo(req, res);
   });
-  server.Get("/localEvents",
+  target.Get("/localEvents",
              [&](const httplib::Request &req, httplib::Response &res) {
                HandleGetLocalEvents(req, res);
              });
-  server.Get("/localToken",
+  target.Get("/localToken",
              [&](const httplib::Request &req, httplib::Response &res) {
                HandleGetLocalToken(req, res);
              });
-  server.Get("/.*", [&](const httplib::Request &req, httplib::Response &res) {
+  target.Get("/metrics",
+             [&](const httplib::Request &req, httplib::Response &res) {
+               HandleGetMetrics(req, res);
+             });
+  target.Get("/.*", [&](const httplib::Request &req, httplib::Response &res) {
+    ScopedRequestTimer timer(metrics, MetricsRoute::PROXIED_GET);
     HandleGet(req, res);
   });
-  server.Post("/ddb/interrupt",
+  target.Post("/ddb/interrupt",
               [&](const httplib::Request &req, httplib::Response &res) {
+                ScopedRequestTimer timer(metrics, MetricsRoute::INTERRUPT);
                 HandleInterrupt(req, res);
               });
-  server.Post("/ddb/run",
+  target.Post("/ddb/run",
               [&](const httplib::Request &req, httplib::Response &res,
                   const httplib::ContentReader &content_reader) {
+                ScopedRequestTimer timer(metrics, MetricsRoute::RUN);
                 HandleRun(req, res, content_reader);
               });
-  server.Post("/ddb/tokenize",
+  target.Post("/ddb/tokenize",
               [&](const httplib::Request &req, httplib::Response &res,
                   const httplib::ContentReader &content_reader) {
+                ScopedRequestTimer timer(metrics, MetricsRoute::TOKENIZE);
                 HandleTokenize(req, res, content_reader);
               });
-  server.listen("localhost", local_port);
+  target.Post("/ddb/batch",
+              [&](const httplib::Request &req, httplib::Response &res,
+                  const httplib::ContentReader &content_reader) {
+                ScopedRequestTimer timer(metrics, MetricsRoute::BATCH);
+                HandleBatch(req, res, content_reader);
+              });
+  target.Post("/ddb/ingest",
+              [&](const httplib::Request &req, httplib::Response &res,
+                  const httplib::ContentReader &content_reader) {
+                ScopedRequestTimer timer(metrics, MetricsRoute::INGEST);
+                HandleIngest(req, res, content_reader);
+              });
+  target.Post("/ddb/export",
+              [&](const httplib::Request &req, httplib::Response &res,
+                  const httplib::ContentReader &content_reader) {
+                ScopedRequestTimer timer(metrics, MetricsRoute::EXPORT);
+                HandleExport(req, res, content_reader);
+              });
+  target.Post("/ddb/window",
+              [&](const httplib::Request &req, httplib::Response &res) {
+                ScopedRequestTimer timer(metrics, MetricsRoute::WINDOW);
+                HandleWindow(req, res);
+              });
 }
 
 void HttpServer::HandleGetInfo(const httplib::Request &req,
@@ -217,14 +506,29 @@ void HttpServer::HandleGetInfo(const httplib::Request &req,
 
 void HttpServer::HandleGetLocalEvents(const httplib::Request &req,
                                       httplib::Response &res) {
+  metrics.EventStreamOpened();
+  // The handler returns before the stream starts, so the stream is timed from
+  // here until it's closed.
+  const auto start = std::chrono::steady_clock::now();
+  // Events sent while the stream is open, including between waits, are
+  // written in order.
+  auto next_event_id = make_shared_ptr<uint64_t>(
+      event_dispatcher ? event_dispatcher->GetNextEventId() : 0);
   res.set_chunked_content_provider(
-      "text/event-stream", [&](size_t /*offset*/, httplib::DataSink &sink) {
-        if (event_dispatcher && event_dispatcher->WaitEvent(&sink)) {
+      "text/event-stream",
+      [this, next_event_id](size_t /*offset*/, httplib::DataSink &sink) {
+        if (event_dispatcher &&
+            event_dispatcher->WaitEvent(&sink, *next_event_id)) {
           return true;
         }
 
         sink.done();
         return false;
+      },
+      [this, start](bool /*success*/) {
+        metrics.EventStreamClosed();
+        metrics.RecordRequest(MetricsRoute::LOCAL_EVENTS,
+                              std::chrono::steady_clock::now() - start);
       });
 }
 
@@ -238,11 +542,10 @@ void HttpServer::HandleGetLocalToken(const httplib::Request &req,
     return;
   }
 
-  auto db = ddb_instance.lock();
+  auto db = LockDatabaseInstance(req);
   if (!db) {
     res.status = 500;
-    res.set_content("Database was invalidated, UI needs to be restarted",
-                    "text/plain");
+    res.set_content(MissingDatabaseError(req), "text/plain");
     return;
   }
 
@@ -258,6 +561,35 @@ void HttpServer::HandleGetLocalToken(const httplib::Request &req,
   }
 }
 
+void HttpServer::HandleGetMetrics(const httplib::Request &req,
+                                  httplib::Response &res) {
+  // Like /localToken: only the UI's own pages (or a scraper configured to send
+  // a matching Referer) may read query statistics.
+  auto referer = req.get_header_value("Referer");
+  if (referer.compare(0, local_url.size(), local_url) != 0) {
+    res.status = 401;
+    return;
+  }
+
+  // Summed over all instances.
+  idx_t named_connection_count = 0;
+  StatementCacheStats statement_cache_stats;
+  auto instances = LockDatabaseInstances();
+  for (auto &instance : instances) {
+    auto &state = UIStorageExtensionInfo::GetState(*instance.second);
+    named_connection_count += state.GetConnectionCount();
+    auto instance_stats = state.GetStatementCache().GetStats();
+    statement_cache_stats.hits += instance_stats.hits;
+    statement_cache_stats.misses += instance_stats.misses;
+    statement_cache_stats.entries += instance_stats.entries;
+    statement_cache_stats.bytes += instance_stats.bytes;
+  }
+
+  res.set_content(metrics.Render(instances.size(), named_connection_count,
+                                 statement_cache_stats),
+                  "text/plain; version=0.0.4");
+}
+
 // Adapted from
 // https://github.com/duckdb/duckdb/blob/1f8b6839ea7864c3e3fb020574f67384cb58124c/src/main/http/http_util.cpp#L129-L147
 // Which is not currently exposed.
@@ -335,7 +667,7 @@ void HttpServer::HandleInterrupt(const httplib::Request &req,
 
   auto connection_name = req.get_header_value("X-DuckDB-UI-Connection-Name");
 
-  auto db = ddb_instance.lock();
+  auto db = LockDatabaseInstance(req);
   if (!db) {
     res.status = 404;
     return;
@@ -349,26 +681,450 @@ void HttpServer::HandleInterrupt(const httplib::Request &req,
   }
 
   connection->Interrupt();
+  // The interrupt also stops a result table still being filled; wait for it
+  // so the connection is free again when we respond.
+  WaitForResultTableWriter(*connection);
 
   SetResponseEmptyResult(res);
 }
 
 void HttpServer::HandleRun(const httplib::Request &req, httplib::Response &res,
                            const httplib::ContentReader &content_reader) {
+  QueryLogRecord record;
+  record.start_time = Timestamp::GetCurrentTimestamp();
+  record.connection_name = req.get_header_value("X-DuckDB-UI-Connection-Name");
+  record.description = req.get_header_value("X-DuckDB-UI-Request-Description");
+  PhaseTimer timer;
+  bool complete = true;
   try {
-    DoHandleRun(req, res, content_reader);
+    complete = DoHandleRun(req, res, content_reader, timer, record);
   } catch (const std::exception &ex) {
-    SetResponseErrorResult(res, ex.what());
+    SetResponseErrorResult(res, record, ex.what());
+  }
+  timer.Stop();
+  res.set_header("Server-Timing", timer.ServerTimingHeader());
+
+  // Don't log rejected requests. Streamed runs are logged when they end.
+  if (res.status == 401 || !complete) {
+    return;
+  }
+  // Responses sent from a ResponseBuffer have no body; their size is already
+  // recorded.
+  LogRun(LockDatabaseInstance(req), timer, record,
+         res.body.empty() ? record.byte_count : res.body.size());
+}
+
+void HttpServer::LogRun(shared_ptr<DatabaseInstance> db,
+                        const PhaseTimer &timer, QueryLogRecord &record,
+                        idx_t byte_count) {
+  if (!db) {
+    return;
+  }
+  auto &query_log = UIStorageExtensionInfo::GetState(*db).GetQueryLog();
+  if (query_log.IsEnabled()) {
+    for (idx_t i = 0; i < RUN_PHASE_COUNT; ++i) {
+      record.phase_ms[i] = timer.ElapsedMs(static_cast<RunPhase>(i));
+    }
+    record.total_ms = timer.TotalMs();
+    record.byte_count = byte_count;
+    if (query_log.Append(std::move(record)) && query_log_flusher) {
+      query_log_flusher->Notify();
+    }
   }
 }
 
-void HttpServer::DoHandleRun(const httplib::Request &req,
+// Writes `content` to `sink` as one frame of a streamed response: a 4-byte
+// little-endian length followed by the content.
+static bool WriteFrame(httplib::DataSink &sink, const MemoryStream &content) {
+  const auto length = static_cast<uint32_t>(content.GetPosition());
+  const char length_bytes[4] = {static_cast<char>(length & 0xFF),
+                                static_cast<char>((length >> 8) & 0xFF),
+                                static_cast<char>((length >> 16) & 0xFF),
+                                static_cast<char>((length >> 24) & 0xFF)};
+  return sink.write(length_bytes, sizeof(length_bytes)) &&
+         sink.write(reinterpret_cast<const char *>(content.GetData()),
+                    length);
+}
+
+// The statements of a script run, and its progress. Shared by the calls of
+// the chunked content provider.
+struct ScriptRun {
+  shared_ptr<Connection> connection;
+  vector<unique_ptr<SQLStatement>> statements;
+  idx_t next_statement = 0;
+  int row_limit = 0;
+  PhaseTimer timer;
+  QueryLogRecord record;
+  idx_t byte_count = 0;
+  idx_t row_count = 0;
+};
+
+void HttpServer::StreamScript(httplib::Response &res,
+                              shared_ptr<Connection> connection,
+                              vector<unique_ptr<SQLStatement>> statements,
+                              int row_limit, const PhaseTimer &timer,
+                              QueryLogRecord &record) {
+  auto script = make_shared_ptr<ScriptRun>();
+  script->connection = std::move(connection);
+  script->statements = std::move(statements);
+  script->row_limit = row_limit;
+  script->timer = timer;
+  script->record = std::move(record);
+
+  // Each statement's ScriptStatementResult is sent as its own frame (see
+  // WriteFrame). The script stops at the first statement that fails, since
+  // later statements usually depend on it.
+  res.set_chunked_content_provider(
+      "application/octet-stream",
+      [this, script](size_t /*offset*/, httplib::DataSink &sink) {
+        if (script->next_statement >= script->statements.size()) {
+          sink.done();
+          return true;
+        }
+        ScriptStatementResult statement_result;
+        RunScriptStatement(*script, statement_result);
+
+        script->timer.Enter(RunPhase::SERIALIZE);
+        MemoryStream content;
+        BinarySerializer::Serialize(statement_result, content);
+        metrics.RecordBytesSerialized(content.GetPosition());
+        script->byte_count += sizeof(uint32_t) + content.GetPosition();
+        if (!WriteFrame(sink, content)) {
+          return false;
+        }
+
+        if (!statement_result.success) {
+          script->record.error = statement_result.error_result.error;
+          script->next_statement = script->statements.size();
+        }
+        return true;
+      },
+      [this, script](bool /*success*/) {
+        script->timer.Stop();
+        script->record.row_count = script->row_count;
+        LogRun(script->connection->context->db, script->timer,
+               script->record, script->byte_count);
+      });
+}
+
+void HttpServer::RunScriptStatement(ScriptRun &script,
+                                    ScriptStatementResult &statement_result) {
+  statement_result.statement_index = script.next_statement;
+  auto statement = std::move(script.statements[script.next_statement++]);
+  vector<Value> no_parameters;
+  script.row_count += RunStatement(
+      *script.connection, std::move(statement), no_parameters,
+      static_cast<idx_t>(script.row_limit), script.timer, statement_result);
+}
+
+idx_t HttpServer::RunStatement(Connection &connection,
+                               unique_ptr<SQLStatement> statement,
+                               vector<Value> &parameter_values,
+                               idx_t row_limit, PhaseTimer &timer,
+                               ScriptStatementResult &statement_result) {
+  const auto start = std::chrono::steady_clock::now();
+  idx_t rows_fetched = 0;
+
+  try {
+    timer.Enter(RunPhase::PREPARE);
+    unique_ptr<PendingQueryResult> pending;
+    if (parameter_values.empty()) {
+      pending = connection.PendingQuery(std::move(statement), true);
+    } else {
+      auto prepared = connection.Prepare(std::move(statement));
+      if (prepared->HasError()) {
+        statement_result.error_result.error = prepared->GetError();
+      } else {
+        pending = prepared->PendingQuery(parameter_values, true);
+      }
+    }
+    // Without a pending query, Prepare failed and set the error.
+    if (pending && pending->HasError()) {
+      statement_result.error_result.error = pending->GetError();
+    } else if (pending) {
+      timer.Enter(RunPhase::EXECUTE);
+      auto exec_result = ExecuteTasks(*pending);
+      if (exec_result == PendingExecutionResult::EXECUTION_ERROR) {
+        statement_result.error_result.error = pending->GetError();
+      } else {
+        auto result = pending->Execute();
+        auto &success_result = statement_result.success_result;
+        success_result.column_names_and_types = {std::move(result->names),
+                                                 std::move(result->types)};
+        timer.Enter(RunPhase::FETCH);
+        ChunkCoalescer coalescer(success_result.column_names_and_types.types,
+                                 GetResultBatchRows(*connection.context),
+                                 GetResultBatchBytes(*connection.context));
+        while (rows_fetched < row_limit) {
+          auto chunk = result->Fetch();
+          if (!chunk) {
+            break;
+          }
+          duckdb::DataChunk *chunk_to_add = chunk.get();
+          duckdb::DataChunk chunk_prefix;
+          const idx_t rows_left = row_limit - rows_fetched;
+          if (chunk->size() > rows_left) {
+            HttpServer::CopyAndSlice(*chunk, chunk_prefix, rows_left);
+            chunk_to_add = &chunk_prefix;
+          }
+          rows_fetched += chunk_to_add->size();
+          coalescer.Append(*chunk_to_add, success_result.chunks);
+        }
+        coalescer.Finish(success_result.chunks);
+        if (result->HasError()) {
+          statement_result.error_result.error = result->GetError();
+        } else {
+          statement_result.success = true;
+          metrics.RecordRowsFetched(rows_fetched);
+        }
+      }
+    }
+  } catch (const std::exception &ex) {
+    ErrorData error(ex);
+    statement_result.error_result.error = error.RawMessage();
+  }
+
+  statement_result.elapsed_ms = std::chrono::duration<double, std::milli>(
+                                    std::chrono::steady_clock::now() - start)
+                                    .count();
+  return statement_result.success ? rows_fetched : 0;
+}
+
+// The queries of a `/ddb/batch`, run as tasks on DuckDB's scheduler, one task
+// per query. Each task pushes the frame of its query once it completes; the
+// chunked content provider sends them in that order.
+struct BatchRun {
+  explicit BatchRun(shared_ptr<DatabaseInstance> db_p)
+      : db(std::move(db_p)),
+        executor(TaskScheduler::GetScheduler(*db)),
+        has_workers(TaskScheduler::GetScheduler(*db).NumberOfThreads() > 1) {}
+
+  // Tasks to run at once. Each blocks a scheduler thread while its query
+  // runs, so at least one thread is left for the queries themselves.
+  idx_t MaxTasks() const {
+    const idx_t thread_count = static_cast<idx_t>(
+        TaskScheduler::GetScheduler(*db).NumberOfThreads());
+    return MinValue<idx_t>(groups.size(),
+                           MaxValue<idx_t>(thread_count, 2) - 1);
+  }
+
+  // Takes the next group of queries not yet started. False if none is left.
+  bool NextGroup(idx_t &group) {
+    group = next_group++;
+    return group < groups.size();
+  }
+
+  // Waits for the next completed query. Without scheduler threads, first runs
+  // every task on the calling thread. nullptr if no query will complete,
+  // because the run was abandoned or a task failed.
+  unique_ptr<MemoryStream> NextCompleted() {
+    if (!has_workers && !worked_on_tasks) {
+      worked_on_tasks = true;
+      WorkOnTasks();
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    completed_cv.wait(
+        lock, [&] { return !completed.empty() || cancelled || failed; });
+    if (completed.empty()) {
+      return nullptr;
+    }
+    auto content = std::move(completed.front());
+    completed.pop_front();
+    return content;
+  }
+
+  void Complete(unique_ptr<MemoryStream> content) {
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      completed.push_back(std::move(content));
+    }
+    completed_cv.notify_one();
+  }
+
+  // Wakes NextCompleted for good: a task failed without completing its query,
+  // so the response can't be.
+  void Fail() {
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      failed = true;
+    }
+    completed_cv.notify_all();
+  }
+
+  // Waits for every task. If the response was abandoned, queries not yet
+  // started are skipped and running ones interrupted.
+  void Finish(bool abandoned) {
+    if (abandoned) {
+      {
+        std::lock_guard<std::mutex> guard(mutex);
+        cancelled = true;
+      }
+      completed_cv.notify_all();
+      for (auto &connection : connections) {
+        connection->Interrupt();
+      }
+    }
+    WorkOnTasks();
+  }
+
+  void WorkOnTasks() {
+    try {
+      executor.WorkOnTasks();
+    } catch (std::exception &) {
+      // Each query's errors are reported in its own frame.
+    }
+  }
+
+  shared_ptr<DatabaseInstance> db;
+  std::string description;
+  vector<BatchQuery> queries;
+  // Queries run in order on the same connection, and that connection.
+  vector<vector<idx_t>> groups;
+  vector<shared_ptr<Connection>> connections;
+  std::atomic<idx_t> next_group{0};
+  TaskExecutor executor;
+  const bool has_workers;
+  bool worked_on_tasks = false;
+  std::atomic<bool> cancelled{false};
+  idx_t sent_count = 0;
+
+  std::mutex mutex;
+  std::condition_variable completed_cv;
+  std::deque<unique_ptr<MemoryStream>> completed;
+  bool failed = false;
+};
+
+// The frame of a batch query that failed outside of its statement.
+static unique_ptr<MemoryStream> SerializeBatchError(idx_t index,
+                                                    const std::string &error) {
+  ScriptStatementResult query_result;
+  query_result.statement_index = index;
+  query_result.error_result.error = error;
+  auto content = make_uniq<MemoryStream>();
+  BinarySerializer::Serialize(query_result, *content);
+  return content;
+}
+
+// Runs one query of a batch, then schedules the task for the next: the next
+// query of its group, which runs in order on one connection, or else the first
+// of a group not yet started. Between queries, the scheduler thread is free
+// for other work, such as the pipelines of the queries themselves.
+class BatchTask : public BaseExecutorTask {
+public:
+  BatchTask(HttpServer &server, BatchRun &batch, idx_t group, idx_t position)
+      : BaseExecutorTask(batch.executor), server(server), batch(batch),
+        group(group), position(position) {}
+
+  // The task for the first query of the next group not yet started, or
+  // nullptr if none is left.
+  static unique_ptr<BatchTask> ForNextGroup(HttpServer &server,
+                                            BatchRun &batch) {
+    idx_t group;
+    if (!batch.NextGroup(group)) {
+      return nullptr;
+    }
+    return make_uniq<BatchTask>(server, batch, group, 0);
+  }
+
+  void ExecuteTask() override {
+    if (batch.cancelled) {
+      return;
+    }
+    try {
+      RunQuery();
+      // Scheduled before this task finishes, so the executor waits for it.
+      unique_ptr<BatchTask> next;
+      if (position + 1 < batch.groups[group].size()) {
+        next = make_uniq<BatchTask>(server, batch, group, position + 1);
+      } else {
+        next = ForNextGroup(server, batch);
+      }
+      if (next && !batch.cancelled) {
+        batch.executor.ScheduleTask(std::move(next));
+      }
+    } catch (...) {
+      batch.Fail();
+      throw;
+    }
+  }
+
+private:
+  void RunQuery() {
+    const auto index = batch.groups[group][position];
+    // Every query gets a frame, even if logging or serializing its result
+    // fails, so the response doesn't wait for it forever.
+    unique_ptr<MemoryStream> content;
+    try {
+      content = server.RunBatchQuery(batch, *batch.connections[group], index);
+    } catch (std::exception &ex) {
+      ErrorData error(ex);
+      content = SerializeBatchError(index, error.RawMessage());
+    } catch (...) {
+      content = SerializeBatchError(index, "Unknown error");
+    }
+    batch.Complete(std::move(content));
+  }
+
+  HttpServer &server;
+  BatchRun &batch;
+  idx_t group;
+  idx_t position;
+};
+
+unique_ptr<MemoryStream> HttpServer::RunBatchQuery(BatchRun &batch,
+                                                   Connection &connection,
+                                                   idx_t index) {
+  auto &query = batch.queries[index];
+  QueryLogRecord record;
+  record.start_time = Timestamp::GetCurrentTimestamp();
+  record.connection_name = query.connection_name;
+  record.description = batch.description;
+  record.sql_hash = Hash(query.sql.c_str(), query.sql.size());
+  PhaseTimer timer;
+
+  ScriptStatementResult query_result;
+  query_result.statement_index = index;
+  try {
+    timer.Enter(RunPhase::PARSE);
+    auto statements = UIStorageExtensionInfo::GetState(*batch.db)
+                          .GetStatementCache()
+                          .ExtractStatements(connection, query.sql);
+    if (statements.size() != 1) {
+      query_result.error_result.error =
+          statements.empty() ? "No statements"
+                             : "Batch queries must be a single statement";
+    } else {
+      record.row_count =
+          RunStatement(connection, std::move(statements[0]),
+                       query.parameters, query.row_limit, timer, query_result);
+    }
+  } catch (std::exception &ex) {
+    ErrorData error(ex);
+    query_result.error_result.error = error.RawMessage();
+  }
+  if (!query_result.success) {
+    record.error = query_result.error_result.error;
+  }
+
+  timer.Enter(RunPhase::SERIALIZE);
+  auto content = make_uniq<MemoryStream>();
+  BinarySerializer::Serialize(query_result, *content);
+  metrics.RecordBytesSerialized(content->GetPosition());
+  timer.Stop();
+  LogRun(batch.db, timer, record, sizeof(uint32_t) + content->GetPosition());
+  return content;
+}
+
+bool HttpServer::DoHandleRun(const httplib::Request &req,
                              httplib::Response &res,
-                             const httplib::ContentReader &content_reader) {
+                             const httplib::ContentReader &content_reader,
+                             PhaseTimer &timer, QueryLogRecord &record) {
+  timer.Enter(RunPhase::DECODE);
+
   auto origin = req.get_header_value("Origin");
   if (origin != local_url) {
     res.status = 401;
-    return;
+    return true;
   }
 
   auto description = req.get_header_value("X-DuckDB-UI-Request-Description");
@@ -380,20 +1136,36 @@ void HttpServer::DoHandleRun(const httplib::Request &req,
   auto schema_name_option =
       DecodeBase64(req.get_header_value("X-DuckDB-UI-Schema-Name"));
 
-  std::vector<std::string> parameter_values;
+  // A binary request carries the SQL and typed parameters in its body (see
+  // RunRequest). Otherwise, the body is the SQL, and parameters are passed as
+  // strings in headers.
+  auto is_binary_request =
+      req.get_header_value("X-DuckDB-UI-Request-Encoding") == "binary";
+
+  vector<Value> parameter_values;
   auto parameter_count_string =
       req.get_header_value("X-DuckDB-UI-Parameter-Count");
-  if (!parameter_count_string.empty()) {
+  if (!is_binary_request && !parameter_count_string.empty()) {
     auto parameter_count = std::stoi(parameter_count_string);
     for (auto i = 0; i < parameter_count; ++i) {
       auto parameter_value = DecodeBase64(req.get_header_value(
           StringUtil::Format("X-DuckDB-UI-Parameter-Value-%d", i)));
-      parameter_values.push_back(parameter_value);
+      parameter_values.push_back(Value(parameter_value));
     }
   }
 
+  // In preview mode, only the first rows are fetched, and the response
+  // includes the total row count: exact if the result was exhausted,
+  // otherwise the planner's estimate. No result table is created, so the
+  // query never has to run to completion.
+  auto run_mode = req.get_header_value("X-DuckDB-UI-Run-Mode");
+  auto is_preview = run_mode == "preview";
+  // In script mode, every statement is run in order and its result streamed
+  // back as soon as it's complete. See StreamScript.
+  auto is_script = run_mode == "script";
+
   // default to effectively no limit
-  auto result_row_limit = INT_MAX;
+  auto result_row_limit = is_preview ? DEFAULT_PREVIEW_ROW_LIMIT : INT_MAX;
   auto result_row_limit_string =
       req.get_header_value("X-DuckDB-UI-Result-Row-Limit");
   if (!result_row_limit_string.empty()) {
@@ -405,7 +1177,14 @@ void HttpServer::DoHandleRun(const httplib::Request &req,
   auto result_schema_name_option =
       DecodeBase64(req.get_header_value("X-DuckDB-UI-Result-Schema-Name"));
   auto result_table_name =
-      DecodeBase64(req.get_header_value("X-DuckDB-UI-Result-Table-Name"));
+      is_preview || is_script ? std::string()
+                 : DecodeBase64(
+                       req.get_header_value("X-DuckDB-UI-Result-Table-Name"));
+  auto result_database_name = result_database_name_option.empty()
+                                  ? "memory"
+                                  : result_database_name_option;
+  auto result_schema_name =
+      result_schema_name_option.empty() ? "main" : result_schema_name_option;
 
   // If no result table is specified, then the result table row limit is zero.
   // Otherwise, default to effectively no limit.
@@ -420,19 +1199,74 @@ void HttpServer::DoHandleRun(const httplib::Request &req,
   auto errors_as_json_string =
       req.get_header_value("X-DuckDB-UI-Errors-As-JSON");
 
+  // Column profiles are computed over every row of the result, not just the
+  // rows returned, so requesting them lifts the fetch limit.
+  auto column_profiles_requested =
+      req.get_header_value("X-DuckDB-UI-Column-Profiles") == "true";
+
+  // A held result keeps every row of the result for later `/ddb/window`
+  // requests on the same connection, which replaces the one held before. See
+  // HandleWindow. Results are held per connection, so a run without a
+  // connection name can't hold one.
+  auto hold_result = !is_preview && !connection_name.empty() &&
+                     req.get_header_value("X-DuckDB-UI-Hold-Result") == "true";
+
+  // With a result id, chunks the client already has from the last run with
+  // the same id on this connection, at the version it sends, aren't sent
+  // again. See ResultDiffCache.
+  auto result_id = req.get_header_value("X-DuckDB-UI-Result-Id");
+  optional_idx client_result_version;
+  auto result_version_string =
+      req.get_header_value("X-DuckDB-UI-Result-Version");
+  if (!result_version_string.empty()) {
+    client_result_version = std::stoull(result_version_string);
+  }
+
   std::string content = ReadContent(content_reader);
+  if (!is_binary_request) {
+    record.sql_hash = Hash(content.c_str(), content.size());
+  }
 
-  auto db = ddb_instance.lock();
+  auto db = LockDatabaseInstance(req);
   if (!db) {
-    SetResponseErrorResult(
-        res, "Database was invalidated, UI needs to be restarted");
-    return;
+    SetResponseErrorResult(res, record, MissingDatabaseError(req));
+    return true;
   }
 
   auto connection =
       UIStorageExtensionInfo::GetState(*db).FindOrCreateConnection(
           *db, connection_name);
+  // A previous run may still be fetching from this connection to fill its
+  // result table.
+  WaitForResultTableWriter(*connection);
+  if (!is_script) {
+    UIStorageExtensionInfo::GetState(*db).SetHeldResult(connection_name,
+                                                        nullptr);
+  }
   auto &context = *connection->context;
+
+  if (is_binary_request) {
+    try {
+      auto run_request = DeserializeRunRequest(context, content);
+      content = std::move(run_request.sql);
+      parameter_values = std::move(run_request.parameters);
+    } catch (std::exception &ex) {
+      ErrorData error(ex);
+      SetResponseErrorResult(
+          res, record, "Invalid binary request: " + error.RawMessage());
+      return true;
+    }
+    record.sql_hash = Hash(content.c_str(), content.size());
+  }
+
+  // A script's statements each run on their own, so there is no single
+  // statement to bind parameters to. Don't run it without them.
+  if (is_script && !parameter_values.empty()) {
+    SetResponseErrorResult(res, record,
+                           "Parameters are not supported in script mode");
+    return true;
+  }
+
   // Set errors_as_json
   if (!errors_as_json_string.empty()) {
 #if DUCKDB_VERSION_AT_LEAST(1, 5, 0)
@@ -458,45 +1292,48 @@ void HttpServer::DoHandleRun(const httplib::Request &req,
     });
   }
 
+  timer.Enter(RunPhase::PARSE);
   vector<unique_ptr<SQLStatement>> statements;
   try {
-    statements = connection->ExtractStatements(content);
+    statements = UIStorageExtensionInfo::GetState(*db)
+                     .GetStatementCache()
+                     .ExtractStatements(*connection, content);
   } catch (std::exception &ex) {
     ErrorData error(ex);
-    SetResponseErrorResult(res, error.RawMessage());
-    return;
+    SetResponseErrorResult(res, record, error.RawMessage());
+    return true;
   }
 
   auto statement_count = statements.size();
 
   if (statement_count == 0) {
-    SetResponseErrorResult(res, "No statements");
-    return;
+    SetResponseErrorResult(res, record, "No statements");
+    return true;
+  }
+
+  if (is_script) {
+    StreamScript(res, connection, std::move(statements), result_row_limit,
+                 timer, record);
+    return false;
   }
 
   // If there's more than one statement, run all but the last.
   if (statement_count > 1) {
     for (size_t i = 0; i < statement_count - 1; ++i) {
+      timer.Enter(RunPhase::PREPARE);
       auto pending = connection->PendingQuery(std::move(statements[i]), true);
       // Return any error found before execution.
       if (pending->HasError()) {
-        SetResponseErrorResult(res, pending->GetError());
-        return;
-      }
-      // Execute tasks until result is ready (or there's an error).
-      auto exec_result = PendingExecutionResult::RESULT_NOT_READY;
-      while (!PendingQueryResult::IsResultReady(exec_result)) {
-        exec_result = pending->ExecuteTask();
-        if (exec_result == PendingExecutionResult::BLOCKED ||
-            exec_result == PendingExecutionResult::NO_TASKS_AVAILABLE) {
-          std::this_thread::sleep_for(std::chrono::milliseconds(1));
-        }
+        SetResponseErrorResult(res, record, pending->GetError());
+        return true;
       }
+      timer.Enter(RunPhase::EXECUTE);
+      auto exec_result = ExecuteTasks(*pending);
       // Return any error found during execution.
       switch (exec_result) {
       case PendingExecutionResult::EXECUTION_ERROR:
-        SetResponseErrorResult(res, pending->GetError());
-        return;
+        SetResponseErrorResult(res, record, pending->GetError());
+        return true;
       case PendingExecutionResult::EXECUTION_FINISHED:
       case PendingExecutionResult::RESULT_READY:
         // ignore the result
@@ -504,9 +1341,10 @@ void HttpServer::DoHandleRun(const httplib::Request &req,
         break;
       default:
         SetResponseErrorResult(
-            res, StringUtil::Format("Unexpected PendingExecutionResult: %s",
-                                    exec_result));
-        return;
+            res, record,
+            StringUtil::Format("Unexpected PendingExecutionResult: %s",
+                               exec_result));
+        return true;
       }
     }
   }
@@ -514,47 +1352,116 @@ void HttpServer::DoHandleRun(const httplib::Request &req,
   // Get the last statement.
   auto &statement_to_run = statements[statement_count - 1];
 
+  // A result table without a row limit holds the entire result, so let DuckDB
+  // build it with a (parallel) CREATE TABLE AS, instead of fetching every row
+  // here and appending it. The rows for the client are then read back from
+  // the table, in the same order.
+  //
+  // The CREATE TABLE AS runs on the user's connection, so only do this
+  // outside an explicit transaction: there, the table would stay uncommitted
+  // and roll back with the user's work. Without preserved insertion order,
+  // neither the table nor the rows read back keep the query's order.
+  if (!result_table_name.empty() && result_table_row_limit == INT_MAX &&
+      parameter_values.empty() &&
+      statement_to_run->type == StatementType::SELECT_STATEMENT &&
+      GetDirectResultTables(context) && context.transaction.IsAutoCommit() &&
+      PreservesInsertionOrder(context)) {
+    timer.Enter(RunPhase::APPEND);
+    auto result_table_info = make_uniq<duckdb::CreateTableInfo>(
+        AsCatalogIdentifier(result_database_name),
+        AsCatalogIdentifier(result_schema_name),
+        AsCatalogIdentifier(result_table_name));
+    result_table_info->query = unique_ptr_cast<SQLStatement, SelectStatement>(
+        std::move(statement_to_run));
+    auto create_statement = make_uniq<CreateStatement>();
+    create_statement->info = std::move(result_table_info);
+
+    auto pending = connection->PendingQuery(std::move(create_statement), false);
+    if (pending->HasError()) {
+      SetResponseErrorResult(res, record, pending->GetError());
+      return true;
+    }
+    auto exec_result = ExecuteTasks(*pending);
+    if (exec_result == PendingExecutionResult::EXECUTION_ERROR) {
+      SetResponseErrorResult(res, record, pending->GetError());
+      return true;
+    }
+    auto create_result = pending->Execute();
+    if (create_result->HasError()) {
+      SetResponseErrorResult(res, record, create_result->GetError());
+      return true;
+    }
+    // CREATE TABLE AS returns the number of rows inserted.
+    idx_t result_table_row_count = 0;
+    auto count_chunk = create_result->Fetch();
+    if (count_chunk && count_chunk->size() > 0) {
+      result_table_row_count = count_chunk->GetValue(0, 0).GetValue<idx_t>();
+    }
+    if (event_dispatcher) {
+      event_dispatcher->SendResultTableCompleteEvent(
+          result_database_name, result_schema_name, result_table_name,
+          result_table_row_count, "");
+    }
+
+    statement_to_run = MakeSelectAllStatement(
+        result_database_name, result_schema_name, result_table_name);
+    result_table_name.clear();
+  }
+
+  // Apply the row limit in the plan of a plain query, so the optimizer can
+  // use top-N and stop early, instead of running the query to completion and
+  // dropping the rows we don't return. Column profiles and unlimited result
+  // tables need every row.
+  bool row_limit_pushed = false;
+  if (statement_to_run->type == StatementType::SELECT_STATEMENT &&
+      !column_profiles_requested && !hold_result &&
+      GetPushRowLimits(context)) {
+    auto rows_needed = MaxValue(result_row_limit, result_table_row_limit);
+    if (rows_needed < INT_MAX) {
+      // In preview mode, the extra row tells whether the result is exhausted.
+      row_limit_pushed =
+          TryAddRowLimit(statement_to_run->Cast<SelectStatement>(),
+                         is_preview ? rows_needed + 1 : rows_needed);
+    }
+  }
+
   // We use a pending query so we can execute tasks and fetch chunks
   // incrementally. This enables cancellation.
   unique_ptr<PendingQueryResult> pending;
 
   // Create pending query, with request content as SQL.
-  if (parameter_values.size() > 0) {
+  timer.Enter(RunPhase::PREPARE);
+  optional_idx estimated_row_count;
+  if (parameter_values.size() > 0 || is_preview) {
     auto prepared = connection->Prepare(std::move(statement_to_run));
     if (prepared->HasError()) {
-      SetResponseErrorResult(res, prepared->GetError());
-      return;
+      SetResponseErrorResult(res, record, prepared->GetError());
+      return true;
     }
 
-    vector<Value> values;
-    for (auto &parameter_value : parameter_values) {
-      // TODO: support non-string parameters?
-      values.push_back(Value(parameter_value));
+    if (is_preview &&
+        prepared->GetStatementType() == StatementType::SELECT_STATEMENT) {
+      estimated_row_count =
+          GetEstimatedCardinality(*prepared, row_limit_pushed);
     }
-    pending = prepared->PendingQuery(values, true);
+
+    pending = prepared->PendingQuery(parameter_values, true);
   } else {
     pending = connection->PendingQuery(std::move(statement_to_run), true);
   }
 
   if (pending->HasError()) {
-    SetResponseErrorResult(res, pending->GetError());
-    return;
+    SetResponseErrorResult(res, record, pending->GetError());
+    return true;
   }
 
-  // Execute tasks until result is ready (or there's an error).
-  auto exec_result = PendingExecutionResult::RESULT_NOT_READY;
-  while (!PendingQueryResult::IsResultReady(exec_result)) {
-    exec_result = pending->ExecuteTask();
-    if (exec_result == PendingExecutionResult::BLOCKED ||
-        exec_result == PendingExecutionResult::NO_TASKS_AVAILABLE) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    }
-  }
+  timer.Enter(RunPhase::EXECUTE);
+  auto exec_result = ExecuteTasks(*pending);
 
   switch (exec_result) {
 
   case PendingExecutionResult::EXECUTION_ERROR:
-    SetResponseErrorResult(res, pending->GetError());
+    SetResponseErrorResult(res, record, pending->GetError());
     break;
 
   case PendingExecutionResult::EXECUTION_FINISHED:
@@ -564,18 +1471,12 @@ void HttpServer::DoHandleRun(const httplib::Request &req,
 
     // We use a separate connection for the appender, including creating the
     // result table, because we still need to fetch chunks from the pending
-    // query on the user's connection.
-    unique_ptr<duckdb::Connection> appender_connection;
-    unique_ptr<duckdb::Appender> appender;
+    // query on the user's connection. Appending happens on a background
+    // writer, so the response doesn't wait for the table.
+    unique_ptr<ResultTableWriter> result_table_writer;
 
     if (!result_table_name.empty()) {
-      auto result_database_name = result_database_name_option.empty()
-                                      ? "memory"
-                                      : result_database_name_option;
-      auto result_schema_name = result_schema_name_option.empty()
-                                    ? "main"
-                                    : result_schema_name_option;
-
+      timer.Enter(RunPhase::APPEND);
       auto result_table_info = make_uniq<duckdb::CreateTableInfo>(
           AsCatalogIdentifier(result_database_name),
           AsCatalogIdentifier(result_schema_name),
@@ -586,7 +1487,7 @@ void HttpServer::DoHandleRun(const httplib::Request &req,
                              result->types[i]));
       }
 
-      appender_connection = make_uniq<duckdb::Connection>(*db);
+      auto appender_connection = make_uniq<duckdb::Connection>(*db);
       auto appender_context = appender_connection->context;
       appender_context->RunFunctionInTransaction([&] {
         auto &catalog = duckdb::Catalog::GetCatalog(
@@ -602,10 +1503,22 @@ void HttpServer::DoHandleRun(const httplib::Request &req,
         catalog.CreateTable(*appender_context, std::move(result_table_info));
       });
 
-      appender = make_uniq<duckdb::Appender>(
+      auto appender = make_uniq<duckdb::Appender>(
           *appender_connection, AsCatalogIdentifier(result_database_name),
           AsCatalogIdentifier(result_schema_name),
           AsCatalogIdentifier(result_table_name));
+
+      result_table_writer = make_uniq<ResultTableWriter>(
+          result_table_writer_pool, connection, std::move(appender_connection),
+          std::move(appender), result_table_row_limit,
+          [this, result_database_name, result_schema_name,
+           result_table_name](idx_t row_count, const std::string &error) {
+            if (event_dispatcher) {
+              event_dispatcher->SendResultTableCompleteEvent(
+                  result_database_name, result_schema_name, result_table_name,
+                  row_count, error);
+            }
+          });
     }
 
     // Fetch the chunks and serialize the result.
@@ -613,27 +1526,73 @@ void HttpServer::DoHandleRun(const httplib::Request &req,
     success_result.column_names_and_types = {std::move(result->names),
                                              std::move(result->types)};
 
-    auto row_limit = std::max(result_row_limit, result_table_row_limit);
+    // The result table writer fetches whatever the table needs beyond this.
+    auto row_limit = column_profiles_requested || hold_result
+                         ? INT_MAX
+                         : result_row_limit;
+    unique_ptr<ColumnProfiler> profiler;
+    if (column_profiles_requested) {
+      profiler = make_uniq<ColumnProfiler>(
+          success_result.column_names_and_types.types);
+    }
+    shared_ptr<HeldResult> held_result;
+    if (hold_result) {
+      held_result = make_shared_ptr<HeldResult>(
+          context, success_result.column_names_and_types.names,
+          success_result.column_names_and_types.types);
+    }
+    // Small chunks are combined into larger ones for the client.
+    ChunkCoalescer coalescer(success_result.column_names_and_types.types,
+                             GetResultBatchRows(context),
+                             GetResultBatchBytes(context));
+    vector<Chunk> batches;
+
+    // Chunks are serialized as they're fetched, so the response, which is
+    // written to a temporary file once it's large, is the only full copy of
+    // the result. The rest of the result is serialized once every chunk is
+    // fetched.
+    auto response_content =
+        make_shared_ptr<ResponseBuffer>(db, GetResponseMemoryBudget(context));
+    ChunkSerializer chunk_serializer(context, *response_content);
+
+    // With a result id, chunks the client already has from the last run with
+    // the same id on this connection, at the version it sends, are sent as
+    // references to them. See ResultDiffCache.
+    auto &result_diff_cache =
+        UIStorageExtensionInfo::GetState(*db).GetResultDiffCache();
+    const auto result_diff_key = connection_name + '\n' + result_id;
+    const auto diff_result = !result_id.empty() && !connection_name.empty();
+    ResultDiff result_diff;
+    if (diff_result) {
+      result_diff = result_diff_cache.Begin(result_diff_key,
+                                            client_result_version);
+      chunk_serializer.SetReferenceFunction(
+          [&](const Chunk &chunk) { return result_diff.AddChunk(chunk); });
+    }
+
     auto rows_fetched = 0;
-    auto rows_appended = 0;
     auto rows_in_result = 0;
+    auto result_exhausted = false;
     unique_ptr<duckdb::DataChunk> chunk;
     while (rows_fetched < row_limit) {
+      timer.Enter(RunPhase::FETCH);
       chunk = result->Fetch();
       if (!chunk) {
+        result_exhausted = true;
         break;
       }
       rows_fetched += chunk->size();
-      if (appender && rows_appended < result_table_row_limit) {
-        duckdb::DataChunk *chunk_to_append = chunk.get();
-        duckdb::DataChunk chunk_prefix;
-        const idx_t rows_left = result_table_row_limit - rows_appended;
-        if (chunk->size() > rows_left) {
-          HttpServer::CopyAndSlice(*chunk, chunk_prefix, rows_left);
-          chunk_to_append = &chunk_prefix;
-        }
-        appender->AppendDataChunk(*chunk_to_append);
-        rows_appended += chunk_to_append->size();
+      if (profiler) {
+        timer.Enter(RunPhase::PROFILE);
+        profiler->Update(*chunk);
+      }
+      if (result_table_writer) {
+        timer.Enter(RunPhase::APPEND);
+        result_table_writer->Append(*chunk);
+      }
+      if (held_result) {
+        timer.Enter(RunPhase::APPEND);
+        held_result->Append(*chunk);
       }
       if (rows_in_result < result_row_limit) {
         duckdb::DataChunk *chunk_to_add = chunk.get();
@@ -643,28 +1602,77 @@ void HttpServer::DoHandleRun(const httplib::Request &req,
           HttpServer::CopyAndSlice(*chunk, chunk_prefix, rows_left);
           chunk_to_add = &chunk_prefix;
         }
-        success_result.chunks.push_back(
-            {static_cast<uint16_t>(chunk_to_add->size()),
-             std::move(chunk_to_add->data)});
         rows_in_result += chunk_to_add->size();
+        coalescer.Append(*chunk_to_add, batches);
+        if (!batches.empty()) {
+          timer.Enter(RunPhase::SERIALIZE);
+          chunk_serializer.Append(batches);
+        }
       }
     }
+    coalescer.Finish(batches);
+    timer.Enter(RunPhase::SERIALIZE);
+    chunk_serializer.Append(batches);
+
+    if (result_table_writer) {
+      timer.Enter(RunPhase::APPEND);
+      result_table_writer->Finish(result_exhausted ? nullptr
+                                                   : std::move(result));
+      AddResultTableWriter(std::move(result_table_writer));
+    }
+
+    if (profiler) {
+      timer.Enter(RunPhase::PROFILE);
+      success_result.column_profiles = profiler->Finalize();
+    }
+
+    if (held_result) {
+      success_result.total_row_count = held_result->GetRowCount();
+      success_result.total_row_count_is_estimate = false;
+      UIStorageExtensionInfo::GetState(*db).SetHeldResult(
+          connection_name, std::move(held_result));
+    }
 
-    if (appender) {
-      appender->Close();
+    if (is_preview) {
+      if (result_exhausted) {
+        success_result.total_row_count = rows_fetched;
+        success_result.total_row_count_is_estimate = false;
+      } else {
+        // The estimate can be lower than what we already fetched.
+        success_result.total_row_count = MaxValue<idx_t>(
+            estimated_row_count.IsValid() ? estimated_row_count.GetIndex() : 0,
+            rows_fetched);
+        success_result.total_row_count_is_estimate = true;
+      }
     }
 
-    MemoryStream success_response_content;
-    BinarySerializer::Serialize(success_result, success_response_content);
-    SetResponseContent(res, success_response_content);
+    metrics.RecordRowsFetched(rows_fetched);
+    record.row_count = rows_in_result;
+
+    timer.Enter(RunPhase::SERIALIZE);
+    if (diff_result) {
+      // Every chunk must be compared before the version is known.
+      chunk_serializer.Flush();
+      metrics.RecordChunksReused(result_diff.GetReferenceCount());
+      success_result.result_version =
+          result_diff_cache.Finish(result_diff_key, result_diff);
+    }
+    std::string head;
+    std::string tail;
+    chunk_serializer.SerializeResult(success_result, head, tail);
+    response_content->SetHeadAndTail(std::move(head), std::move(tail));
+    record.byte_count = response_content->GetSize();
+    SetResponseContent(res, std::move(response_content));
     break;
   }
   default:
     SetResponseErrorResult(
-        res, StringUtil::Format("Unexpected PendingExecutionResult: %s",
-                                exec_result));
+        res, record,
+        StringUtil::Format("Unexpected PendingExecutionResult: %s",
+                           exec_result));
     break;
   }
+  return true;
 }
 
 void HttpServer::HandleTokenize(const httplib::Request &req,
@@ -697,6 +1705,656 @@ void HttpServer::HandleTokenize(const httplib::Request &req,
   SetResponseContent(res, response_content);
 }
 
+void HttpServer::HandleWindow(const httplib::Request &req,
+                              httplib::Response &res) {
+  auto origin = req.get_header_value("Origin");
+  if (origin != local_url) {
+    res.status = 401;
+    return;
+  }
+
+  auto connection_name = req.get_header_value("X-DuckDB-UI-Connection-Name");
+
+  auto db = LockDatabaseInstance(req);
+  if (!db) {
+    SetResponseErrorResult(res, MissingDatabaseError(req));
+    return;
+  }
+
+  auto held_result =
+      UIStorageExtensionInfo::GetState(*db).FindHeldResult(connection_name);
+  if (!held_result) {
+    SetResponseErrorResult(res, "No result is held for this connection");
+    return;
+  }
+
+  // Sort keys and filters are given as numbered headers, like parameters.
+  idx_t offset = 0;
+  idx_t limit = DEFAULT_PREVIEW_ROW_LIMIT;
+  WindowSpec spec;
+  try {
+    auto offset_string = req.get_header_value("X-DuckDB-UI-Window-Offset");
+    if (!offset_string.empty()) {
+      offset = std::stoull(offset_string);
+    }
+    auto limit_string = req.get_header_value("X-DuckDB-UI-Window-Limit");
+    if (!limit_string.empty()) {
+      limit = std::stoull(limit_string);
+    }
+
+    auto sort_count_string = req.get_header_value("X-DuckDB-UI-Sort-Count");
+    auto sort_count =
+        sort_count_string.empty() ? 0 : std::stoi(sort_count_string);
+    for (auto i = 0; i < sort_count; ++i) {
+      WindowSortKey sort_key;
+      sort_key.column = std::stoull(req.get_header_value(
+          StringUtil::Format("X-DuckDB-UI-Sort-Column-%d", i)));
+      sort_key.descending =
+          req.get_header_value(StringUtil::Format(
+              "X-DuckDB-UI-Sort-Descending-%d", i)) == "true";
+      spec.sort_keys.push_back(sort_key);
+    }
+
+    auto filter_count_string =
+        req.get_header_value("X-DuckDB-UI-Filter-Count");
+    auto filter_count =
+        filter_count_string.empty() ? 0 : std::stoi(filter_count_string);
+    for (auto i = 0; i < filter_count; ++i) {
+      WindowFilter filter;
+      filter.column = std::stoull(req.get_header_value(
+          StringUtil::Format("X-DuckDB-UI-Filter-Column-%d", i)));
+      filter.op = ParseWindowFilterOperator(req.get_header_value(
+          StringUtil::Format("X-DuckDB-UI-Filter-Operator-%d", i)));
+      filter.value = DecodeBase64(req.get_header_value(
+          StringUtil::Format("X-DuckDB-UI-Filter-Value-%d", i)));
+      spec.filters.push_back(std::move(filter));
+    }
+  } catch (std::exception &ex) {
+    SetResponseErrorResult(res, ex.what());
+    return;
+  }
+
+  SuccessResult result;
+  try {
+    held_result->FetchWindow(spec, offset, limit, result);
+  } catch (std::exception &ex) {
+    ErrorData error(ex);
+    SetResponseErrorResult(res, error.RawMessage());
+    return;
+  }
+
+  MemoryStream response_content;
+  BinarySerializer::Serialize(result, response_content);
+  SetResponseContent(res, response_content);
+}
+
+void HttpServer::HandleBatch(const httplib::Request &req,
+                             httplib::Response &res,
+                             const httplib::ContentReader &content_reader) {
+  auto origin = req.get_header_value("Origin");
+  if (origin != local_url) {
+    res.status = 401;
+    return;
+  }
+
+  std::string content = ReadContent(content_reader);
+
+  auto db = LockDatabaseInstance(req);
+  if (!db) {
+    SetResponseErrorResult(res, MissingDatabaseError(req));
+    return;
+  }
+
+  auto batch = make_shared_ptr<BatchRun>(db);
+  batch->description = req.get_header_value("X-DuckDB-UI-Request-Description");
+  try {
+    Connection connection(*db);
+    batch->queries =
+        DeserializeBatchRequest(*connection.context, content).queries;
+  } catch (std::exception &ex) {
+    ErrorData error(ex);
+    SetResponseErrorResult(res, "Invalid batch request: " + error.RawMessage());
+    return;
+  }
+  if (batch->queries.empty()) {
+    SetResponseErrorResult(res, "No queries");
+    return;
+  }
+
+  // Queries without a connection name each get a new connection, so they can
+  // run at once. Queries naming the same connection run on it in order, as
+  // one group. Fewer tasks than scheduler threads take groups in turn.
+  auto &state = UIStorageExtensionInfo::GetState(*db);
+  std::map<std::string, idx_t> named_groups;
+  for (idx_t i = 0; i < batch->queries.size(); ++i) {
+    const auto &connection_name = batch->queries[i].connection_name;
+    if (connection_name.empty()) {
+      batch->connections.push_back(make_shared_ptr<Connection>(*db));
+      batch->groups.push_back({i});
+      continue;
+    }
+    auto entry = named_groups.find(connection_name);
+    if (entry != named_groups.end()) {
+      batch->groups[entry->second].push_back(i);
+      continue;
+    }
+    auto connection = state.FindOrCreateConnection(*db, connection_name);
+    WaitForResultTableWriter(*connection);
+    state.SetHeldResult(connection_name, nullptr);
+    named_groups[connection_name] = batch->groups.size();
+    batch->connections.push_back(std::move(connection));
+    batch->groups.push_back({i});
+  }
+
+  const auto task_count = batch->MaxTasks();
+  for (idx_t i = 0; i < task_count; ++i) {
+    batch->executor.ScheduleTask(BatchTask::ForNextGroup(*this, *batch));
+  }
+
+  // Each query's ScriptStatementResult, whose statement index is the index of
+  // the query, is sent as its own frame (see WriteFrame) once it completes.
+  res.set_chunked_content_provider(
+      "application/octet-stream",
+      [batch](size_t /*offset*/, httplib::DataSink &sink) {
+        if (batch->sent_count == batch->queries.size()) {
+          sink.done();
+          return true;
+        }
+        auto content = batch->NextCompleted();
+        if (!content) {
+          return false;
+        }
+        batch->sent_count++;
+        return WriteFrame(sink, *content);
+      },
+      [batch](bool success) {
+        batch->Finish(!success || batch->sent_count < batch->queries.size());
+      });
+}
+
+// Reader of each `/ddb/ingest` format, and the extension of its upload file.
+static bool GetIngestReader(const std::string &format, std::string &reader,
+                            std::string &extension) {
+  if (format == "csv") {
+    reader = "read_csv(%s)";
+    extension = ".csv";
+  } else if (format == "parquet") {
+    reader = "read_parquet(%s)";
+    extension = ".parquet";
+  } else if (format == "ndjson") {
+    reader = "read_json(%s, format = 'newline_delimited')";
+    extension = ".json";
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void HttpServer::HandleIngest(const httplib::Request &req,
+                              httplib::Response &res,
+                              const httplib::ContentReader &content_reader) {
+  auto origin = req.get_header_value("Origin");
+  if (origin != local_url) {
+    res.status = 401;
+    return;
+  }
+
+  QueryLogRecord record;
+  record.start_time = Timestamp::GetCurrentTimestamp();
+  record.connection_name = req.get_header_value("X-DuckDB-UI-Connection-Name");
+  record.description = req.get_header_value("X-DuckDB-UI-Request-Description");
+  PhaseTimer timer;
+  timer.Enter(RunPhase::DECODE);
+
+  // Progress events are only sent if the client gave an id to match them.
+  auto ingest_id = req.get_header_value("X-DuckDB-UI-Ingest-Id");
+  idx_t byte_count = 0;
+  auto send_progress = [&](const std::string &phase, idx_t row_count,
+                           const std::string &error) {
+    if (!ingest_id.empty() && event_dispatcher) {
+      event_dispatcher->SendIngestProgressEvent(ingest_id, phase, byte_count,
+                                                row_count, error);
+    }
+  };
+
+  auto format = req.get_header_value("X-DuckDB-UI-Ingest-Format");
+  std::string reader;
+  std::string extension;
+  if (!GetIngestReader(format, reader, extension)) {
+    SetResponseErrorResult(
+        res, record, StringUtil::Format("Unknown ingest format: '%s'", format));
+    return;
+  }
+
+  // The table is created, unless the mode is "append" (to insert into an
+  // existing table, by column name) or "replace".
+  auto database_name =
+      DecodeBase64(req.get_header_value("X-DuckDB-UI-Ingest-Database-Name"));
+  auto schema_name =
+      DecodeBase64(req.get_header_value("X-DuckDB-UI-Ingest-Schema-Name"));
+  auto table_name =
+      DecodeBase64(req.get_header_value("X-DuckDB-UI-Ingest-Table-Name"));
+  auto mode = req.get_header_value("X-DuckDB-UI-Ingest-Mode");
+  if (table_name.empty()) {
+    SetResponseErrorResult(res, record, "No ingest table name");
+    return;
+  }
+  if (!mode.empty() && mode != "create" && mode != "append" &&
+      mode != "replace") {
+    SetResponseErrorResult(
+        res, record, StringUtil::Format("Unknown ingest mode: '%s'", mode));
+    return;
+  }
+
+  auto db = LockDatabaseInstance(req);
+  if (!db) {
+    SetResponseErrorResult(res, record, MissingDatabaseError(req));
+    return;
+  }
+
+  ScriptStatementResult load_result;
+  idx_t row_count = 0;
+  std::chrono::steady_clock::duration upload_duration{};
+  std::chrono::steady_clock::duration load_duration{};
+  try {
+    auto connection =
+        UIStorageExtensionInfo::GetState(*db).FindOrCreateConnection(
+            *db, record.connection_name);
+    const auto max_bytes = GetMaxIngestBytes(*connection->context);
+    const auto too_large = StringUtil::Format(
+        "The upload is larger than %d bytes (SET %s to allow more)",
+        max_bytes, UI_MAX_INGEST_BYTES_SETTING_NAME);
+    // Refused before any of it is read, if the client sent its size.
+    if (req.get_header_value_u64("Content-Length") > max_bytes) {
+      throw InvalidInputException(too_large);
+    }
+
+    // The body is read as it arrives, rather than with ReadContent.
+    UploadFile upload(db, extension);
+    const auto upload_start = std::chrono::steady_clock::now();
+    auto last_progress = upload_start;
+    bool over_limit = false;
+    auto received = content_reader([&](const char *data, size_t data_length) {
+      if (data_length > max_bytes - upload.GetSize()) {
+        over_limit = true;
+        return false;
+      }
+      upload.Write(data, data_length);
+      byte_count = upload.GetSize();
+      auto now = std::chrono::steady_clock::now();
+      if (now - last_progress >= INGEST_PROGRESS_INTERVAL) {
+        last_progress = now;
+        send_progress("upload", 0, "");
+      }
+      return true;
+    });
+    if (over_limit) {
+      throw InvalidInputException(too_large);
+    }
+    if (!received) {
+      throw IOException("The upload was interrupted");
+    }
+    upload.Finish();
+    upload_duration = std::chrono::steady_clock::now() - upload_start;
+    send_progress("load", 0, "");
+
+    WaitForResultTableWriter(*connection);
+
+    std::string target;
+    if (!database_name.empty()) {
+      target += KeywordHelper::WriteOptionallyQuoted(database_name) + ".";
+      if (schema_name.empty()) {
+        schema_name = DEFAULT_SCHEMA;
+      }
+    }
+    if (!schema_name.empty()) {
+      target += KeywordHelper::WriteOptionallyQuoted(schema_name) + ".";
+    }
+    target += KeywordHelper::WriteOptionallyQuoted(table_name);
+    auto source = StringUtil::Format(
+        reader, KeywordHelper::WriteQuoted(upload.GetPath(), '\''));
+    std::string sql;
+    if (mode == "append") {
+      sql = StringUtil::Format("INSERT INTO %s BY NAME SELECT * FROM %s",
+                               target, source);
+    } else {
+      sql = StringUtil::Format("CREATE %sTABLE %s AS SELECT * FROM %s",
+                               mode == "replace" ? "OR REPLACE " : "", target,
+                               source);
+    }
+
+    timer.Enter(RunPhase::PARSE);
+    const auto load_start = std::chrono::steady_clock::now();
+    auto statements = connection->ExtractStatements(sql);
+    vector<Value> no_parameters;
+    RunStatement(*connection, std::move(statements[0]), no_parameters,
+                 NumericLimits<idx_t>::Maximum(), timer, load_result);
+    load_duration = std::chrono::steady_clock::now() - load_start;
+    // Both statements return the number of rows loaded.
+    auto &chunks = load_result.success_result.chunks;
+    if (load_result.success && !chunks.empty() && chunks[0].row_count > 0) {
+      row_count = chunks[0].vectors[0].GetValue(0).GetValue<idx_t>();
+    }
+  } catch (std::exception &ex) {
+    ErrorData error(ex);
+    load_result.success = false;
+    load_result.error_result.error = error.RawMessage();
+  }
+
+  metrics.RecordIngest(byte_count, load_result.success ? row_count : 0,
+                       upload_duration, load_duration);
+  if (load_result.success) {
+    send_progress("complete", row_count, "");
+    record.row_count = row_count;
+    timer.Enter(RunPhase::SERIALIZE);
+    MemoryStream response_content;
+    BinarySerializer::Serialize(load_result.success_result, response_content);
+    SetResponseContent(res, response_content);
+  } else {
+    send_progress("complete", 0, load_result.error_result.error);
+    SetResponseErrorResult(res, record, load_result.error_result.error);
+  }
+  timer.Stop();
+  res.set_header("Server-Timing", timer.ServerTimingHeader());
+  LogRun(db, timer, record, res.body.size());
+}
+
+// COPY options of each `/ddb/export` format, and its file extension and
+// content type.
+static bool GetExportFormat(const std::string &format, std::string &options,
+                            std::string &extension,
+                            std::string &content_type) {
+  if (format == "csv") {
+    options = "FORMAT csv, HEADER true";
+    extension = ".csv";
+    content_type = "text/csv";
+  } else if (format == "parquet") {
+    options = "FORMAT parquet";
+    extension = ".parquet";
+    content_type = "application/vnd.apache.parquet";
+  } else if (format == "ndjson") {
+    options = "FORMAT json";
+    extension = ".json";
+    content_type = "application/x-ndjson";
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// The text of `statement` in `sql`, without the semicolons and comments that
+// follow it (the last statement extends to the end of the SQL).
+static std::string GetStatementText(const std::string &sql,
+                                    const SQLStatement &statement) {
+  if (statement.stmt_location + statement.stmt_length > sql.size()) {
+    return statement.ToString();
+  }
+  auto text = sql.substr(statement.stmt_location, statement.stmt_length);
+  auto tokens = Parser::Tokenize(text);
+  idx_t end = text.size();
+  while (!tokens.empty()) {
+    const auto &token = tokens.back();
+    auto token_text = text.substr(token.start, end - token.start);
+    StringUtil::Trim(token_text);
+    if (token.type != SimplifiedTokenType::SIMPLIFIED_TOKEN_COMMENT &&
+        token_text != ";") {
+      break;
+    }
+    end = token.start;
+    tokens.pop_back();
+  }
+  text = text.substr(0, end);
+  // The tokenizer may skip semicolons.
+  StringUtil::RTrim(text);
+  while (!text.empty() && text.back() == ';') {
+    text.pop_back();
+    StringUtil::RTrim(text);
+  }
+  return text;
+}
+
+// A `/ddb/export` in progress. DuckDB's COPY writes the result to a file in
+// its temp directory, which only ever grows, so the bytes written so far are
+// sent while the COPY runs, and memory use doesn't depend on the result size.
+//
+// Disk use does: the COPY runs on scheduler threads at its own pace, not the
+// client's, and the file is only removed once the response ends. An export
+// needs as much free space in the temp directory as its output, and
+// `max_temp_directory_size` doesn't apply to it, so the file is capped at
+// `ui_max_export_bytes` instead: past it, the COPY is interrupted.
+struct ExportRun {
+  ~ExportRun() {
+    file_handle.reset();
+    if (!db || file_path.empty()) {
+      return;
+    }
+    try {
+      auto &fs = FileSystem::GetFileSystem(*db);
+      if (fs.FileExists(file_path)) {
+        fs.RemoveFile(file_path);
+      }
+    } catch (std::exception &ex) {
+      std::cerr << "Could not remove " << file_path << ": " << ex.what()
+                << std::endl;
+    }
+  }
+
+  // Runs one task of the COPY.
+  void Step() {
+    auto exec_result = pending->ExecuteTask();
+    if (PendingQueryResult::IsResultReady(exec_result)) {
+      finished = true;
+      if (over_limit || WrittenBytes() > max_bytes) {
+        over_limit = true;
+        error = StringUtil::Format(
+            "The export is larger than %d bytes (SET %s to allow more)",
+            max_bytes, UI_MAX_EXPORT_BYTES_SETTING_NAME);
+      } else if (exec_result == PendingExecutionResult::EXECUTION_ERROR) {
+        error = pending->GetError();
+      } else {
+        // COPY returns the number of rows written.
+        auto result = pending->Execute();
+        auto chunk = result->HasError() ? nullptr : result->Fetch();
+        if (result->HasError()) {
+          error = result->GetError();
+        } else if (chunk && chunk->size() > 0) {
+          record.row_count = chunk->GetValue(0, 0).GetValue<idx_t>();
+        }
+      }
+      pending.reset();
+    } else if (!over_limit && WrittenBytes() > max_bytes) {
+      // Ends with an error at the next task.
+      over_limit = true;
+      connection->Interrupt();
+    } else if (exec_result == PendingExecutionResult::BLOCKED ||
+               exec_result == PendingExecutionResult::NO_TASKS_AVAILABLE) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  // Bytes written by the COPY so far.
+  idx_t WrittenBytes() {
+    if (!file_handle) {
+      auto &fs = FileSystem::GetFileSystem(*db);
+      if (!fs.FileExists(file_path)) {
+        return 0;
+      }
+      file_handle = fs.OpenFile(file_path, FileFlags::FILE_FLAGS_READ);
+    }
+    return file_handle->GetFileSize();
+  }
+
+  // Bytes written by the COPY but not yet sent. None once the file is over
+  // the limit: the response ends with an error instead.
+  idx_t AvailableBytes() { return over_limit ? 0 : WrittenBytes() - sent; }
+
+  shared_ptr<DatabaseInstance> db;
+  shared_ptr<Connection> connection;
+  unique_ptr<PendingQueryResult> pending;
+  std::string file_path;
+  unique_ptr<FileHandle> file_handle;
+  idx_t max_bytes = 0;
+  bool over_limit = false;
+  bool finished = false;
+  std::string error;
+  idx_t sent = 0;
+  std::string buffer;
+  PhaseTimer timer;
+  QueryLogRecord record;
+};
+
+void HttpServer::HandleExport(const httplib::Request &req,
+                              httplib::Response &res,
+                              const httplib::ContentReader &content_reader) {
+  auto origin = req.get_header_value("Origin");
+  if (origin != local_url) {
+    res.status = 401;
+    return;
+  }
+
+  auto run = make_shared_ptr<ExportRun>();
+  auto &record = run->record;
+  auto &timer = run->timer;
+  record.start_time = Timestamp::GetCurrentTimestamp();
+  record.connection_name = req.get_header_value("X-DuckDB-UI-Connection-Name");
+  record.description = req.get_header_value("X-DuckDB-UI-Request-Description");
+  timer.Enter(RunPhase::DECODE);
+
+  auto format = req.get_header_value("X-DuckDB-UI-Export-Format");
+  std::string options;
+  std::string extension;
+  std::string content_type;
+  if (!GetExportFormat(format, options, extension, content_type)) {
+    SetResponseErrorResult(
+        res, record, StringUtil::Format("Unknown export format: '%s'", format));
+    return;
+  }
+  // Any codec COPY supports for the format, e.g. "gzip", "zstd" or "snappy".
+  auto compression = req.get_header_value("X-DuckDB-UI-Export-Compression");
+  if (!compression.empty()) {
+    options += ", COMPRESSION " + KeywordHelper::WriteQuoted(compression, '\'');
+  }
+  auto file_name =
+      DecodeBase64(req.get_header_value("X-DuckDB-UI-Export-File-Name"));
+
+  std::string content = ReadContent(content_reader);
+  record.sql_hash = Hash(content.c_str(), content.size());
+
+  auto db = LockDatabaseInstance(req);
+  if (!db) {
+    SetResponseErrorResult(res, record, MissingDatabaseError(req));
+    return;
+  }
+  run->db = db;
+
+  try {
+    auto temp_directory =
+        BufferManager::GetBufferManager(*db).GetTemporaryDirectory();
+    if (temp_directory.empty()) {
+      throw InvalidInputException(
+          "Exports need a temp directory (SET temp_directory)");
+    }
+    auto &fs = FileSystem::GetFileSystem(*db);
+    if (!fs.DirectoryExists(temp_directory)) {
+      fs.CreateDirectory(temp_directory);
+    }
+    // Other processes may share the temp directory.
+    run->file_path = fs.JoinPath(
+        temp_directory,
+        StringUtil::Format("ui_export_%s%s",
+                           UUID::ToString(UUID::GenerateRandomUUID()),
+                           extension));
+
+    run->connection =
+        UIStorageExtensionInfo::GetState(*db).FindOrCreateConnection(
+            *db, record.connection_name);
+    run->max_bytes = GetMaxExportBytes(*run->connection->context);
+    WaitForResultTableWriter(*run->connection);
+
+    timer.Enter(RunPhase::PARSE);
+    auto statements = UIStorageExtensionInfo::GetState(*db)
+                          .GetStatementCache()
+                          .ExtractStatements(*run->connection, content);
+    if (statements.size() != 1 ||
+        statements[0]->type != StatementType::SELECT_STATEMENT) {
+      throw InvalidInputException("Only a single query can be exported");
+    }
+    // The query as the client wrote it: ToString doesn't round-trip every
+    // statement.
+    auto copy_sql = StringUtil::Format(
+        "COPY (%s) TO %s (%s)", GetStatementText(content, *statements[0]),
+        KeywordHelper::WriteQuoted(run->file_path, '\''), options);
+
+    timer.Enter(RunPhase::PREPARE);
+    run->pending = run->connection->PendingQuery(copy_sql, false);
+    if (run->pending->HasError()) {
+      throw InvalidInputException(run->pending->GetError());
+    }
+
+    // Errors found before anything is written are sent as an ErrorResult.
+    // Later ones abort the response.
+    timer.Enter(RunPhase::EXECUTE);
+    while (!run->finished && run->AvailableBytes() == 0) {
+      run->Step();
+    }
+  } catch (std::exception &ex) {
+    ErrorData error(ex);
+    run->error = error.RawMessage();
+  }
+  if (!run->error.empty()) {
+    SetResponseErrorResult(res, record, run->error);
+    timer.Stop();
+    LogRun(db, timer, record, res.body.size());
+    return;
+  }
+
+  if (!file_name.empty()) {
+    file_name = StringUtil::Replace(file_name, "\"", "");
+    res.set_header(
+        "Content-Disposition",
+        StringUtil::Format("attachment; filename=\"%s\"", file_name));
+  }
+  res.set_chunked_content_provider(
+      content_type,
+      [this, run](size_t /*offset*/, httplib::DataSink &sink) {
+        while (true) {
+          const auto available = run->AvailableBytes();
+          if (available > 0) {
+            const auto length = MinValue(available, RESPONSE_SEND_SIZE);
+            run->buffer.resize(length);
+            run->file_handle->Read(&run->buffer[0], length, run->sent);
+            if (!sink.write(run->buffer.data(), length)) {
+              return false;
+            }
+            run->sent += length;
+            metrics.RecordExportBytes(length);
+            return true;
+          }
+          if (run->finished) {
+            if (!run->error.empty()) {
+              run->record.error = run->error;
+              return false;
+            }
+            sink.done();
+            return true;
+          }
+          run->Step();
+        }
+      },
+      [this, run](bool /*success*/) {
+        // The client is gone: stop the COPY.
+        if (!run->finished) {
+          run->connection->Interrupt();
+          while (!run->finished) {
+            run->Step();
+          }
+          run->record.error = run->error;
+        }
+        run->timer.Stop();
+        LogRun(run->db, run->timer, run->record, run->sent);
+      });
+}
+
 std::string
 HttpServer::ReadContent(const httplib::ContentReader &content_reader) {
   std::ostringstream oss;
@@ -711,10 +2369,30 @@ void HttpServer::SetResponseContent(httplib::Response &res,
                                     const MemoryStream &content) {
   auto data = content.GetData();
   auto length = content.GetPosition();
+  metrics.RecordBytesSerialized(length);
   res.set_content(reinterpret_cast<const char *>(data), length,
                   "application/octet-stream");
 }
 
+void HttpServer::SetResponseContent(httplib::Response &res,
+                                    shared_ptr<ResponseBuffer> content) {
+  content->Finish();
+  const auto length = content->GetSize();
+  metrics.RecordBytesSerialized(length);
+  // One piece is copied at a time, always to the same buffer.
+  auto piece = make_shared_ptr<std::vector<char>>(
+      MinValue<idx_t>(length, RESPONSE_SEND_SIZE));
+  res.set_content_provider(
+      length, "application/octet-stream",
+      [content, piece](size_t offset, size_t length, httplib::DataSink &sink) {
+        // httplib asks for everything that's left; send it piece by piece.
+        const auto to_send = MinValue<idx_t>(length, piece->size());
+        content->Read(offset, reinterpret_cast<data_ptr_t>(piece->data()),
+                      to_send);
+        return sink.write(piece->data(), to_send);
+      });
+}
+
 void HttpServer::SetResponseEmptyResult(httplib::Response &res) {
   EmptyResult empty_result;
   MemoryStream response_content;
@@ -731,6 +2409,95 @@ void HttpServer::SetResponseErrorResult(httplib::Response &res,
   SetResponseContent(res, response_content);
 }
 
+void HttpServer::SetResponseErrorResult(httplib::Response &res,
+                                        QueryLogRecord &record,
+                                        const std::string &error) {
+  record.error = error;
+  SetResponseErrorResult(res, error);
+}
+
+void HttpServer::AddResultTableWriter(unique_ptr<ResultTableWriter> writer) {
+  std::lock_guard<std::mutex> guard(result_table_writers_mutex);
+  // Drop writers that are done, so finished connections aren't held.
+  for (auto it = result_table_writers.begin();
+       it != result_table_writers.end();) {
+    if (it->second->IsDone()) {
+      it = result_table_writers.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  auto &user_connection = writer->GetUserConnection();
+  result_table_writers[&user_connection] = std::move(writer);
+}
+
+void HttpServer::WaitForResultTableWriter(Connection &connection) {
+  unique_ptr<ResultTableWriter> writer;
+  {
+    std::lock_guard<std::mutex> guard(result_table_writers_mutex);
+    auto it = result_table_writers.find(&connection);
+    if (it == result_table_writers.end()) {
+      return;
+    }
+    writer = std::move(it->second);
+    result_table_writers.erase(it);
+  }
+  writer->Wait();
+}
+
+void HttpServer::CancelResultTableWriters() {
+  std::unordered_map<Connection *, unique_ptr<ResultTableWriter>> writers;
+  {
+    std::lock_guard<std::mutex> guard(result_table_writers_mutex);
+    std::swap(writers, result_table_writers);
+  }
+  for (auto &entry : writers) {
+    entry.second->Cancel();
+    entry.second->Wait();
+  }
+}
+
+// The estimate of a pushed-down LIMIT (or the TOP_N it became) is the limit
+// itself, so skip to its input, looking through projections on top of it.
+static idx_t EstimateBelowLimit(const PhysicalOperator &root) {
+  const PhysicalOperator *op = &root;
+  while (op->type == PhysicalOperatorType::PROJECTION) {
+    auto children = op->GetChildren();
+    if (children.size() != 1) {
+      return root.estimated_cardinality;
+    }
+    op = &children[0].get();
+  }
+  if (op->type != PhysicalOperatorType::LIMIT &&
+      op->type != PhysicalOperatorType::STREAMING_LIMIT &&
+      op->type != PhysicalOperatorType::TOP_N) {
+    return root.estimated_cardinality;
+  }
+  auto children = op->GetChildren();
+  if (children.size() != 1) {
+    return root.estimated_cardinality;
+  }
+  return children[0].get().estimated_cardinality;
+}
+
+optional_idx HttpServer::GetEstimatedCardinality(PreparedStatement &prepared,
+                                                 bool below_limit) {
+  auto &data = *prepared.data;
+#if DUCKDB_VERSION_AT_LEAST(1, 3, 0)
+  if (!data.physical_plan) {
+    return optional_idx();
+  }
+  auto &root = data.physical_plan->Root();
+#else
+  if (!data.plan) {
+    return optional_idx();
+  }
+  auto &root = *data.plan;
+#endif
+  return optional_idx(below_limit ? EstimateBelowLimit(root)
+                                  : root.estimated_cardinality);
+}
+
 void HttpServer::CopyAndSlice(duckdb::DataChunk &source,
                               duckdb::DataChunk &target, idx_t row_count) {
   target.InitializeEmpty(source.GetTypes());
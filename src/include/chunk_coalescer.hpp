@@ -0,0 +1,43 @@
+#pragma once
+
+#include <duckdb.hpp>
+
+#include "utils/serialization.hpp"
+
+namespace duckdb {
+namespace ui {
+
+// Combines the chunks of a result into batches of about `target_rows` rows or
+// `target_bytes` bytes, whichever is reached first, before they are
+// serialized.
+//
+// Selective queries produce many small chunks, each of which costs its own
+// framing and vector headers on the wire and its own decoding in the client.
+// Small chunks are copied into a batch with the same column types; chunks that
+// are large enough on their own are passed through without copying.
+class ChunkCoalescer {
+public:
+  ChunkCoalescer(const duckdb::vector<LogicalType> &types, idx_t target_rows,
+                 idx_t target_bytes);
+
+  // Adds the rows of `chunk`, moving its vectors if passed through. Completed
+  // batches are appended to `batches`.
+  void Append(DataChunk &chunk, duckdb::vector<Chunk> &batches);
+  // Appends the last, partial batch, if any.
+  void Finish(duckdb::vector<Chunk> &batches);
+
+  // Rough size of the chunk's data: fixed-size values plus string lengths.
+  static idx_t EstimateSize(DataChunk &chunk);
+
+private:
+  static void Emit(DataChunk &chunk, duckdb::vector<Chunk> &batches);
+
+  duckdb::vector<LogicalType> types;
+  idx_t target_rows;
+  idx_t target_bytes;
+  unique_ptr<DataChunk> batch;
+  idx_t batch_bytes;
+};
+
+} // namespace ui
+} // namespace duckdb
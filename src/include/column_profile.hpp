@@ -0,0 +1,79 @@
+#pragma once
+
+#include <duckdb.hpp>
+
+#include <array>
+
+#include "utils/serialization.hpp"
+
+namespace duckdb {
+namespace ui {
+
+// HyperLogLog sketch with 2^12 one-byte registers (~1.6% standard error).
+class DistinctCountSketch {
+public:
+  DistinctCountSketch();
+
+  void Insert(hash_t hash);
+  idx_t Estimate() const;
+
+private:
+  static constexpr idx_t PRECISION = 12;
+  static constexpr idx_t REGISTER_COUNT = idx_t(1) << PRECISION;
+  std::array<uint8_t, REGISTER_COUNT> registers;
+};
+
+// Equi-width histogram built in a single pass. The range is initialized from
+// the first values seen and doubled, merging adjacent buckets, whenever a
+// value falls outside it, so counts stay exact while the bucket count stays
+// fixed.
+class StreamingHistogram {
+public:
+  static constexpr idx_t BUCKET_COUNT = 32;
+
+  void Add(double value);
+  // Returns false if no finite value was added.
+  bool Finalize(double &lower, double &bucket_width,
+                duckdb::vector<idx_t> &counts);
+
+private:
+  static constexpr idx_t INITIAL_BUFFER_SIZE = 2048;
+
+  void Initialize();
+  void Insert(double value);
+
+  bool initialized = false;
+  duckdb::vector<double> buffer;
+  double lower = 0;
+  double bucket_width = 1;
+  std::array<idx_t, BUCKET_COUNT> counts = {};
+};
+
+// Computes per-column profiles (null count, distinct estimate, min/max and,
+// for numeric columns, a histogram) of the chunks of a result as they are
+// fetched. Each update processes a whole vector at a time.
+class ColumnProfiler {
+public:
+  explicit ColumnProfiler(const duckdb::vector<LogicalType> &types);
+
+  void Update(DataChunk &chunk);
+  duckdb::vector<ColumnProfile> Finalize();
+
+private:
+  struct ColumnState {
+    idx_t null_count = 0;
+    DistinctCountSketch distinct;
+    Value min;
+    Value max;
+    bool has_histogram = false;
+    StreamingHistogram histogram;
+  };
+
+  void UpdateColumn(idx_t column_index, Vector &vector, idx_t count);
+
+  duckdb::vector<LogicalType> types;
+  duckdb::vector<ColumnState> states;
+};
+
+} // namespace ui
+} // namespace duckdb
@@ -1,9 +1,18 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
+
+#include "metrics.hpp"
 
 namespace duckdb_httplib_openssl {
 class DataSink;
@@ -15,21 +24,91 @@ namespace ui {
 
 class EventDispatcher {
 public:
+  using clock = std::chrono::steady_clock;
+
+  explicit EventDispatcher(ServerMetrics &metrics);
+  ~EventDispatcher();
+
   void SendConnectedEvent(const std::string &token);
-  void SendCatalogChangedEvent();
+  // Catalog changes come in bursts (e.g. a script of DDL statements), and
+  // each event makes every open UI refresh its catalog. So, per instance, the
+  // first change is sent at once, but later ones are held back until none
+  // was raised for `debounce`, or the first held back has waited
+  // `max_delay`, and then sent as one event. The delays are the instance's
+  // own settings. Held back events are sent by a thread of the dispatcher
+  // when they are due.
+  void SendCatalogChangedEvent(const std::string &instance_id,
+                               std::chrono::milliseconds debounce,
+                               std::chrono::milliseconds max_delay);
+  // Sends the held back catalog change events that are due. Returns when the
+  // next one is due, or clock::time_point::max() if none is held back.
+  clock::time_point FlushCatalogChangedEvents();
+  void SendResultTableCompleteEvent(const std::string &database_name,
+                                    const std::string &schema_name,
+                                    const std::string &table_name,
+                                    uint64_t row_count,
+                                    const std::string &error);
+  // `phase` is "upload" while the body is received, then "load" once it's
+  // being loaded into the table, then "complete".
+  void SendIngestProgressEvent(const std::string &ingest_id,
+                               const std::string &phase, uint64_t byte_count,
+                               uint64_t row_count, const std::string &error);
 
-  bool WaitEvent(duckdb_httplib_openssl::DataSink *sink);
+  // The id of the next event sent. An event stream starts waiting from here.
+  uint64_t GetNextEventId();
+  // Writes the events from `next_event_id` on, waiting for one if needed,
+  // and advances `next_event_id` past them. Recent events are kept, so none
+  // are missed between calls, unless more than MAX_RECENT_EVENTS were sent.
+  bool WaitEvent(duckdb_httplib_openssl::DataSink *sink,
+                 uint64_t &next_event_id);
+  // Also stops sending held back catalog change events.
   void Close();
 
+  // Listeners get every event as it is sent, without holding a waiting
+  // thread. They are called outside the lock, so must be safe to call after
+  // RemoveListener returns.
+  using Listener = std::function<void(const std::string &message)>;
+  uint64_t AddListener(Listener listener);
+  void RemoveListener(uint64_t listener_id);
+
 private:
+  // Catalog changes of one instance since its last event.
+  struct PendingCatalogChange {
+    clock::time_point last_sent;
+    bool is_pending = false;
+    clock::time_point first_raised;
+    clock::time_point last_raised;
+    std::chrono::milliseconds debounce{0};
+    std::chrono::milliseconds max_delay{0};
+  };
+
   void SendEvent(const std::string &message);
+  void DoSendCatalogChangedEvent(const std::string &instance_id);
+  // Runs on `flush_thread` until Close.
+  void FlushCatalogChangedEventsLoop();
+
+  ServerMetrics &metrics;
+  std::mutex catalog_changes_mutex;
+  std::condition_variable catalog_changes_cv;
+  std::map<std::string, PendingCatalogChange> catalog_changes;
+  // When the flush thread next wakes up.
+  clock::time_point next_flush = clock::time_point::max();
+  bool stop_flushing = false;
+
+  static constexpr uint64_t MAX_RECENT_EVENTS = 64;
+
   std::mutex mutex;
   std::condition_variable cv;
-  std::atomic_int next_id{0};
-  std::atomic_int current_id{-1};
-  std::atomic_int wait_count{0};
-  std::string message;
-  std::atomic_bool closed{false};
+  uint64_t next_id = 0;
+  int wait_count = 0;
+  // The last events sent, by id, oldest first.
+  std::deque<std::pair<uint64_t, std::string>> recent_events;
+  bool closed = false;
+  uint64_t next_listener_id = 0;
+  std::map<uint64_t, Listener> listeners;
+
+  // Last, so it starts once everything it uses is constructed.
+  std::thread flush_thread;
 };
 } // namespace ui
 } // namespace duckdb
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <duckdb.hpp>
+#include <duckdb/common/allocator.hpp>
+#include <duckdb/common/types/column/column_data_collection.hpp>
+#include <duckdb/storage/buffer_manager.hpp>
+
+#include "utils/serialization.hpp"
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace duckdb {
+namespace ui {
+
+enum class WindowFilterOperator : uint8_t {
+  EQUAL,
+  NOT_EQUAL,
+  LESS_THAN,
+  LESS_THAN_OR_EQUAL,
+  GREATER_THAN,
+  GREATER_THAN_OR_EQUAL,
+  IS_NULL,
+  IS_NOT_NULL,
+  // Case-insensitive substring match on the value as text.
+  CONTAINS
+};
+
+// Parses the operator names of `/ddb/window` ("=", "!=", "<", "<=", ">",
+// ">=", "is_null", "is_not_null", "contains").
+WindowFilterOperator ParseWindowFilterOperator(const std::string &name);
+
+struct WindowSortKey {
+  idx_t column = 0;
+  bool descending = false;
+};
+
+struct WindowFilter {
+  idx_t column = 0;
+  WindowFilterOperator op = WindowFilterOperator::EQUAL;
+  // Unused by IS_NULL and IS_NOT_NULL.
+  std::string value;
+};
+
+// The rows of a held result to show, and their order. Filters are combined
+// with AND; ties between sort keys keep the result's order.
+struct WindowSpec {
+  duckdb::vector<WindowSortKey> sort_keys;
+  duckdb::vector<WindowFilter> filters;
+
+  bool IsIdentity() const { return sort_keys.empty() && filters.empty(); }
+  // Identifies the spec in the cache of row indexes.
+  std::string ToString() const;
+};
+
+// The materialized result of a `/ddb/run`, kept for the connection that ran
+// it so the grid can scroll, sort, and filter it without running the query
+// again.
+//
+// Rows are held in a ColumnDataCollection backed by the buffer manager, so
+// large results can be evicted to the temp directory. Sorting and filtering
+// produce a list of row indexes, which is cached per spec: once computed,
+// fetching a window only copies the visible rows. The cached lists, and the
+// row indexes and sort keys while sorting and filtering, are allocated through
+// the buffer manager too.
+class HeldResult {
+public:
+  HeldResult(ClientContext &context, duckdb::vector<std::string> names,
+             duckdb::vector<LogicalType> types);
+
+  // Adds the rows of `chunk`. Called while the result is fetched, before
+  // anyone else can see it.
+  void Append(DataChunk &chunk);
+
+  idx_t GetRowCount() const { return collection->Count(); }
+
+  // Fills `result` with at most `limit` rows of the view given by `spec`,
+  // starting at `offset`. Its total row count is the number of rows in the
+  // view.
+  void FetchWindow(const WindowSpec &spec, idx_t offset, idx_t limit,
+                   SuccessResult &result);
+
+private:
+  static constexpr idx_t MAX_CACHED_VIEWS = 4;
+
+  // The rows of a view, in order, as one UBIGINT column.
+  struct View {
+    shared_ptr<ColumnDataCollection> rows;
+    // Index of the first row of each chunk of `rows`.
+    duckdb::vector<idx_t> chunk_starts;
+  };
+
+  struct RowIndexes {
+    AllocatedData data;
+    idx_t count = 0;
+
+    idx_t *Get() { return reinterpret_cast<idx_t *>(data.get()); }
+  };
+
+  // Returns the view, or nullptr if it's the whole result in order.
+  shared_ptr<View> GetView(const WindowSpec &spec);
+  // Copies `count` row indexes of `view`, starting at `offset`, to `rows`.
+  static void ReadView(const View &view, idx_t offset, idx_t count,
+                       idx_t *rows);
+  // Room for `capacity` row indexes, none used yet.
+  RowIndexes AllocateRowIndexes(idx_t capacity);
+  RowIndexes Filter(const duckdb::vector<WindowFilter> &filters);
+  void Sort(const duckdb::vector<WindowSortKey> &sort_keys, RowIndexes &rows);
+  // Copies the given rows, in the given order, into `target`.
+  void Gather(const idx_t *rows, idx_t row_count, DataChunk &target);
+  static duckdb::vector<idx_t> GetChunkStarts(ColumnDataCollection &rows);
+
+  BufferManager &buffer_manager;
+  duckdb::vector<std::string> names;
+  duckdb::vector<LogicalType> types;
+  unique_ptr<ColumnDataCollection> collection;
+  // Index of the first row of each chunk of the collection.
+  duckdb::vector<idx_t> chunk_starts;
+
+  // Guards everything below, and reads of the collection.
+  std::mutex mutex;
+  // Most recently used first.
+  std::list<std::pair<std::string, shared_ptr<View>>> views;
+};
+
+} // namespace ui
+} // namespace duckdb
@@ -6,12 +6,21 @@
 #define CPPHTTPLIB_OPENSSL_SUPPORT
 #include "httplib.hpp"
 
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <unordered_map>
 
 #include "event_dispatcher.hpp"
+#include "metrics.hpp"
+#include "query_log.hpp"
+#include "response_buffer.hpp"
+#include "result_table_writer.hpp"
+#include "utils/phase_timer.hpp"
 #include "watcher.hpp"
+#include "websocket_server.hpp"
 
 namespace httplib = duckdb_httplib_openssl;
 
@@ -20,6 +29,10 @@ struct HTTPParams;
 class MemoryStream;
 
 namespace ui {
+struct BatchRun;
+struct ScriptRun;
+struct ScriptStatementResult;
+class WebSocketConnection;
 
 class HttpServer {
 
@@ -29,6 +42,9 @@ public:
 
   static HttpServer *GetInstance(ClientContext &);
   static void UpdateDatabaseInstanceIfRunning(shared_ptr<DatabaseInstance>);
+  // Makes the database instance reachable through the `X-DuckDB-UI-Instance`
+  // header, without making it the default.
+  static void AddDatabaseInstanceIfRunning(shared_ptr<DatabaseInstance>);
   static bool IsRunningOnMachine(ClientContext &);
   static bool Started();
   static void StopInstance();
@@ -37,54 +53,133 @@ public:
   static bool Stop();
 
   std::string LocalUrl() const;
+  // Empty if the server doesn't listen on a Unix domain socket.
+  const std::string &LocalSocketPath() const { return socket_path; }
 
 private:
+  friend class BatchTask;
+  friend class QueryLogFlusher;
   friend class Watcher;
+  friend class WebSocketConnection;
 
   // Lifecycle
   void DoStart(const uint16_t local_port, const std::string &remote_url,
+               const std::string &socket_path, uint16_t websocket_port,
                unique_ptr<HTTPParams>);
   void DoStop();
   void Run();
+  void RunSocket();
+  void RegisterRoutes(httplib::Server &target);
+  void BindSocket();
   void UpdateDatabaseInstance(shared_ptr<DatabaseInstance> context_db);
+  void AddDatabaseInstance(const shared_ptr<DatabaseInstance> &db);
 
   // Http handlers
   void HandleGetInfo(const httplib::Request &req, httplib::Response &res);
   void HandleGetLocalEvents(const httplib::Request &req,
                             httplib::Response &res);
   void HandleGetLocalToken(const httplib::Request &req, httplib::Response &res);
+  void HandleGetMetrics(const httplib::Request &req, httplib::Response &res);
   void HandleGet(const httplib::Request &req, httplib::Response &res);
   void HandleInterrupt(const httplib::Request &req, httplib::Response &res);
-  void DoHandleRun(const httplib::Request &req, httplib::Response &res,
-                   const httplib::ContentReader &content_reader);
+  // Returns false if the response is streamed, in which case the run is
+  // logged once the stream ends.
+  bool DoHandleRun(const httplib::Request &req, httplib::Response &res,
+                   const httplib::ContentReader &content_reader,
+                   PhaseTimer &timer, QueryLogRecord &record);
   void HandleRun(const httplib::Request &req, httplib::Response &res,
                  const httplib::ContentReader &content_reader);
   void HandleTokenize(const httplib::Request &req, httplib::Response &res,
                       const httplib::ContentReader &content_reader);
+  void HandleWindow(const httplib::Request &req, httplib::Response &res);
+  void HandleBatch(const httplib::Request &req, httplib::Response &res,
+                   const httplib::ContentReader &content_reader);
+  void HandleIngest(const httplib::Request &req, httplib::Response &res,
+                    const httplib::ContentReader &content_reader);
+  void HandleExport(const httplib::Request &req, httplib::Response &res,
+                    const httplib::ContentReader &content_reader);
   std::string ReadContent(const httplib::ContentReader &content_reader);
 
+  // Runs
+  void LogRun(shared_ptr<DatabaseInstance> db, const PhaseTimer &timer,
+              QueryLogRecord &record, idx_t byte_count);
+  void StreamScript(httplib::Response &res, shared_ptr<Connection> connection,
+                    vector<unique_ptr<SQLStatement>> statements, int row_limit,
+                    const PhaseTimer &timer, QueryLogRecord &record);
+  void RunScriptStatement(ScriptRun &script,
+                          ScriptStatementResult &statement_result);
+  // Runs `statement`, binding `parameter_values` if any, and fetches at most
+  // `row_limit` rows of its result into `statement_result`. Returns the number
+  // of rows fetched.
+  idx_t RunStatement(Connection &connection, unique_ptr<SQLStatement> statement,
+                     vector<Value> &parameter_values, idx_t row_limit,
+                     PhaseTimer &timer,
+                     ScriptStatementResult &statement_result);
+  // Runs query `index` of `batch` and returns its serialized result.
+  unique_ptr<MemoryStream> RunBatchQuery(BatchRun &batch,
+                                         Connection &connection, idx_t index);
+
   // Http responses
   void SetResponseContent(httplib::Response &res, const MemoryStream &content);
+  void SetResponseContent(httplib::Response &res,
+                          shared_ptr<ResponseBuffer> content);
   void SetResponseEmptyResult(httplib::Response &res);
   void SetResponseErrorResult(httplib::Response &res, const std::string &error);
+  void SetResponseErrorResult(httplib::Response &res, QueryLogRecord &record,
+                              const std::string &error);
 
-  // Misc
+  // Result tables
+  void AddResultTableWriter(unique_ptr<ResultTableWriter> writer);
+  void WaitForResultTableWriter(Connection &connection);
+  void CancelResultTableWriters();
+
+  // Database instances
+  // The default instance.
   shared_ptr<DatabaseInstance> LockDatabaseInstance();
+  // The instance named by the request's `X-DuckDB-UI-Instance` header, or the
+  // default one. nullptr if it's unknown or gone.
+  shared_ptr<DatabaseInstance>
+  LockDatabaseInstance(const httplib::Request &req);
+  // Every registered instance still alive, by id.
+  vector<std::pair<std::string, shared_ptr<DatabaseInstance>>>
+  LockDatabaseInstances();
+
+  // Misc
   void InitClientFromParams(httplib::Client &);
 
+  // If `below_limit`, the estimate of the input of a pushed-down row limit.
+  static optional_idx GetEstimatedCardinality(PreparedStatement &prepared,
+                                              bool below_limit);
   static void CopyAndSlice(duckdb::DataChunk &source, duckdb::DataChunk &target,
                            idx_t row_count);
 
   uint16_t local_port;
   std::string local_url;
   std::string remote_url;
+  // The default instance, for requests without an instance header.
   weak_ptr<DatabaseInstance> ddb_instance;
+  std::mutex instances_mutex;
+  // Every instance the server was used with, by instance id.
+  std::map<std::string, weak_ptr<DatabaseInstance>> instances;
   std::string user_agent;
   httplib::Server server;
   unique_ptr<std::thread> main_thread;
+  // Serves the same routes as `server`, if `ui_socket_path` is set.
+  std::string socket_path;
+  httplib::Server socket_server;
+  unique_ptr<std::thread> socket_thread;
+  // Only if `ui_websocket_port` is set.
+  unique_ptr<WebSocketServer> websocket_server;
   unique_ptr<EventDispatcher> event_dispatcher;
   unique_ptr<Watcher> watcher;
+  unique_ptr<QueryLogFlusher> query_log_flusher;
   unique_ptr<HTTPParams> http_params;
+  ServerMetrics metrics;
+  ResultTableWriterPool result_table_writer_pool;
+  std::mutex result_table_writers_mutex;
+  // At most one per connection, keyed by the user's connection.
+  std::unordered_map<Connection *, unique_ptr<ResultTableWriter>>
+      result_table_writers;
 
   static unique_ptr<HttpServer> server_instance;
 };
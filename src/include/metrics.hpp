@@ -0,0 +1,109 @@
+#pragma once
+
+#include <duckdb.hpp>
+
+#include "statement_cache.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+
+namespace duckdb {
+namespace ui {
+
+enum class MetricsRoute : uint8_t {
+  RUN = 0,
+  TOKENIZE,
+  INTERRUPT,
+  LOCAL_EVENTS,
+  PROXIED_GET,
+  WINDOW,
+  BATCH,
+  INGEST,
+  EXPORT,
+  OTHER,
+  COUNT // must be last
+};
+
+constexpr idx_t METRICS_ROUTE_COUNT = static_cast<idx_t>(MetricsRoute::COUNT);
+
+// Upper bounds (in seconds) of the histogram buckets, excluding +Inf.
+constexpr idx_t DURATION_BUCKET_COUNT = 14;
+
+// Fixed-bucket histogram of durations. Every counter is a relaxed atomic, so
+// recording from request threads never takes a lock.
+class DurationHistogram {
+public:
+  DurationHistogram();
+
+  void Record(std::chrono::steady_clock::duration duration);
+  void Render(std::ostringstream &out, const std::string &name,
+              const std::string &labels) const;
+
+private:
+  // The last bucket is +Inf.
+  std::array<std::atomic<uint64_t>, DURATION_BUCKET_COUNT + 1> bucket_counts;
+  std::atomic<uint64_t> count;
+  std::atomic<uint64_t> sum_us;
+};
+
+// Process-wide counters of the UI server, rendered in the Prometheus text
+// exposition format by the `/metrics` endpoint.
+class ServerMetrics {
+public:
+  ServerMetrics();
+
+  void RecordRequest(MetricsRoute route,
+                     std::chrono::steady_clock::duration duration);
+  void RecordRowsFetched(idx_t row_count);
+  void RecordBytesSerialized(idx_t byte_count);
+  void RecordIngest(idx_t byte_count, idx_t row_count,
+                    std::chrono::steady_clock::duration upload_duration,
+                    std::chrono::steady_clock::duration load_duration);
+  void RecordExportBytes(idx_t byte_count);
+  void RecordChunksReused(idx_t chunk_count);
+  void RecordWatcherPoll(std::chrono::steady_clock::duration duration);
+  void RecordCatalogEventRaised();
+  void RecordCatalogEventDelivered();
+  void EventStreamOpened();
+  void EventStreamClosed();
+
+  std::string Render(idx_t instance_count, idx_t named_connection_count,
+                     const StatementCacheStats &statement_cache_stats) const;
+
+private:
+  std::array<DurationHistogram, METRICS_ROUTE_COUNT> request_durations;
+  DurationHistogram watcher_poll_durations;
+  std::atomic<uint64_t> rows_fetched;
+  std::atomic<uint64_t> bytes_serialized;
+  std::atomic<uint64_t> ingest_bytes;
+  std::atomic<uint64_t> ingest_rows;
+  std::atomic<uint64_t> ingest_upload_us;
+  std::atomic<uint64_t> ingest_load_us;
+  std::atomic<uint64_t> export_bytes;
+  std::atomic<uint64_t> chunks_reused;
+  std::atomic<uint64_t> catalog_events_raised;
+  std::atomic<uint64_t> catalog_events_delivered;
+  std::atomic<int64_t> active_event_streams;
+};
+
+// Records the duration of a request handler when it goes out of scope.
+class ScopedRequestTimer {
+public:
+  ScopedRequestTimer(ServerMetrics &metrics, MetricsRoute route)
+      : metrics(metrics), route(route),
+        start(std::chrono::steady_clock::now()) {}
+  ~ScopedRequestTimer() {
+    metrics.RecordRequest(route, std::chrono::steady_clock::now() - start);
+  }
+
+private:
+  ServerMetrics &metrics;
+  MetricsRoute route;
+  std::chrono::steady_clock::time_point start;
+};
+
+} // namespace ui
+} // namespace duckdb
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <duckdb.hpp>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "utils/phase_timer.hpp"
+
+namespace duckdb {
+namespace ui {
+
+struct QueryLogRecord {
+  timestamp_t start_time;
+  std::string connection_name;
+  std::string description;
+  hash_t sql_hash = 0;
+  std::array<double, RUN_PHASE_COUNT> phase_ms;
+  double total_ms = 0;
+  idx_t row_count = 0;
+  idx_t byte_count = 0;
+  // Empty if the run succeeded.
+  std::string error;
+};
+
+// Fixed-capacity ring buffer of the most recent `/ddb/run` requests. A
+// capacity of zero disables logging.
+//
+// Request threads only ever hold the lock for a push, so appending never waits
+// on the table flush: records destined for the log table are queued and
+// written later by `Flush`, which the QueryLogFlusher calls from its own
+// thread.
+class QueryLog {
+public:
+  QueryLog() : capacity(0), next(0) {}
+
+  void SetCapacity(idx_t capacity);
+  // Name of a table in the `_duckdb_ui` schema to which records are flushed,
+  // or empty to keep records in memory only.
+  void SetTableName(const std::string &table_name);
+  bool IsEnabled() const { return capacity > 0; }
+
+  // Returns whether enough records are queued for the log table that they
+  // should be flushed without waiting for the next periodic flush.
+  bool Append(QueryLogRecord record);
+  // Returns the logged records, oldest first.
+  vector<QueryLogRecord> Snapshot();
+  // Appends queued records to the log table, creating it if needed.
+  void Flush(Connection &connection);
+
+private:
+  vector<QueryLogRecord> SnapshotInternal();
+
+  std::mutex mutex;
+  std::atomic<idx_t> capacity;
+  vector<QueryLogRecord> records;
+  // Once the buffer is full, the index of the oldest record.
+  idx_t next;
+  std::string table_name;
+  // Records not yet written to the log table. Bounded by the capacity.
+  std::deque<QueryLogRecord> pending;
+};
+
+class HttpServer;
+
+// Flushes the query log of every database instance the server is used with,
+// periodically and whenever `Notify` is called. Runs on its own thread, so
+// flushing neither delays responses nor depends on the watcher.
+class QueryLogFlusher {
+public:
+  QueryLogFlusher(HttpServer &server);
+
+  void Start();
+  // Flushes once more before returning.
+  void Stop();
+  // Requests a flush as soon as possible.
+  void Notify();
+
+private:
+  void Run();
+  void FlushAll();
+
+  HttpServer &server;
+  unique_ptr<std::thread> thread;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool should_run;
+  bool flush_requested;
+};
+
+TableFunction GetQueryLogFunction();
+
+} // namespace ui
+} // namespace duckdb
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <duckdb.hpp>
+#include <duckdb/common/file_system.hpp>
+#include <duckdb/common/serializer/write_stream.hpp>
+#include <duckdb/storage/buffer/buffer_handle.hpp>
+
+#include <string>
+
+namespace duckdb {
+namespace ui {
+
+// Holds a serialized response until it has been sent.
+//
+// Bytes are kept in fixed-size segments allocated from the database's buffer
+// manager, so they count against its memory limit. Once the memory budget is
+// exceeded, or the buffer manager can't provide another segment, everything
+// is written to a file in DuckDB's temp directory, and the rest of the
+// response goes there too, through a single segment.
+class ResponseBuffer : public WriteStream {
+public:
+  ResponseBuffer(shared_ptr<DatabaseInstance> db, idx_t memory_budget);
+  ~ResponseBuffer() override;
+
+  void WriteData(const_data_ptr_t buffer, idx_t write_size) override;
+  // Writes out bytes still buffered for the file. Call before `Read`.
+  void Finish();
+  // Bytes sent before and after the written ones, for responses whose start
+  // is only known once the rest is written. See ChunkSerializer.
+  void SetHeadAndTail(std::string head, std::string tail);
+
+  // Includes the head and tail.
+  idx_t GetSize() const { return head.size() + size + tail.size(); }
+  bool IsSpilled() const { return file_handle != nullptr; }
+  // Copies `length` bytes starting at `offset` to `target`.
+  void Read(idx_t offset, data_ptr_t target, idx_t length);
+
+private:
+  static constexpr idx_t SEGMENT_SIZE = 256 * 1024;
+
+  // Makes room for more bytes, once the last segment is full.
+  void NextSegment();
+  bool CanSpill();
+  void Spill();
+  // Like `Read`, within the written bytes.
+  void ReadWritten(idx_t offset, data_ptr_t target, idx_t length);
+
+  shared_ptr<DatabaseInstance> db;
+  idx_t memory_budget;
+  vector<BufferHandle> segments;
+  // Bytes used in the last segment.
+  idx_t segment_offset;
+  idx_t size;
+
+  std::string file_path;
+  unique_ptr<FileHandle> file_handle;
+  // Bytes written to the file so far.
+  idx_t file_size;
+
+  std::string head;
+  std::string tail;
+};
+
+} // namespace ui
+} // namespace duckdb
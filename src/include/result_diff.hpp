@@ -0,0 +1,93 @@
+#pragma once
+
+#include <duckdb.hpp>
+
+#include "utils/serialization.hpp"
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace duckdb {
+namespace ui {
+
+// Hash of the types and contents of `chunk`.
+hash_t HashChunk(const Chunk &chunk);
+
+// Hash of the bits of every FLOAT and DOUBLE in `chunk`, including those
+// nested in lists, arrays and structs.
+hash_t HashChunkFloatBits(const Chunk &chunk);
+
+// Two hashes of a chunk: of its values, and of the bits of its floating point
+// values. Value hashing treats some different values as equal (0.0 and -0.0,
+// NaNs with different payloads), so it's not enough on its own to decide the
+// client already has a chunk. Both are computed from the vectors, before the
+// chunk is serialized.
+struct ChunkHash {
+  hash_t values;
+  hash_t float_bits;
+
+  bool operator==(const ChunkHash &other) const {
+    return values == other.values && float_bits == other.float_bits;
+  }
+};
+
+struct ChunkHashFunction {
+  size_t operator()(const ChunkHash &hash) const {
+    return static_cast<size_t>(hash.values ^ hash.float_bits);
+  }
+};
+
+// The chunks of one result, compared with those of the last result the client
+// has. See ResultDiffCache.
+class ResultDiff {
+public:
+  // Returns 0 if `chunk` must be sent, otherwise 1 + the index of the same
+  // chunk in the client's result. Chunks are added in order.
+  idx_t AddChunk(const Chunk &chunk);
+  idx_t GetReferenceCount() const { return reference_count; }
+
+private:
+  friend class ResultDiffCache;
+
+  duckdb::vector<ChunkHash> chunk_hashes;
+  // Empty if the client doesn't have the last result.
+  std::unordered_map<ChunkHash, idx_t, ChunkHashFunction> previous_indexes;
+  idx_t reference_count = 0;
+};
+
+// The chunk hashes of the last result sent for each (connection, result id)
+// pair, for runs with an `X-DuckDB-UI-Result-Id` header.
+//
+// A client that re-runs a query sends the version of the result it holds. If
+// that's the last one sent, chunks it already has are replaced by references
+// to them, and aren't sent again. The version covers every chunk, so a client
+// that missed a response just gets every chunk.
+//
+// Bounded: the least recently used results are forgotten.
+class ResultDiffCache {
+public:
+  // Starts a result for `key`, compared with the last one if
+  // `client_version` is its version.
+  ResultDiff Begin(const std::string &key, optional_idx client_version);
+  // Remembers the chunks of the result for `key`, replacing the last one, and
+  // returns its version.
+  uint64_t Finish(const std::string &key, ResultDiff &diff);
+
+private:
+  static constexpr idx_t MAX_ENTRIES = 64;
+
+  struct Entry {
+    uint64_t version;
+    duckdb::vector<ChunkHash> chunk_hashes;
+  };
+
+  std::mutex mutex;
+  // Most recently used first.
+  std::list<std::pair<std::string, Entry>> entries;
+};
+
+} // namespace ui
+} // namespace duckdb
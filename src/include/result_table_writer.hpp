@@ -0,0 +1,98 @@
+#pragma once
+
+#include <duckdb.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace duckdb {
+namespace ui {
+
+class ResultTableWriter;
+
+// Threads running the result table writers of every run, so concurrent runs
+// share a fixed number of threads. A writer queued while all are busy waits
+// for one to finish; meanwhile its request thread blocks once the writer's
+// chunk queue is full.
+class ResultTableWriterPool {
+public:
+  void Start(idx_t thread_count);
+  // Writers must be finished or cancelled first; queued ones still run.
+  void Stop();
+  void Schedule(ResultTableWriter &writer);
+
+private:
+  void Work();
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool should_run = false;
+  std::deque<ResultTableWriter *> ready;
+  vector<std::thread> threads;
+};
+
+// Appends the rows of a run to its result table on a pool thread.
+//
+// The request thread queues the chunks it fetches for the client, then hands
+// over the rest of the result with `Finish` and responds without waiting. The
+// worker keeps fetching from the user's connection until the table row limit
+// is reached or the result is exhausted, so the connection must not run
+// another query until `Wait` returns.
+class ResultTableWriter {
+public:
+  // Called on the worker thread once the table is complete. `error` is empty
+  // on success.
+  using CompletionCallback =
+      std::function<void(idx_t row_count, const std::string &error)>;
+
+  ResultTableWriter(ResultTableWriterPool &pool,
+                    shared_ptr<Connection> user_connection,
+                    unique_ptr<Connection> appender_connection,
+                    unique_ptr<Appender> appender, idx_t row_limit,
+                    CompletionCallback on_complete);
+  ~ResultTableWriter();
+
+  // Queues a chunk for appending. Blocks while the queue is full.
+  void Append(DataChunk &chunk);
+  // Hands over the remaining, not yet fetched, part of the result. Only the
+  // first call has an effect.
+  void Finish(unique_ptr<QueryResult> result);
+  // Stops fetching from the user's connection as soon as possible.
+  void Cancel();
+  // Waits for the worker to finish.
+  void Wait();
+  bool IsDone();
+
+  Connection &GetUserConnection() { return *user_connection; }
+
+private:
+  friend class ResultTableWriterPool;
+
+  static constexpr idx_t MAX_QUEUED_CHUNKS = 16;
+
+  void Run();
+  void AppendChunk(DataChunk &chunk);
+
+  shared_ptr<Connection> user_connection;
+  unique_ptr<Connection> appender_connection;
+  unique_ptr<Appender> appender;
+  idx_t row_limit;
+  idx_t rows_appended;
+  CompletionCallback on_complete;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<unique_ptr<DataChunk>> queue;
+  unique_ptr<QueryResult> remaining_result;
+  bool finished;
+  bool done;
+  // Set once Run has returned, after the completion callback.
+  bool returned;
+};
+
+} // namespace ui
+} // namespace duckdb
@@ -9,6 +9,36 @@
 #define UI_REMOTE_URL_SETTING_DEFAULT "https://ui.duckdb.org"
 #define UI_POLLING_INTERVAL_SETTING_NAME "ui_polling_interval"
 #define UI_POLLING_INTERVAL_SETTING_DEFAULT 284
+#define UI_CATALOG_EVENT_DEBOUNCE_SETTING_NAME "ui_catalog_event_debounce"
+#define UI_CATALOG_EVENT_DEBOUNCE_SETTING_DEFAULT 500
+#define UI_CATALOG_EVENT_MAX_DELAY_SETTING_NAME "ui_catalog_event_max_delay"
+#define UI_CATALOG_EVENT_MAX_DELAY_SETTING_DEFAULT 2000
+#define UI_SOCKET_PATH_SETTING_NAME "ui_socket_path"
+#define UI_SOCKET_PATH_SETTING_DEFAULT ""
+#define UI_WEBSOCKET_PORT_SETTING_NAME "ui_websocket_port"
+#define UI_WEBSOCKET_PORT_SETTING_DEFAULT 0
+#define UI_QUERY_LOG_SIZE_SETTING_NAME "ui_query_log_size"
+#define UI_QUERY_LOG_SIZE_SETTING_DEFAULT 0
+#define UI_QUERY_LOG_TABLE_SETTING_NAME "ui_query_log_table"
+#define UI_QUERY_LOG_TABLE_SETTING_DEFAULT ""
+#define UI_STATEMENT_CACHE_SIZE_SETTING_NAME "ui_statement_cache_size"
+#define UI_STATEMENT_CACHE_SIZE_SETTING_DEFAULT 256
+#define UI_STATEMENT_CACHE_BYTES_SETTING_NAME "ui_statement_cache_bytes"
+#define UI_STATEMENT_CACHE_BYTES_SETTING_DEFAULT 16777216
+#define UI_DIRECT_RESULT_TABLES_SETTING_NAME "ui_direct_result_tables"
+#define UI_DIRECT_RESULT_TABLES_SETTING_DEFAULT true
+#define UI_PUSH_ROW_LIMITS_SETTING_NAME "ui_push_row_limits"
+#define UI_PUSH_ROW_LIMITS_SETTING_DEFAULT true
+#define UI_RESULT_BATCH_ROWS_SETTING_NAME "ui_result_batch_rows"
+#define UI_RESULT_BATCH_ROWS_SETTING_DEFAULT 2048
+#define UI_RESULT_BATCH_BYTES_SETTING_NAME "ui_result_batch_bytes"
+#define UI_RESULT_BATCH_BYTES_SETTING_DEFAULT 1048576
+#define UI_RESPONSE_MEMORY_BUDGET_SETTING_NAME "ui_response_memory_budget"
+#define UI_RESPONSE_MEMORY_BUDGET_SETTING_DEFAULT 134217728
+#define UI_MAX_INGEST_BYTES_SETTING_NAME "ui_max_ingest_bytes"
+#define UI_MAX_INGEST_BYTES_SETTING_DEFAULT 4294967296
+#define UI_MAX_EXPORT_BYTES_SETTING_NAME "ui_max_export_bytes"
+#define UI_MAX_EXPORT_BYTES_SETTING_DEFAULT 4294967296
 
 namespace duckdb {
 
@@ -28,5 +58,19 @@ T GetSetting(const ClientContext &context, const char *setting_name) {
 std::string GetRemoteUrl(const ClientContext &);
 uint16_t GetLocalPort(const ClientContext &);
 uint32_t GetPollingInterval(const ClientContext &);
+uint32_t GetCatalogEventDebounce(const ClientContext &);
+uint32_t GetCatalogEventMaxDelay(const ClientContext &);
+// Relative paths are resolved in ~/.duckdb/extension_data/ui. Empty if not
+// set.
+std::string GetSocketPath(const ClientContext &);
+// 0 if the WebSocket transport is disabled.
+uint16_t GetWebSocketPort(const ClientContext &);
+bool GetDirectResultTables(const ClientContext &);
+bool GetPushRowLimits(const ClientContext &);
+uint32_t GetResultBatchRows(const ClientContext &);
+uint64_t GetResultBatchBytes(const ClientContext &);
+uint64_t GetResponseMemoryBudget(const ClientContext &);
+uint64_t GetMaxIngestBytes(const ClientContext &);
+uint64_t GetMaxExportBytes(const ClientContext &);
 
 } // namespace duckdb
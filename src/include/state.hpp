@@ -4,21 +4,48 @@
 #include <duckdb/storage/storage_extension.hpp>
 #include <duckdb/main/connection.hpp>
 
+#include "held_result.hpp"
+#include "query_log.hpp"
+#include "result_diff.hpp"
+#include "statement_cache.hpp"
+
 namespace duckdb {
 const static std::string STORAGE_EXTENSION_KEY = "ui";
 
 class UIStorageExtensionInfo : public StorageExtensionInfo {
 public:
+  UIStorageExtensionInfo();
+
   static UIStorageExtensionInfo &GetState(const DatabaseInstance &instance);
 
+  // Identifies the database instance to the UI server, which routes requests
+  // with an `X-DuckDB-UI-Instance` header to it. Unique within the process.
+  const std::string &GetInstanceId() const { return instance_id; }
+
   shared_ptr<Connection> FindConnection(const std::string &connection_name);
   shared_ptr<Connection>
   FindOrCreateConnection(DatabaseInstance &db,
                          const std::string &connection_name);
+  idx_t GetConnectionCount();
+
+  // The result held for `/ddb/window` requests on a named connection. Setting
+  // nullptr releases it.
+  void SetHeldResult(const std::string &connection_name,
+                     shared_ptr<ui::HeldResult> held_result);
+  shared_ptr<ui::HeldResult> FindHeldResult(const std::string &connection_name);
+
+  ui::QueryLog &GetQueryLog() { return query_log; }
+  ui::StatementCache &GetStatementCache() { return statement_cache; }
+  ui::ResultDiffCache &GetResultDiffCache() { return result_diff_cache; }
 
 private:
+  std::string instance_id;
   std::mutex connections_mutex;
   std::unordered_map<std::string, shared_ptr<Connection>> connections;
+  std::unordered_map<std::string, shared_ptr<ui::HeldResult>> held_results;
+  ui::QueryLog query_log;
+  ui::StatementCache statement_cache;
+  ui::ResultDiffCache result_diff_cache;
 };
 
 } // namespace duckdb
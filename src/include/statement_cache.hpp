@@ -0,0 +1,84 @@
+#pragma once
+
+#include <duckdb.hpp>
+#include <duckdb/parser/parser_options.hpp>
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace duckdb {
+namespace ui {
+
+struct StatementCacheStats {
+  idx_t hits = 0;
+  idx_t misses = 0;
+  idx_t entries = 0;
+  // Estimated; see StatementCache.
+  idx_t bytes = 0;
+};
+
+// Bounded LRU cache of parsed statements, keyed by a hash of the SQL text.
+//
+// The UI sends the same SQL over and over (e.g. its catalog queries on every
+// refresh), so parsing it once is enough. Cached trees are never handed out:
+// every lookup returns copies, which the caller is free to consume. A
+// capacity of zero disables caching.
+//
+// The cache is bounded both by entry count and by bytes, so a few large
+// scripts can't pin much memory. The size of parsed trees isn't known, so an
+// entry is charged ENTRY_BYTES_PER_SQL_BYTE for each byte of its SQL text,
+// which it keeps too. SQL larger than the byte limit isn't cached.
+class StatementCache {
+public:
+  static constexpr idx_t ENTRY_BYTES_PER_SQL_BYTE = 4;
+
+  StatementCache()
+      : capacity(0), max_bytes(NumericLimits<idx_t>::Maximum()), bytes(0),
+        hits(0), misses(0) {}
+
+  void SetCapacity(idx_t capacity);
+  void SetMaxBytes(idx_t max_bytes);
+
+  // Returns the statements of `sql`, as `connection.ExtractStatements` would.
+  vector<unique_ptr<SQLStatement>> ExtractStatements(Connection &connection,
+                                                     const std::string &sql);
+
+  StatementCacheStats GetStats();
+
+private:
+  struct Entry {
+    std::string sql;
+    // Parser settings that change the resulting trees.
+    bool preserve_identifier_case;
+    bool integer_division;
+    idx_t bytes;
+    // Shared so lookups can copy the trees without holding the lock.
+    shared_ptr<const vector<unique_ptr<SQLStatement>>> statements;
+  };
+  using EntryList = std::list<std::pair<hash_t, Entry>>;
+
+  static vector<unique_ptr<SQLStatement>>
+  CopyStatements(const vector<unique_ptr<SQLStatement>> &statements);
+  shared_ptr<const vector<unique_ptr<SQLStatement>>>
+  TryGet(hash_t hash, const std::string &sql, const ParserOptions &options);
+  void Put(hash_t hash, Entry entry);
+  // Drops the least recently used entries until both limits are met.
+  void Evict();
+
+  std::mutex mutex;
+  std::atomic<idx_t> capacity;
+  idx_t max_bytes;
+  // Of all entries.
+  idx_t bytes;
+  // Most recently used first.
+  EntryList entries;
+  std::unordered_map<hash_t, EntryList::iterator> index;
+  std::atomic<idx_t> hits;
+  std::atomic<idx_t> misses;
+};
+
+} // namespace ui
+} // namespace duckdb
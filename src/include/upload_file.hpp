@@ -0,0 +1,46 @@
+#pragma once
+
+#include <duckdb.hpp>
+#include <duckdb/common/file_system.hpp>
+#include <duckdb/storage/buffer/buffer_handle.hpp>
+
+#include <string>
+
+namespace duckdb {
+namespace ui {
+
+// The body of an upload, written as it arrives to a file in DuckDB's temp
+// directory, so DuckDB's readers can load it from there. Parquet needs random
+// access, and the CSV and JSON readers work in parallel on files, so the body
+// isn't fed to them as a stream.
+//
+// Bytes go through a single fixed-size buffer allocated from the database's
+// buffer manager: memory use doesn't grow with the size of the upload. The
+// file is removed on destruction.
+class UploadFile {
+public:
+  // `extension` (e.g. ".csv") ends the name of the file.
+  UploadFile(shared_ptr<DatabaseInstance> db, const std::string &extension);
+  ~UploadFile();
+
+  void Write(const char *data, idx_t write_size);
+  // Writes out bytes still buffered. Call before reading the file.
+  void Finish();
+
+  const std::string &GetPath() const { return file_path; }
+  idx_t GetSize() const { return size; }
+
+private:
+  static constexpr idx_t BUFFER_SIZE = 1024 * 1024;
+
+  shared_ptr<DatabaseInstance> db;
+  std::string file_path;
+  unique_ptr<FileHandle> file_handle;
+  BufferHandle buffer;
+  // Bytes used in the buffer.
+  idx_t buffer_offset;
+  idx_t size;
+};
+
+} // namespace ui
+} // namespace duckdb
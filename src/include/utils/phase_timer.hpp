@@ -0,0 +1,63 @@
+#pragma once
+
+#include <duckdb.hpp>
+
+#include <array>
+#include <chrono>
+#include <string>
+
+namespace duckdb {
+namespace ui {
+
+// The phases of a `/ddb/run` request, in the order they normally occur.
+enum class RunPhase : uint8_t {
+  DECODE = 0, // headers, request body, connection setup
+  PARSE,      // ExtractStatements
+  PREPARE,    // Prepare / PendingQuery
+  EXECUTE,    // ExecuteTask loop
+  FETCH,      // result->Fetch
+  APPEND,     // result table creation and Appender
+  PROFILE,    // column profiles
+  SERIALIZE,  // BinarySerializer
+  COUNT       // must be last
+};
+
+constexpr idx_t RUN_PHASE_COUNT = static_cast<idx_t>(RunPhase::COUNT);
+
+const char *RunPhaseName(RunPhase phase);
+
+// Accumulates wall-clock time per phase. A phase may be entered several times
+// (fetching and appending alternate per chunk); its durations are summed.
+// Only one phase is active at a time, so the cost is one clock read per
+// transition.
+class PhaseTimer {
+public:
+  PhaseTimer();
+
+  // Ends the current phase, if any, and starts `phase`.
+  void Enter(RunPhase phase);
+  // Ends the current phase, if any, and the total.
+  void Stop();
+
+  double ElapsedMs(RunPhase phase) const;
+  double TotalMs() const;
+
+  // Value for a `Server-Timing` response header. Phases that were never
+  // entered are omitted.
+  std::string ServerTimingHeader() const;
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  std::array<clock::duration, RUN_PHASE_COUNT> durations;
+  std::array<bool, RUN_PHASE_COUNT> entered;
+  clock::time_point start_time;
+  clock::time_point phase_start_time;
+  clock::duration total;
+  RunPhase current_phase;
+  bool in_phase;
+  bool stopped;
+};
+
+} // namespace ui
+} // namespace duckdb
@@ -1,12 +1,51 @@
 #pragma once
 
 #include "duckdb.hpp"
+#include "duckdb/common/serializer/memory_stream.hpp"
 
+#include <functional>
 #include <string>
 
 namespace duckdb {
 namespace ui {
 
+// The body of a `/ddb/run` sent with `X-DuckDB-UI-Request-Encoding: binary`,
+// read with a BinaryDeserializer. Parameters keep their types, so they bind
+// like literals of the same type instead of as VARCHAR.
+struct RunRequest {
+  std::string sql;
+  duckdb::vector<duckdb::Value> parameters;
+
+  static RunRequest Deserialize(duckdb::Deserializer &deserializer);
+};
+
+// Reads a RunRequest from `content`. `context` resolves user types in
+// parameter values.
+RunRequest DeserializeRunRequest(duckdb::ClientContext &context,
+                                 const std::string &content);
+
+// One query of a `/ddb/batch`.
+struct BatchQuery {
+  // Empty to run on a new connection.
+  std::string connection_name;
+  std::string sql;
+  duckdb::vector<duckdb::Value> parameters;
+  // Rows of the result to return; all of them by default.
+  idx_t row_limit = duckdb::NumericLimits<idx_t>::Maximum();
+
+  static BatchQuery Deserialize(duckdb::Deserializer &deserializer);
+};
+
+// The body of a `/ddb/batch`, read with a BinaryDeserializer.
+struct BatchRequest {
+  duckdb::vector<BatchQuery> queries;
+
+  static BatchRequest Deserialize(duckdb::Deserializer &deserializer);
+};
+
+BatchRequest DeserializeBatchRequest(duckdb::ClientContext &context,
+                                     const std::string &content);
+
 struct EmptyResult {
   void Serialize(duckdb::Serializer &serializer) const;
 };
@@ -32,18 +71,109 @@ struct Chunk {
   void Serialize(duckdb::Serializer &serializer) const;
 };
 
+struct ColumnProfile {
+  idx_t null_count = 0;
+  idx_t distinct_count = 0;
+  bool has_min_max = false;
+  std::string min;
+  std::string max;
+  bool has_histogram = false;
+  double histogram_lower = 0;
+  double histogram_bucket_width = 0;
+  duckdb::vector<idx_t> histogram_counts;
+
+  void Serialize(duckdb::Serializer &serializer) const;
+};
+
+class ChunkSerializer;
+class SplitWriteStream;
+
 struct SuccessResult {
   ColumnNamesAndTypes column_names_and_types;
   duckdb::vector<Chunk> chunks;
+  // Only set in preview mode, for held results, and for windows of them.
+  duckdb::optional_idx total_row_count;
+  bool total_row_count_is_estimate = false;
+  // Only set if column profiles were requested.
+  duckdb::vector<ColumnProfile> column_profiles;
+  // Only set for runs with a result id. See ResultDiffCache.
+  duckdb::optional_idx result_version;
+  // If set, one per chunk: 0 if the chunk is sent, otherwise 1 + the index of
+  // the same chunk in the client's previous result, in which case only its
+  // row count is sent.
+  duckdb::vector<idx_t> chunk_references;
+  // Only set while serializing with ChunkSerializer::SerializeResult, in which
+  // case `chunks` is empty.
+  ChunkSerializer *chunk_serializer = nullptr;
 
   void Serialize(duckdb::Serializer &serializer) const;
 };
 
+// Serializes the chunks of a SuccessResult to `target` as they're fetched, so
+// they aren't all held in memory until the result is complete. Chunks are
+// held until a window of them is complete. Each chunk of the window is then
+// encoded with its own BinarySerializer, in parallel on DuckDB's task
+// scheduler, and copied as-is to `target`. This relies on BinarySerializer
+// writing straight through to its stream, and on a nested object being
+// encoded exactly like a top-level one.
+//
+// The rest of the result is serialized last, by SerializeResult, into the
+// bytes that go before and after the chunks.
+class ChunkSerializer {
+public:
+  // Called with each chunk, in order, before it's serialized. Returns 0 if
+  // the chunk is sent, otherwise its chunk reference (see SuccessResult), in
+  // which case only its row count is serialized.
+  using ReferenceFunction = std::function<idx_t(const Chunk &chunk)>;
+
+  ChunkSerializer(duckdb::ClientContext &context, duckdb::WriteStream &target);
+
+  void SetReferenceFunction(ReferenceFunction function);
+  // Takes the chunks, and writes them once their window is complete.
+  void Append(duckdb::vector<Chunk> &chunks);
+  // Writes every chunk still held.
+  void Flush();
+  // Flushes, then serializes the rest of `result` to `head` and `tail`, which
+  // go before and after the chunks.
+  void SerializeResult(SuccessResult &result, std::string &head,
+                       std::string &tail);
+  idx_t GetChunkCount() const { return chunk_count; }
+  // Called by SuccessResult::Serialize in place of writing chunk `index`,
+  // which was already written.
+  void SkipChunk(idx_t index);
+
+private:
+  duckdb::ClientContext &context;
+  duckdb::WriteStream &target;
+  idx_t window_size;
+  duckdb::vector<Chunk> chunks;
+  duckdb::vector<duckdb::unique_ptr<duckdb::MemoryStream>> buffers;
+  ReferenceFunction reference_function;
+  idx_t chunk_count;
+  // One per chunk written.
+  duckdb::vector<idx_t> chunk_references;
+  bool has_chunk_references;
+  // Only set in SerializeResult.
+  SplitWriteStream *result_stream;
+};
+
 struct ErrorResult {
   std::string error;
 
   void Serialize(duckdb::Serializer &serializer) const;
 };
 
+// One statement of a script run. `result` is a SuccessResult if `success`,
+// otherwise an ErrorResult.
+struct ScriptStatementResult {
+  idx_t statement_index = 0;
+  double elapsed_ms = 0;
+  bool success = false;
+  SuccessResult success_result;
+  ErrorResult error_result;
+
+  void Serialize(duckdb::Serializer &serializer) const;
+};
+
 } // namespace ui
 } // namespace duckdb
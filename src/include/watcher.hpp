@@ -11,6 +11,13 @@ namespace ui {
 struct CatalogState {
   std::map<idx_t, optional_idx> db_to_catalog_version;
 };
+// What the watcher remembers about one database instance.
+struct WatchedInstance {
+  CatalogState catalog_state;
+  bool is_md_connected = false;
+  // Whether the last poll of the instance failed.
+  bool has_error = false;
+};
 class HttpServer;
 class Watcher {
 public:
@@ -26,7 +33,8 @@ private:
   std::condition_variable cv;
   std::atomic<bool> should_run;
   HttpServer &server;
-  DatabaseInstance *watched_database;
+  // By instance id.
+  std::map<std::string, WatchedInstance> watched_instances;
 };
 } // namespace ui
 } // namespace duckdb
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <duckdb.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace duckdb {
+namespace ui {
+
+class HttpServer;
+class WebSocketConnection;
+class WebSocketWorkerPool;
+
+// Optional WebSocket transport for the UI API, on its own port (httplib has
+// no WebSocket support). A client connects to `/ddb/ws` with the same Origin
+// as the HTTP API, then sends requests and receives responses and events over
+// the one connection.
+//
+// Requests are text (or, for binary bodies, binary) messages:
+//
+//   <type> <request id>\n
+//   <header name>: <value>\n      (zero or more)
+//   \n
+//   <body>
+//
+// where `type` is `run`, `tokenize`, `interrupt`, `window` or `batch`, and the
+// headers are those of the HTTP endpoint of the same name.
+//
+// The server sends binary messages, each starting with the request id (a
+// little-endian uint32) and a kind byte:
+//  - 0: the next piece of the response body, which is the same as over HTTP;
+//  - 1: the end of the response, followed by the HTTP status (uint16);
+//  - 2: an event (request id 0), formatted as on `/localEvents`;
+//  - 3: events were dropped (request id 0), followed by how many (uint32).
+//
+// Responses of concurrent requests are interleaved piece by piece. Requests
+// run on a pool of threads shared by every connection, a few at a time per
+// connection; past a bounded queue, the server stops reading, so a client
+// can't queue unbounded work. Interrupts skip the queue. Responses are written
+// with blocking sends, so a client that reads slowly slows down the requests
+// producing them. Events are queued per connection, and its reader thread is
+// woken to send them right away. A client too far behind misses the oldest,
+// and is told how many it missed before the next event, so it can refresh
+// what the events keep up to date.
+//
+// The number of connections is capped, and a client must send the upgrade
+// request within a few seconds of connecting.
+class WebSocketServer {
+public:
+  WebSocketServer(HttpServer &server, std::string origin);
+  ~WebSocketServer();
+
+  // Binds to localhost:`port`, then accepts connections on a new thread.
+  void Start(uint16_t port);
+  // Closes every connection, waiting for requests in progress.
+  void Stop();
+
+private:
+  void Accept();
+  // Joins and forgets connections that were closed by their client.
+  void RemoveClosedConnections();
+
+  HttpServer &server;
+  std::string origin;
+  int listen_socket;
+  std::atomic<bool> should_run;
+  unique_ptr<std::thread> accept_thread;
+  std::mutex connections_mutex;
+  vector<shared_ptr<WebSocketConnection>> connections;
+  unique_ptr<WebSocketWorkerPool> pool;
+};
+
+} // namespace ui
+} // namespace duckdb
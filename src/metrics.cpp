@@ -0,0 +1,261 @@
+#include "metrics.hpp"
+
+#include <iomanip>
+
+namespace duckdb {
+namespace ui {
+
+constexpr double DURATION_BUCKET_BOUNDS[DURATION_BUCKET_COUNT] = {
+    0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+    0.1,    0.25,  0.5,    1,     2.5,  5,     10};
+
+static const char *RouteLabel(MetricsRoute route) {
+  switch (route) {
+  case MetricsRoute::RUN:
+    return "/ddb/run";
+  case MetricsRoute::TOKENIZE:
+    return "/ddb/tokenize";
+  case MetricsRoute::INTERRUPT:
+    return "/ddb/interrupt";
+  case MetricsRoute::LOCAL_EVENTS:
+    return "/localEvents";
+  case MetricsRoute::PROXIED_GET:
+    return "proxied_get";
+  case MetricsRoute::WINDOW:
+    return "/ddb/window";
+  case MetricsRoute::BATCH:
+    return "/ddb/batch";
+  case MetricsRoute::INGEST:
+    return "/ddb/ingest";
+  case MetricsRoute::EXPORT:
+    return "/ddb/export";
+  default:
+    return "other";
+  }
+}
+
+DurationHistogram::DurationHistogram() : count(0), sum_us(0) {
+  for (auto &bucket_count : bucket_counts) {
+    bucket_count.store(0, std::memory_order_relaxed);
+  }
+}
+
+void DurationHistogram::Record(std::chrono::steady_clock::duration duration) {
+  const auto us =
+      std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+  const double seconds = static_cast<double>(us) / 1e6;
+  idx_t bucket = 0;
+  while (bucket < DURATION_BUCKET_COUNT &&
+         seconds > DURATION_BUCKET_BOUNDS[bucket]) {
+    ++bucket;
+  }
+  bucket_counts[bucket].fetch_add(1, std::memory_order_relaxed);
+  count.fetch_add(1, std::memory_order_relaxed);
+  sum_us.fetch_add(static_cast<uint64_t>(us), std::memory_order_relaxed);
+}
+
+void DurationHistogram::Render(std::ostringstream &out,
+                               const std::string &name,
+                               const std::string &labels) const {
+  const auto prefix = labels.empty() ? std::string() : labels + ",";
+  // Prometheus buckets are cumulative.
+  uint64_t cumulative = 0;
+  for (idx_t i = 0; i < DURATION_BUCKET_COUNT; ++i) {
+    cumulative += bucket_counts[i].load(std::memory_order_relaxed);
+    out << name << "_bucket{" << prefix << "le=\""
+        << DURATION_BUCKET_BOUNDS[i] << "\"} " << cumulative << "\n";
+  }
+  cumulative +=
+      bucket_counts[DURATION_BUCKET_COUNT].load(std::memory_order_relaxed);
+  out << name << "_bucket{" << prefix << "le=\"+Inf\"} " << cumulative
+      << "\n";
+
+  const auto label_set = labels.empty() ? std::string() : "{" + labels + "}";
+  out << name << "_sum" << label_set << " " << std::fixed
+      << std::setprecision(6)
+      << static_cast<double>(sum_us.load(std::memory_order_relaxed)) / 1e6
+      << std::defaultfloat << "\n";
+  out << name << "_count" << label_set << " "
+      << count.load(std::memory_order_relaxed) << "\n";
+}
+
+ServerMetrics::ServerMetrics()
+    : rows_fetched(0), bytes_serialized(0), ingest_bytes(0), ingest_rows(0),
+      ingest_upload_us(0), ingest_load_us(0), export_bytes(0),
+      chunks_reused(0), catalog_events_raised(0), catalog_events_delivered(0),
+      active_event_streams(0) {}
+
+void ServerMetrics::RecordRequest(
+    MetricsRoute route, std::chrono::steady_clock::duration duration) {
+  request_durations[static_cast<idx_t>(route)].Record(duration);
+}
+
+void ServerMetrics::RecordRowsFetched(idx_t row_count) {
+  rows_fetched.fetch_add(row_count, std::memory_order_relaxed);
+}
+
+void ServerMetrics::RecordBytesSerialized(idx_t byte_count) {
+  bytes_serialized.fetch_add(byte_count, std::memory_order_relaxed);
+}
+
+void ServerMetrics::RecordIngest(
+    idx_t byte_count, idx_t row_count,
+    std::chrono::steady_clock::duration upload_duration,
+    std::chrono::steady_clock::duration load_duration) {
+  ingest_bytes.fetch_add(byte_count, std::memory_order_relaxed);
+  ingest_rows.fetch_add(row_count, std::memory_order_relaxed);
+  ingest_upload_us.fetch_add(
+      std::chrono::duration_cast<std::chrono::microseconds>(upload_duration)
+          .count(),
+      std::memory_order_relaxed);
+  ingest_load_us.fetch_add(
+      std::chrono::duration_cast<std::chrono::microseconds>(load_duration)
+          .count(),
+      std::memory_order_relaxed);
+}
+
+void ServerMetrics::RecordExportBytes(idx_t byte_count) {
+  export_bytes.fetch_add(byte_count, std::memory_order_relaxed);
+}
+
+void ServerMetrics::RecordChunksReused(idx_t chunk_count) {
+  chunks_reused.fetch_add(chunk_count, std::memory_order_relaxed);
+}
+
+void ServerMetrics::RecordWatcherPoll(
+    std::chrono::steady_clock::duration duration) {
+  watcher_poll_durations.Record(duration);
+}
+
+void ServerMetrics::RecordCatalogEventRaised() {
+  catalog_events_raised.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ServerMetrics::RecordCatalogEventDelivered() {
+  catalog_events_delivered.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ServerMetrics::EventStreamOpened() {
+  active_event_streams.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ServerMetrics::EventStreamClosed() {
+  active_event_streams.fetch_sub(1, std::memory_order_relaxed);
+}
+
+std::string
+ServerMetrics::Render(idx_t instance_count, idx_t named_connection_count,
+                      const StatementCacheStats &statement_cache_stats) const {
+  std::ostringstream out;
+
+  out << "# HELP ui_http_request_duration_seconds Time spent handling UI "
+         "server requests.\n";
+  out << "# TYPE ui_http_request_duration_seconds histogram\n";
+  for (idx_t i = 0; i < METRICS_ROUTE_COUNT; ++i) {
+    auto labels = StringUtil::Format(
+        "route=\"%s\"", RouteLabel(static_cast<MetricsRoute>(i)));
+    request_durations[i].Render(out, "ui_http_request_duration_seconds",
+                                labels);
+  }
+
+  out << "# HELP ui_rows_fetched_total Rows fetched from query results.\n";
+  out << "# TYPE ui_rows_fetched_total counter\n";
+  out << "ui_rows_fetched_total "
+      << rows_fetched.load(std::memory_order_relaxed) << "\n";
+
+  out << "# HELP ui_bytes_serialized_total Bytes of serialized response "
+         "content.\n";
+  out << "# TYPE ui_bytes_serialized_total counter\n";
+  out << "ui_bytes_serialized_total "
+      << bytes_serialized.load(std::memory_order_relaxed) << "\n";
+
+  out << "# HELP ui_result_chunks_reused_total Result chunks not sent "
+         "because the client already had them.\n";
+  out << "# TYPE ui_result_chunks_reused_total counter\n";
+  out << "ui_result_chunks_reused_total "
+      << chunks_reused.load(std::memory_order_relaxed) << "\n";
+
+  out << "# HELP ui_ingest_bytes_total Bytes of data uploaded to "
+         "/ddb/ingest.\n";
+  out << "# TYPE ui_ingest_bytes_total counter\n";
+  out << "ui_ingest_bytes_total "
+      << ingest_bytes.load(std::memory_order_relaxed) << "\n";
+
+  out << "# HELP ui_ingest_rows_total Rows loaded by /ddb/ingest.\n";
+  out << "# TYPE ui_ingest_rows_total counter\n";
+  out << "ui_ingest_rows_total " << ingest_rows.load(std::memory_order_relaxed)
+      << "\n";
+
+  // Throughput is ui_ingest_bytes_total over each of these.
+  out << "# HELP ui_ingest_upload_seconds_total Time spent receiving uploads "
+         "to /ddb/ingest.\n";
+  out << "# TYPE ui_ingest_upload_seconds_total counter\n";
+  out << "ui_ingest_upload_seconds_total " << std::fixed << std::setprecision(6)
+      << static_cast<double>(ingest_upload_us.load(std::memory_order_relaxed)) /
+             1e6
+      << std::defaultfloat << "\n";
+  out << "# HELP ui_ingest_load_seconds_total Time spent loading uploads "
+         "into tables.\n";
+  out << "# TYPE ui_ingest_load_seconds_total counter\n";
+  out << "ui_ingest_load_seconds_total " << std::fixed << std::setprecision(6)
+      << static_cast<double>(ingest_load_us.load(std::memory_order_relaxed)) /
+             1e6
+      << std::defaultfloat << "\n";
+
+  out << "# HELP ui_export_bytes_total Bytes of data sent by /ddb/export.\n";
+  out << "# TYPE ui_export_bytes_total counter\n";
+  out << "ui_export_bytes_total "
+      << export_bytes.load(std::memory_order_relaxed) << "\n";
+
+  out << "# HELP ui_active_event_streams Open server-sent event streams.\n";
+  out << "# TYPE ui_active_event_streams gauge\n";
+  out << "ui_active_event_streams "
+      << active_event_streams.load(std::memory_order_relaxed) << "\n";
+
+  out << "# HELP ui_catalog_events_raised_total Catalog changes found by "
+         "the watcher.\n";
+  out << "# TYPE ui_catalog_events_raised_total counter\n";
+  out << "ui_catalog_events_raised_total "
+      << catalog_events_raised.load(std::memory_order_relaxed) << "\n";
+  out << "# HELP ui_catalog_events_delivered_total Catalog change events "
+         "sent, after coalescing.\n";
+  out << "# TYPE ui_catalog_events_delivered_total counter\n";
+  out << "ui_catalog_events_delivered_total "
+      << catalog_events_delivered.load(std::memory_order_relaxed) << "\n";
+
+  out << "# HELP ui_database_instances Database instances served by the UI.\n";
+  out << "# TYPE ui_database_instances gauge\n";
+  out << "ui_database_instances " << instance_count << "\n";
+
+  out << "# HELP ui_named_connections Named connections held by the UI.\n";
+  out << "# TYPE ui_named_connections gauge\n";
+  out << "ui_named_connections " << named_connection_count << "\n";
+
+  out << "# HELP ui_statement_cache_hits_total Runs whose SQL was already "
+         "parsed.\n";
+  out << "# TYPE ui_statement_cache_hits_total counter\n";
+  out << "ui_statement_cache_hits_total " << statement_cache_stats.hits
+      << "\n";
+  out << "# HELP ui_statement_cache_misses_total Runs whose SQL had to be "
+         "parsed.\n";
+  out << "# TYPE ui_statement_cache_misses_total counter\n";
+  out << "ui_statement_cache_misses_total " << statement_cache_stats.misses
+      << "\n";
+  out << "# HELP ui_statement_cache_entries Parsed queries in the cache.\n";
+  out << "# TYPE ui_statement_cache_entries gauge\n";
+  out << "ui_statement_cache_entries " << statement_cache_stats.entries << "\n";
+  out << "# HELP ui_statement_cache_bytes Estimated memory of the parsed "
+         "queries in the cache.\n";
+  out << "# TYPE ui_statement_cache_bytes gauge\n";
+  out << "ui_statement_cache_bytes " << statement_cache_stats.bytes << "\n";
+
+  out << "# HELP ui_watcher_poll_duration_seconds Time spent polling the "
+         "catalog for changes.\n";
+  out << "# TYPE ui_watcher_poll_duration_seconds histogram\n";
+  watcher_poll_durations.Render(out, "ui_watcher_poll_duration_seconds", "");
+
+  return out.str();
+}
+
+} // namespace ui
+} // namespace duckdb
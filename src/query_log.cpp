@@ -0,0 +1,301 @@
+#include "query_log.hpp"
+
+#include "http_server.hpp"
+#include "state.hpp"
+#include "utils/helpers.hpp"
+
+#include <duckdb/main/appender.hpp>
+#include <duckdb/parser/keyword_helper.hpp>
+
+#include <iostream>
+
+namespace duckdb {
+namespace ui {
+
+// Time between periodic flushes of the query log table.
+constexpr std::chrono::milliseconds QUERY_LOG_FLUSH_INTERVAL(1000);
+
+// Queued records that trigger a flush before the next periodic one.
+constexpr idx_t QUERY_LOG_FLUSH_THRESHOLD = 256;
+
+// Schema of the default database holding the log table, so the log stays out
+// of the user's own schemas.
+constexpr const char *QUERY_LOG_SCHEMA = "_duckdb_ui";
+
+static void GetQueryLogColumns(vector<LogicalType> &types,
+                               vector<std::string> &names) {
+  names.emplace_back("start_time");
+  types.emplace_back(LogicalType::TIMESTAMP);
+  names.emplace_back("connection_name");
+  types.emplace_back(LogicalType::VARCHAR);
+  names.emplace_back("description");
+  types.emplace_back(LogicalType::VARCHAR);
+  names.emplace_back("sql_hash");
+  types.emplace_back(LogicalType::UBIGINT);
+  for (idx_t i = 0; i < RUN_PHASE_COUNT; ++i) {
+    names.emplace_back(
+        StringUtil::Format("%s_ms", RunPhaseName(static_cast<RunPhase>(i))));
+    types.emplace_back(LogicalType::DOUBLE);
+  }
+  names.emplace_back("total_ms");
+  types.emplace_back(LogicalType::DOUBLE);
+  names.emplace_back("row_count");
+  types.emplace_back(LogicalType::UBIGINT);
+  names.emplace_back("byte_count");
+  types.emplace_back(LogicalType::UBIGINT);
+  names.emplace_back("error");
+  types.emplace_back(LogicalType::VARCHAR);
+}
+
+static void SetRecordValues(DataChunk &output, idx_t row,
+                            const QueryLogRecord &record) {
+  idx_t col = 0;
+  output.SetValue(col++, row, Value::TIMESTAMP(record.start_time));
+  output.SetValue(col++, row, Value(record.connection_name));
+  output.SetValue(col++, row,
+                  record.description.empty() ? Value()
+                                             : Value(record.description));
+  output.SetValue(col++, row, Value::UBIGINT(record.sql_hash));
+  for (auto phase_ms : record.phase_ms) {
+    output.SetValue(col++, row, Value::DOUBLE(phase_ms));
+  }
+  output.SetValue(col++, row, Value::DOUBLE(record.total_ms));
+  output.SetValue(col++, row, Value::UBIGINT(record.row_count));
+  output.SetValue(col++, row, Value::UBIGINT(record.byte_count));
+  output.SetValue(col++, row,
+                  record.error.empty() ? Value() : Value(record.error));
+}
+
+void QueryLog::SetCapacity(idx_t new_capacity) {
+  std::lock_guard<std::mutex> guard(mutex);
+  if (new_capacity == capacity) {
+    return;
+  }
+
+  auto ordered = SnapshotInternal();
+  if (ordered.size() > new_capacity) {
+    ordered.erase(ordered.begin(),
+                  ordered.begin() + (ordered.size() - new_capacity));
+  }
+  records = std::move(ordered);
+  next = 0;
+  while (pending.size() > new_capacity) {
+    pending.pop_front();
+  }
+  capacity = new_capacity;
+}
+
+void QueryLog::SetTableName(const std::string &new_table_name) {
+  std::lock_guard<std::mutex> guard(mutex);
+  table_name = new_table_name;
+  if (table_name.empty()) {
+    pending.clear();
+  }
+}
+
+bool QueryLog::Append(QueryLogRecord record) {
+  std::lock_guard<std::mutex> guard(mutex);
+  if (capacity == 0) {
+    return false;
+  }
+
+  if (!table_name.empty()) {
+    // If the flush can't keep up, drop the oldest queued records rather than
+    // grow without bound.
+    if (pending.size() >= capacity) {
+      pending.pop_front();
+    }
+    pending.push_back(record);
+  }
+
+  if (records.size() < capacity) {
+    records.push_back(std::move(record));
+  } else {
+    records[next] = std::move(record);
+    next = (next + 1) % capacity;
+  }
+  return pending.size() >= MinValue<idx_t>(capacity, QUERY_LOG_FLUSH_THRESHOLD);
+}
+
+vector<QueryLogRecord> QueryLog::Snapshot() {
+  std::lock_guard<std::mutex> guard(mutex);
+  return SnapshotInternal();
+}
+
+vector<QueryLogRecord> QueryLog::SnapshotInternal() {
+  vector<QueryLogRecord> result;
+  result.reserve(records.size());
+  for (idx_t i = 0; i < records.size(); ++i) {
+    result.push_back(records[(next + i) % records.size()]);
+  }
+  return result;
+}
+
+void QueryLog::Flush(Connection &connection) {
+  std::string target_table;
+  std::deque<QueryLogRecord> to_flush;
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (table_name.empty() || pending.empty()) {
+      return;
+    }
+    target_table = table_name;
+    std::swap(to_flush, pending);
+  }
+
+  vector<LogicalType> types;
+  vector<std::string> names;
+  GetQueryLogColumns(types, names);
+
+  try {
+    vector<std::string> column_definitions;
+    for (idx_t i = 0; i < names.size(); ++i) {
+      column_definitions.push_back(
+          KeywordHelper::WriteOptionallyQuoted(names[i]) + " " +
+          types[i].ToString());
+    }
+    const std::string schema = QUERY_LOG_SCHEMA;
+    auto create_schema_result = connection.Query(
+        StringUtil::Format("CREATE SCHEMA IF NOT EXISTS %s",
+                           KeywordHelper::WriteOptionallyQuoted(schema)));
+    if (create_schema_result->HasError()) {
+      create_schema_result->ThrowError();
+    }
+    auto create_result = connection.Query(StringUtil::Format(
+        "CREATE TABLE IF NOT EXISTS %s.%s (%s)",
+        KeywordHelper::WriteOptionallyQuoted(schema),
+        KeywordHelper::WriteOptionallyQuoted(target_table),
+        StringUtil::Join(column_definitions, ", ")));
+    if (create_result->HasError()) {
+      create_result->ThrowError();
+    }
+
+    Appender appender(connection, AsCatalogIdentifier(schema),
+                      AsCatalogIdentifier(target_table));
+    DataChunk chunk;
+    chunk.Initialize(Allocator::DefaultAllocator(), types);
+    for (auto &record : to_flush) {
+      SetRecordValues(chunk, chunk.size(), record);
+      chunk.SetCardinality(chunk.size() + 1);
+      if (chunk.size() == STANDARD_VECTOR_SIZE) {
+        appender.AppendDataChunk(chunk);
+        chunk.Reset();
+      }
+    }
+    if (chunk.size() > 0) {
+      appender.AppendDataChunk(chunk);
+    }
+    appender.Close();
+  } catch (std::exception &ex) {
+    // The records are dropped; the in-memory log still has them.
+    ErrorData error(ex);
+    std::cerr << "Error flushing UI query log to '" << QUERY_LOG_SCHEMA << "."
+              << target_table << "': " << error.RawMessage() << std::endl;
+  }
+}
+
+QueryLogFlusher::QueryLogFlusher(HttpServer &server)
+    : server(server), should_run(false), flush_requested(false) {}
+
+void QueryLogFlusher::Start() {
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    should_run = true;
+  }
+  if (!thread) {
+    thread = make_uniq<std::thread>(&QueryLogFlusher::Run, this);
+  }
+}
+
+void QueryLogFlusher::Stop() {
+  if (!thread) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    should_run = false;
+  }
+  cv.notify_all();
+  thread->join();
+  thread.reset();
+}
+
+void QueryLogFlusher::Notify() {
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    flush_requested = true;
+  }
+  cv.notify_all();
+}
+
+void QueryLogFlusher::Run() {
+  while (true) {
+    bool stopping;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait_for(lock, QUERY_LOG_FLUSH_INTERVAL,
+                  [&] { return !should_run || flush_requested; });
+      flush_requested = false;
+      stopping = !should_run;
+    }
+    // Records logged before the server stopped are still written.
+    FlushAll();
+    if (stopping) {
+      return;
+    }
+  }
+}
+
+void QueryLogFlusher::FlushAll() {
+  for (auto &instance : server.LockDatabaseInstances()) {
+    try {
+      Connection connection(*instance.second);
+      UIStorageExtensionInfo::GetState(*instance.second)
+          .GetQueryLog()
+          .Flush(connection);
+    } catch (std::exception &ex) {
+      ErrorData error(ex);
+      std::cerr << "Error flushing UI query log: " << error.RawMessage()
+                << std::endl;
+    }
+  }
+}
+
+struct QueryLogFunctionState : GlobalTableFunctionState {
+  vector<QueryLogRecord> records;
+  idx_t offset = 0;
+};
+
+static unique_ptr<FunctionData> QueryLogBind(ClientContext &,
+                                             TableFunctionBindInput &,
+                                             vector<LogicalType> &out_types,
+                                             vector<std::string> &out_names) {
+  GetQueryLogColumns(out_types, out_names);
+  return nullptr;
+}
+
+static unique_ptr<GlobalTableFunctionState>
+QueryLogInit(ClientContext &context, TableFunctionInitInput &) {
+  auto state = make_uniq<QueryLogFunctionState>();
+  state->records =
+      UIStorageExtensionInfo::GetState(*context.db).GetQueryLog().Snapshot();
+  return std::move(state);
+}
+
+static void QueryLogFunc(ClientContext &, TableFunctionInput &input,
+                         DataChunk &output) {
+  auto &state = input.global_state->Cast<QueryLogFunctionState>();
+  idx_t row = 0;
+  while (state.offset < state.records.size() && row < STANDARD_VECTOR_SIZE) {
+    SetRecordValues(output, row++, state.records[state.offset++]);
+  }
+  output.SetCardinality(row);
+}
+
+TableFunction GetQueryLogFunction() {
+  return TableFunction("ui_query_log", {}, QueryLogFunc, QueryLogBind,
+                       QueryLogInit);
+}
+
+} // namespace ui
+} // namespace duckdb
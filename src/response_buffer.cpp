@@ -0,0 +1,152 @@
+#include "response_buffer.hpp"
+
+#include <duckdb/common/types/uuid.hpp>
+#include <duckdb/storage/buffer_manager.hpp>
+
+#include <iostream>
+
+namespace duckdb {
+namespace ui {
+
+ResponseBuffer::ResponseBuffer(shared_ptr<DatabaseInstance> _db,
+                               idx_t _memory_budget)
+    : db(std::move(_db)), memory_budget(_memory_budget), segment_offset(0),
+      size(0), file_size(0) {}
+
+ResponseBuffer::~ResponseBuffer() {
+  segments.clear();
+  if (!file_handle) {
+    return;
+  }
+  file_handle->Close();
+  file_handle.reset();
+  try {
+    FileSystem::GetFileSystem(*db).RemoveFile(file_path);
+  } catch (std::exception &ex) {
+    std::cerr << "Could not remove " << file_path << ": " << ex.what()
+              << std::endl;
+  }
+}
+
+void ResponseBuffer::WriteData(const_data_ptr_t buffer, idx_t write_size) {
+  while (write_size > 0) {
+    if (segments.empty() || segment_offset == SEGMENT_SIZE) {
+      NextSegment();
+    }
+    const auto to_copy = MinValue(write_size, SEGMENT_SIZE - segment_offset);
+    memcpy(segments.back().Ptr() + segment_offset, buffer, to_copy);
+    segment_offset += to_copy;
+    size += to_copy;
+    buffer += to_copy;
+    write_size -= to_copy;
+  }
+}
+
+void ResponseBuffer::Finish() {
+  if (file_handle && segment_offset > 0) {
+    file_handle->Write(segments.back().Ptr(), segment_offset, file_size);
+    file_size += segment_offset;
+    segment_offset = 0;
+  }
+}
+
+void ResponseBuffer::SetHeadAndTail(std::string new_head,
+                                    std::string new_tail) {
+  head = std::move(new_head);
+  tail = std::move(new_tail);
+}
+
+void ResponseBuffer::Read(idx_t offset, data_ptr_t target, idx_t length) {
+  D_ASSERT(offset + length <= GetSize());
+  if (offset < head.size()) {
+    const auto to_copy = MinValue<idx_t>(length, head.size() - offset);
+    memcpy(target, head.data() + offset, to_copy);
+    target += to_copy;
+    offset += to_copy;
+    length -= to_copy;
+  }
+  offset -= head.size();
+  if (length > 0 && offset < size) {
+    const auto to_copy = MinValue<idx_t>(length, size - offset);
+    ReadWritten(offset, target, to_copy);
+    target += to_copy;
+    offset += to_copy;
+    length -= to_copy;
+  }
+  if (length > 0) {
+    memcpy(target, tail.data() + (offset - size), length);
+  }
+}
+
+void ResponseBuffer::ReadWritten(idx_t offset, data_ptr_t target,
+                                 idx_t length) {
+  if (file_handle) {
+    file_handle->Read(target, length, offset);
+    return;
+  }
+  while (length > 0) {
+    const auto segment_index = offset / SEGMENT_SIZE;
+    const auto segment_start = offset % SEGMENT_SIZE;
+    const auto to_copy = MinValue(length, SEGMENT_SIZE - segment_start);
+    memcpy(target, segments[segment_index].Ptr() + segment_start, to_copy);
+    target += to_copy;
+    offset += to_copy;
+    length -= to_copy;
+  }
+}
+
+void ResponseBuffer::NextSegment() {
+  if (file_handle) {
+    // Reuse the only segment as the write buffer of the file.
+    Finish();
+    return;
+  }
+  const auto over_budget = (segments.size() + 1) * SEGMENT_SIZE > memory_budget;
+  if (!segments.empty() && over_budget && CanSpill()) {
+    Spill();
+    return;
+  }
+  try {
+    segments.push_back(BufferManager::GetBufferManager(*db).Allocate(
+        MemoryTag::EXTENSION, SEGMENT_SIZE, false));
+    segment_offset = 0;
+  } catch (OutOfMemoryException &) {
+    if (segments.empty() || !CanSpill()) {
+      throw;
+    }
+    Spill();
+  }
+}
+
+bool ResponseBuffer::CanSpill() {
+  return !BufferManager::GetBufferManager(*db).GetTemporaryDirectory().empty();
+}
+
+void ResponseBuffer::Spill() {
+  auto &fs = FileSystem::GetFileSystem(*db);
+  auto temp_directory =
+      BufferManager::GetBufferManager(*db).GetTemporaryDirectory();
+  if (!fs.DirectoryExists(temp_directory)) {
+    fs.CreateDirectory(temp_directory);
+  }
+  // Other processes may share the temp directory.
+  file_path = fs.JoinPath(
+      temp_directory,
+      StringUtil::Format("ui_response_%s.bin",
+                         UUID::ToString(UUID::GenerateRandomUUID())));
+  file_handle = fs.OpenFile(file_path,
+                            FileFlags::FILE_FLAGS_READ |
+                                FileFlags::FILE_FLAGS_WRITE |
+                                FileFlags::FILE_FLAGS_FILE_CREATE_NEW);
+
+  // Every segment is full at this point.
+  for (auto &segment : segments) {
+    file_handle->Write(segment.Ptr(), SEGMENT_SIZE, file_size);
+    file_size += SEGMENT_SIZE;
+  }
+  segments.resize(1);
+  segment_offset = 0;
+}
+
+} // namespace ui
+} // namespace duckdb
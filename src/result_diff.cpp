@@ -0,0 +1,157 @@
+#include "result_diff.hpp"
+
+#include <duckdb/common/types/hash.hpp>
+#include <duckdb/common/vector_operations/vector_operations.hpp>
+
+namespace duckdb {
+namespace ui {
+
+hash_t HashChunk(const Chunk &chunk) {
+  hash_t result = Hash(static_cast<uint64_t>(chunk.row_count));
+  if (chunk.row_count == 0 || chunk.vectors.empty()) {
+    return result;
+  }
+  Vector row_hashes(LogicalType::HASH, chunk.row_count);
+  for (idx_t i = 0; i < chunk.vectors.size(); ++i) {
+    // Hashing can flatten its input, so hash a reference.
+    Vector vector(chunk.vectors[i].GetType());
+    vector.Reference(chunk.vectors[i]);
+    if (i == 0) {
+      VectorOperations::Hash(vector, row_hashes, chunk.row_count);
+    } else {
+      VectorOperations::CombineHash(row_hashes, vector, chunk.row_count);
+    }
+    result = CombineHash(result, vector.GetType().Hash());
+  }
+  row_hashes.Flatten(chunk.row_count);
+  auto hashes = FlatVector::GetData<hash_t>(row_hashes);
+  // Unlike the row hashes, this depends on the order of the rows.
+  for (idx_t row = 0; row < chunk.row_count; ++row) {
+    result = CombineHash(result, hashes[row]);
+  }
+  return result;
+}
+
+template <class T, class BITS>
+static hash_t HashBits(Vector &vector, idx_t count) {
+  static_assert(sizeof(T) == sizeof(BITS), "BITS must be the size of T");
+  UnifiedVectorFormat format;
+  vector.ToUnifiedFormat(count, format);
+  auto values = UnifiedVectorFormat::GetData<T>(format);
+  hash_t result = 0;
+  for (idx_t i = 0; i < count; ++i) {
+    const auto index = format.sel->get_index(i);
+    if (!format.validity.RowIsValid(index)) {
+      continue;
+    }
+    BITS bits;
+    memcpy(&bits, &values[index], sizeof(bits));
+    result = CombineHash(result, Hash(bits));
+  }
+  return result;
+}
+
+static hash_t HashFloatBits(const Vector &input, idx_t count) {
+  const auto physical_type = input.GetType().InternalType();
+  if (physical_type != PhysicalType::FLOAT &&
+      physical_type != PhysicalType::DOUBLE &&
+      physical_type != PhysicalType::STRUCT &&
+      physical_type != PhysicalType::LIST &&
+      physical_type != PhysicalType::ARRAY) {
+    return 0;
+  }
+  // Flattening changes its input, so work on a reference.
+  Vector vector(input.GetType());
+  vector.Reference(input);
+  switch (physical_type) {
+  case PhysicalType::FLOAT:
+    return HashBits<float, uint32_t>(vector, count);
+  case PhysicalType::DOUBLE:
+    return HashBits<double, uint64_t>(vector, count);
+  case PhysicalType::STRUCT: {
+    vector.Flatten(count);
+    hash_t result = 0;
+    for (auto &child : StructVector::GetEntries(vector)) {
+      result = CombineHash(result, HashFloatBits(*child, count));
+    }
+    return result;
+  }
+  case PhysicalType::LIST:
+    // Which child entries belong to which row is covered by the value hash.
+    vector.Flatten(count);
+    return HashFloatBits(ListVector::GetEntry(vector),
+                         ListVector::GetListSize(vector));
+  default:
+    vector.Flatten(count);
+    return HashFloatBits(ArrayVector::GetEntry(vector),
+                         count * ArrayType::GetSize(vector.GetType()));
+  }
+}
+
+hash_t HashChunkFloatBits(const Chunk &chunk) {
+  hash_t result = 0;
+  for (auto &vector : chunk.vectors) {
+    result = CombineHash(result, HashFloatBits(vector, chunk.row_count));
+  }
+  return result;
+}
+
+idx_t ResultDiff::AddChunk(const Chunk &chunk) {
+  chunk_hashes.push_back(
+      ChunkHash{HashChunk(chunk), HashChunkFloatBits(chunk)});
+  // A chunk may have moved, e.g. when whole chunks were added before it.
+  auto entry = previous_indexes.find(chunk_hashes.back());
+  if (entry == previous_indexes.end()) {
+    return 0;
+  }
+  ++reference_count;
+  return entry->second + 1;
+}
+
+ResultDiff ResultDiffCache::Begin(const std::string &key,
+                                  optional_idx client_version) {
+  ResultDiff diff;
+  if (!client_version.IsValid()) {
+    return diff;
+  }
+  std::lock_guard<std::mutex> guard(mutex);
+  for (auto &entry : entries) {
+    if (entry.first != key) {
+      continue;
+    }
+    if (entry.second.version == client_version.GetIndex()) {
+      auto &previous_hashes = entry.second.chunk_hashes;
+      for (idx_t i = 0; i < previous_hashes.size(); ++i) {
+        diff.previous_indexes.emplace(previous_hashes[i], i);
+      }
+    }
+    break;
+  }
+  return diff;
+}
+
+uint64_t ResultDiffCache::Finish(const std::string &key, ResultDiff &diff) {
+  uint64_t version = Hash(static_cast<uint64_t>(diff.chunk_hashes.size()));
+  for (const auto &chunk_hash : diff.chunk_hashes) {
+    version = CombineHash(version, chunk_hash.values);
+    version = CombineHash(version, chunk_hash.float_bits);
+  }
+  // Fits in a JavaScript number.
+  version &= (uint64_t(1) << 53) - 1;
+
+  std::lock_guard<std::mutex> guard(mutex);
+  for (auto it = entries.begin(); it != entries.end(); ++it) {
+    if (it->first == key) {
+      entries.erase(it);
+      break;
+    }
+  }
+  entries.emplace_front(key, Entry{version, std::move(diff.chunk_hashes)});
+  if (entries.size() > MAX_ENTRIES) {
+    entries.pop_back();
+  }
+  return version;
+}
+
+} // namespace ui
+} // namespace duckdb
@@ -0,0 +1,184 @@
+#include "result_table_writer.hpp"
+
+#include <duckdb/main/appender.hpp>
+
+namespace duckdb {
+namespace ui {
+
+void ResultTableWriterPool::Start(idx_t thread_count) {
+  should_run = true;
+  for (idx_t i = 0; i < thread_count; ++i) {
+    threads.emplace_back(&ResultTableWriterPool::Work, this);
+  }
+}
+
+void ResultTableWriterPool::Stop() {
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    should_run = false;
+  }
+  cv.notify_all();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+}
+
+void ResultTableWriterPool::Schedule(ResultTableWriter &writer) {
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    ready.push_back(&writer);
+  }
+  cv.notify_one();
+}
+
+void ResultTableWriterPool::Work() {
+  while (true) {
+    ResultTableWriter *writer;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [&] { return !should_run || !ready.empty(); });
+      if (ready.empty()) {
+        return;
+      }
+      writer = ready.front();
+      ready.pop_front();
+    }
+    writer->Run();
+  }
+}
+
+ResultTableWriter::ResultTableWriter(
+    ResultTableWriterPool &pool, shared_ptr<Connection> _user_connection,
+    unique_ptr<Connection> _appender_connection,
+    unique_ptr<Appender> _appender, idx_t _row_limit,
+    CompletionCallback _on_complete)
+    : user_connection(std::move(_user_connection)),
+      appender_connection(std::move(_appender_connection)),
+      appender(std::move(_appender)), row_limit(_row_limit), rows_appended(0),
+      on_complete(std::move(_on_complete)), finished(false), done(false),
+      returned(false) {
+  pool.Schedule(*this);
+}
+
+ResultTableWriter::~ResultTableWriter() {
+  // Don't keep fetching if the request thread never handed over the result,
+  // e.g. because fetching threw.
+  Finish(nullptr);
+  Wait();
+}
+
+void ResultTableWriter::Append(DataChunk &chunk) {
+  // Reference rather than copy the vectors; the request thread only reads
+  // the chunk after this point.
+  auto chunk_ref = make_uniq<DataChunk>();
+  chunk_ref->InitializeEmpty(chunk.GetTypes());
+  chunk_ref->Reference(chunk);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  cv.wait(lock, [&] { return queue.size() < MAX_QUEUED_CHUNKS || done; });
+  if (done) {
+    return;
+  }
+  queue.push_back(std::move(chunk_ref));
+  cv.notify_all();
+}
+
+void ResultTableWriter::Finish(unique_ptr<QueryResult> result) {
+  std::lock_guard<std::mutex> guard(mutex);
+  if (finished) {
+    return;
+  }
+  remaining_result = std::move(result);
+  finished = true;
+  cv.notify_all();
+}
+
+void ResultTableWriter::Cancel() {
+  user_connection->Interrupt();
+  Finish(nullptr);
+}
+
+void ResultTableWriter::Wait() {
+  std::unique_lock<std::mutex> lock(mutex);
+  cv.wait(lock, [&] { return returned; });
+}
+
+bool ResultTableWriter::IsDone() {
+  std::lock_guard<std::mutex> guard(mutex);
+  return done;
+}
+
+void ResultTableWriter::AppendChunk(DataChunk &chunk) {
+  if (rows_appended >= row_limit) {
+    return;
+  }
+  const idx_t rows_left = row_limit - rows_appended;
+  if (chunk.size() > rows_left) {
+    chunk.Slice(0, rows_left);
+  }
+  appender->AppendDataChunk(chunk);
+  rows_appended += chunk.size();
+}
+
+void ResultTableWriter::Run() {
+  std::string error;
+  try {
+    // Append the chunks queued by the request thread.
+    while (true) {
+      unique_ptr<DataChunk> chunk;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return !queue.empty() || finished; });
+        if (queue.empty()) {
+          break;
+        }
+        chunk = std::move(queue.front());
+        queue.pop_front();
+        cv.notify_all();
+      }
+      AppendChunk(*chunk);
+    }
+
+    // Then fetch and append the rest of the result ourselves.
+    unique_ptr<QueryResult> result;
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      result = std::move(remaining_result);
+    }
+    while (result && rows_appended < row_limit) {
+      auto chunk = result->Fetch();
+      if (!chunk) {
+        break;
+      }
+      AppendChunk(*chunk);
+    }
+    if (result && result->HasError()) {
+      error = result->GetError();
+    }
+
+    appender->Close();
+  } catch (std::exception &ex) {
+    ErrorData error_data(ex);
+    error = error_data.RawMessage();
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    done = true;
+    queue.clear();
+    cv.notify_all();
+  }
+
+  if (on_complete) {
+    on_complete(rows_appended, error);
+  }
+
+  // The writer may be destroyed as soon as the lock is released.
+  std::lock_guard<std::mutex> guard(mutex);
+  returned = true;
+  cv.notify_all();
+}
+
+} // namespace ui
+} // namespace duckdb
@@ -3,6 +3,7 @@
 #include "utils/helpers.hpp"
 
 #include <duckdb.hpp>
+#include <duckdb/common/file_system.hpp>
 #if DUCKDB_VERSION_AT_LEAST(1, 5, 0)
 #include <duckdb/main/settings.hpp>
 #endif
@@ -28,4 +29,67 @@ uint32_t GetPollingInterval(const ClientContext &context) {
   return internal::GetSetting<uint32_t>(context,
                                         UI_POLLING_INTERVAL_SETTING_NAME);
 }
+
+uint32_t GetCatalogEventDebounce(const ClientContext &context) {
+  return internal::GetSetting<uint32_t>(
+      context, UI_CATALOG_EVENT_DEBOUNCE_SETTING_NAME);
+}
+
+uint32_t GetCatalogEventMaxDelay(const ClientContext &context) {
+  return internal::GetSetting<uint32_t>(
+      context, UI_CATALOG_EVENT_MAX_DELAY_SETTING_NAME);
+}
+
+std::string GetSocketPath(const ClientContext &context) {
+  auto path =
+      internal::GetSetting<std::string>(context, UI_SOCKET_PATH_SETTING_NAME);
+  if (path.empty()) {
+    return path;
+  }
+  auto &fs = FileSystem::GetFileSystem(*context.db);
+  path = fs.ExpandPath(path);
+  if (fs.IsPathAbsolute(path)) {
+    return path;
+  }
+  return fs.JoinPath(fs.ExpandPath("~/.duckdb/extension_data/ui"), path);
+}
+
+uint16_t GetWebSocketPort(const ClientContext &context) {
+  return internal::GetSetting<uint16_t>(context,
+                                        UI_WEBSOCKET_PORT_SETTING_NAME);
+}
+
+bool GetDirectResultTables(const ClientContext &context) {
+  return internal::GetSetting<bool>(context,
+                                    UI_DIRECT_RESULT_TABLES_SETTING_NAME);
+}
+
+bool GetPushRowLimits(const ClientContext &context) {
+  return internal::GetSetting<bool>(context, UI_PUSH_ROW_LIMITS_SETTING_NAME);
+}
+
+uint32_t GetResultBatchRows(const ClientContext &context) {
+  return internal::GetSetting<uint32_t>(context,
+                                        UI_RESULT_BATCH_ROWS_SETTING_NAME);
+}
+
+uint64_t GetResultBatchBytes(const ClientContext &context) {
+  return internal::GetSetting<uint64_t>(context,
+                                        UI_RESULT_BATCH_BYTES_SETTING_NAME);
+}
+
+uint64_t GetResponseMemoryBudget(const ClientContext &context) {
+  return internal::GetSetting<uint64_t>(
+      context, UI_RESPONSE_MEMORY_BUDGET_SETTING_NAME);
+}
+
+uint64_t GetMaxIngestBytes(const ClientContext &context) {
+  return internal::GetSetting<uint64_t>(context,
+                                        UI_MAX_INGEST_BYTES_SETTING_NAME);
+}
+
+uint64_t GetMaxExportBytes(const ClientContext &context) {
+  return internal::GetSetting<uint64_t>(context,
+                                        UI_MAX_EXPORT_BYTES_SETTING_NAME);
+}
 } // namespace duckdb
@@ -4,8 +4,15 @@
 
 #include <duckdb/main/database.hpp>
 
+#include <atomic>
+
 namespace duckdb {
 
+static std::atomic<idx_t> next_instance_id{1};
+
+UIStorageExtensionInfo::UIStorageExtensionInfo()
+    : instance_id(std::to_string(next_instance_id.fetch_add(1))) {}
+
 UIStorageExtensionInfo &
 UIStorageExtensionInfo::GetState(const DatabaseInstance &instance) {
   auto &config = instance.config;
@@ -66,4 +73,34 @@ shared_ptr<Connection> UIStorageExtensionInfo::FindOrCreateConnection(
   return new_con;
 }
 
+idx_t UIStorageExtensionInfo::GetConnectionCount() {
+  std::lock_guard<std::mutex> guard(connections_mutex);
+  return connections.size();
+}
+
+void UIStorageExtensionInfo::SetHeldResult(
+    const std::string &connection_name,
+    shared_ptr<ui::HeldResult> held_result) {
+  if (connection_name.empty()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(connections_mutex);
+  if (held_result) {
+    held_results[connection_name] = std::move(held_result);
+  } else {
+    held_results.erase(connection_name);
+  }
+}
+
+shared_ptr<ui::HeldResult>
+UIStorageExtensionInfo::FindHeldResult(const std::string &connection_name) {
+  std::lock_guard<std::mutex> guard(connections_mutex);
+  auto result = held_results.find(connection_name);
+  if (result != held_results.end()) {
+    return result->second;
+  }
+  return nullptr;
+}
+
 } // namespace duckdb
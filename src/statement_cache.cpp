@@ -0,0 +1,127 @@
+#include "statement_cache.hpp"
+
+#include <duckdb/common/types/hash.hpp>
+#include <duckdb/main/client_context.hpp>
+#include <duckdb/parser/parser.hpp>
+
+namespace duckdb {
+namespace ui {
+
+void StatementCache::SetCapacity(idx_t new_capacity) {
+  std::lock_guard<std::mutex> guard(mutex);
+  capacity = new_capacity;
+  Evict();
+}
+
+void StatementCache::SetMaxBytes(idx_t new_max_bytes) {
+  std::lock_guard<std::mutex> guard(mutex);
+  max_bytes = new_max_bytes;
+  Evict();
+}
+
+void StatementCache::Evict() {
+  while (!entries.empty() &&
+         (entries.size() > capacity || bytes > max_bytes)) {
+    bytes -= entries.back().second.bytes;
+    index.erase(entries.back().first);
+    entries.pop_back();
+  }
+}
+
+vector<unique_ptr<SQLStatement>>
+StatementCache::ExtractStatements(Connection &connection,
+                                  const std::string &sql) {
+  if (capacity == 0) {
+    return connection.ExtractStatements(sql);
+  }
+
+  const auto options = connection.context->GetParserOptions();
+  const auto hash = Hash(sql.c_str(), sql.size());
+  auto cached = TryGet(hash, sql, options);
+  if (cached) {
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return CopyStatements(*cached);
+  }
+  misses.fetch_add(1, std::memory_order_relaxed);
+
+  // ExtractStatements also replaces PRAGMA statements with the queries they
+  // expand to, which can depend on the state of the database. So we parse
+  // without expanding, and only cache the result if there was nothing to
+  // expand.
+  Parser parser(options);
+  parser.ParseQuery(sql);
+  for (auto &statement : parser.statements) {
+    if (statement->type == StatementType::PRAGMA_STATEMENT) {
+      return connection.ExtractStatements(sql);
+    }
+  }
+
+  Entry entry;
+  entry.sql = sql;
+  entry.preserve_identifier_case = options.preserve_identifier_case;
+  entry.integer_division = options.integer_division;
+  entry.bytes = sql.size() * ENTRY_BYTES_PER_SQL_BYTE;
+  entry.statements = make_shared_ptr<vector<unique_ptr<SQLStatement>>>(
+      CopyStatements(parser.statements));
+  Put(hash, std::move(entry));
+  return std::move(parser.statements);
+}
+
+StatementCacheStats StatementCache::GetStats() {
+  StatementCacheStats stats;
+  stats.hits = hits.load(std::memory_order_relaxed);
+  stats.misses = misses.load(std::memory_order_relaxed);
+  std::lock_guard<std::mutex> guard(mutex);
+  stats.entries = entries.size();
+  stats.bytes = bytes;
+  return stats;
+}
+
+vector<unique_ptr<SQLStatement>> StatementCache::CopyStatements(
+    const vector<unique_ptr<SQLStatement>> &statements) {
+  vector<unique_ptr<SQLStatement>> copies;
+  copies.reserve(statements.size());
+  for (auto &statement : statements) {
+    copies.push_back(statement->Copy());
+  }
+  return copies;
+}
+
+shared_ptr<const vector<unique_ptr<SQLStatement>>>
+StatementCache::TryGet(hash_t hash, const std::string &sql,
+                       const ParserOptions &options) {
+  std::lock_guard<std::mutex> guard(mutex);
+  auto it = index.find(hash);
+  if (it == index.end()) {
+    return nullptr;
+  }
+  auto &entry = it->second->second;
+  // Guard against hash collisions and changed parser settings.
+  if (entry.sql != sql ||
+      entry.preserve_identifier_case != options.preserve_identifier_case ||
+      entry.integer_division != options.integer_division) {
+    return nullptr;
+  }
+  entries.splice(entries.begin(), entries, it->second);
+  return entry.statements;
+}
+
+void StatementCache::Put(hash_t hash, Entry entry) {
+  std::lock_guard<std::mutex> guard(mutex);
+  if (capacity == 0 || entry.bytes > max_bytes) {
+    return;
+  }
+  auto it = index.find(hash);
+  if (it != index.end()) {
+    bytes -= it->second->second.bytes;
+    entries.erase(it->second);
+    index.erase(it);
+  }
+  bytes += entry.bytes;
+  entries.emplace_front(hash, std::move(entry));
+  index[hash] = entries.begin();
+  Evict();
+}
+
+} // namespace ui
+} // namespace duckdb
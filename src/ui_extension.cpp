@@ -4,6 +4,7 @@
 #include <duckdb/common/string_util.hpp>
 
 #include "http_server.hpp"
+#include "query_log.hpp"
 #include "settings.hpp"
 #include "state.hpp"
 #include "ui_extension.hpp"
@@ -47,6 +48,10 @@ std::string StartUIServerFunction(ClientContext &context) {
   bool was_started = false;
   const auto &server = ui::HttpServer::Start(context, &was_started);
   const char *already = was_started ? "already " : "";
+  if (!server.LocalSocketPath().empty()) {
+    return StringUtil::Format("UI server %sstarted at %s and %s", already,
+                              server.LocalUrl(), server.LocalSocketPath());
+  }
   return StringUtil::Format("UI server %sstarted at %s", already,
                             server.LocalUrl());
 }
@@ -65,6 +70,13 @@ std::string GetUIURLFunction(ClientContext &context) {
   return server->LocalUrl();
 }
 
+std::string GetUIInstanceIdFunction(ClientContext &context) {
+  // Requests with this id in their `X-DuckDB-UI-Instance` header are run on
+  // this database instance.
+  ui::HttpServer::AddDatabaseInstanceIfRunning(context.db);
+  return UIStorageExtensionInfo::GetState(*context.db).GetInstanceId();
+}
+
 void IsUIStartedTableFunc(ClientContext &context, TableFunctionInput &input,
                           DataChunk &output) {
   if (!internal::ShouldRun(input)) {
@@ -75,6 +87,32 @@ void IsUIStartedTableFunc(ClientContext &context, TableFunctionInput &input,
   output.SetValue(0, 0, ui::HttpServer::Started());
 }
 
+void SetQueryLogSize(ClientContext &context, SetScope, Value &parameter) {
+  UIStorageExtensionInfo::GetState(*context.db)
+      .GetQueryLog()
+      .SetCapacity(parameter.GetValue<uint32_t>());
+}
+
+void SetQueryLogTable(ClientContext &context, SetScope, Value &parameter) {
+  UIStorageExtensionInfo::GetState(*context.db)
+      .GetQueryLog()
+      .SetTableName(parameter.IsNull() ? "" : parameter.ToString());
+}
+
+void SetStatementCacheSize(ClientContext &context, SetScope,
+                           Value &parameter) {
+  UIStorageExtensionInfo::GetState(*context.db)
+      .GetStatementCache()
+      .SetCapacity(parameter.GetValue<uint32_t>());
+}
+
+void SetStatementCacheBytes(ClientContext &context, SetScope,
+                            Value &parameter) {
+  UIStorageExtensionInfo::GetState(*context.db)
+      .GetStatementCache()
+      .SetMaxBytes(parameter.GetValue<uint64_t>());
+}
+
 void InitStorageExtension(duckdb::DatabaseInstance &db) {
   auto &config = db.config;
 
@@ -133,10 +171,135 @@ static void LoadInternal(DatabaseInstance &instance) {
         LogicalType::UINTEGER, Value::UINTEGER(def));
   }
 
+  {
+    auto def = GetEnvOrDefaultInt(UI_CATALOG_EVENT_DEBOUNCE_SETTING_NAME,
+                                  UI_CATALOG_EVENT_DEBOUNCE_SETTING_DEFAULT);
+    config.AddExtensionOption(
+        UI_CATALOG_EVENT_DEBOUNCE_SETTING_NAME,
+        "Quiet period (in ms) after which held back catalog change events "
+        "are sent to the UI (0 to send every change)",
+        LogicalType::UINTEGER, Value::UINTEGER(def));
+  }
+
+  {
+    auto def = GetEnvOrDefaultInt(UI_CATALOG_EVENT_MAX_DELAY_SETTING_NAME,
+                                  UI_CATALOG_EVENT_MAX_DELAY_SETTING_DEFAULT);
+    config.AddExtensionOption(
+        UI_CATALOG_EVENT_MAX_DELAY_SETTING_NAME,
+        "Longest time (in ms) a catalog change event is held back",
+        LogicalType::UINTEGER, Value::UINTEGER(def));
+  }
+
+  {
+    auto def = GetEnvOrDefault(UI_SOCKET_PATH_SETTING_NAME,
+                               UI_SOCKET_PATH_SETTING_DEFAULT);
+    config.AddExtensionOption(
+        UI_SOCKET_PATH_SETTING_NAME,
+        "Unix domain socket on which the UI server also listens (empty to "
+        "disable); relative to ~/.duckdb/extension_data/ui",
+        LogicalType::VARCHAR, Value(def));
+  }
+
+  {
+    auto def = GetEnvOrDefaultInt(UI_WEBSOCKET_PORT_SETTING_NAME,
+                                  UI_WEBSOCKET_PORT_SETTING_DEFAULT);
+    config.AddExtensionOption(
+        UI_WEBSOCKET_PORT_SETTING_NAME,
+        "Local port on which the UI server accepts WebSocket connections (0 "
+        "to disable)",
+        LogicalType::USMALLINT, Value::USMALLINT(def));
+  }
+
+  {
+    auto def = GetEnvOrDefaultInt(UI_QUERY_LOG_SIZE_SETTING_NAME,
+                                  UI_QUERY_LOG_SIZE_SETTING_DEFAULT);
+    config.AddExtensionOption(
+        UI_QUERY_LOG_SIZE_SETTING_NAME,
+        "Number of recent UI queries kept for ui_query_log() (0 to disable)",
+        LogicalType::UINTEGER, Value::UINTEGER(def), SetQueryLogSize);
+    UIStorageExtensionInfo::GetState(instance).GetQueryLog().SetCapacity(def);
+  }
+
+  {
+    auto def = GetEnvOrDefault(UI_QUERY_LOG_TABLE_SETTING_NAME,
+                               UI_QUERY_LOG_TABLE_SETTING_DEFAULT);
+    config.AddExtensionOption(
+        UI_QUERY_LOG_TABLE_SETTING_NAME,
+        "Table in the _duckdb_ui schema to which the UI query log is flushed "
+        "(empty to disable)",
+        LogicalType::VARCHAR, Value(def), SetQueryLogTable);
+    UIStorageExtensionInfo::GetState(instance).GetQueryLog().SetTableName(def);
+  }
+
+  {
+    auto def = GetEnvOrDefaultInt(UI_STATEMENT_CACHE_SIZE_SETTING_NAME,
+                                  UI_STATEMENT_CACHE_SIZE_SETTING_DEFAULT);
+    config.AddExtensionOption(
+        UI_STATEMENT_CACHE_SIZE_SETTING_NAME,
+        "Number of parsed UI queries kept for reuse (0 to disable)",
+        LogicalType::UINTEGER, Value::UINTEGER(def), SetStatementCacheSize);
+    UIStorageExtensionInfo::GetState(instance).GetStatementCache().SetCapacity(
+        def);
+  }
+
+  {
+    auto def = GetEnvOrDefaultInt(UI_STATEMENT_CACHE_BYTES_SETTING_NAME,
+                                  UI_STATEMENT_CACHE_BYTES_SETTING_DEFAULT);
+    config.AddExtensionOption(
+        UI_STATEMENT_CACHE_BYTES_SETTING_NAME,
+        "Estimated memory (in bytes) of the parsed UI queries kept for reuse",
+        LogicalType::UBIGINT, Value::UBIGINT(def), SetStatementCacheBytes);
+    UIStorageExtensionInfo::GetState(instance).GetStatementCache().SetMaxBytes(
+        def);
+  }
+
+  config.AddExtensionOption(
+      UI_DIRECT_RESULT_TABLES_SETTING_NAME,
+      "Create result tables without a row limit with CREATE TABLE AS",
+      LogicalType::BOOLEAN,
+      Value::BOOLEAN(UI_DIRECT_RESULT_TABLES_SETTING_DEFAULT));
+
+  config.AddExtensionOption(
+      UI_PUSH_ROW_LIMITS_SETTING_NAME,
+      "Apply the result row limit of UI queries as a LIMIT in their plan",
+      LogicalType::BOOLEAN, Value::BOOLEAN(UI_PUSH_ROW_LIMITS_SETTING_DEFAULT));
+
+  config.AddExtensionOption(
+      UI_RESULT_BATCH_ROWS_SETTING_NAME,
+      "Target number of rows per chunk of a UI query result",
+      LogicalType::UINTEGER,
+      Value::UINTEGER(UI_RESULT_BATCH_ROWS_SETTING_DEFAULT));
+
+  config.AddExtensionOption(
+      UI_RESULT_BATCH_BYTES_SETTING_NAME,
+      "Target size (in bytes) of a chunk of a UI query result (0 for no limit)",
+      LogicalType::UBIGINT,
+      Value::UBIGINT(UI_RESULT_BATCH_BYTES_SETTING_DEFAULT));
+
+  config.AddExtensionOption(
+      UI_RESPONSE_MEMORY_BUDGET_SETTING_NAME,
+      "Bytes of a UI query response held in memory before it is written to "
+      "a temporary file",
+      LogicalType::UBIGINT,
+      Value::UBIGINT(UI_RESPONSE_MEMORY_BUDGET_SETTING_DEFAULT));
+
+  config.AddExtensionOption(
+      UI_MAX_INGEST_BYTES_SETTING_NAME,
+      "Largest upload (in bytes) accepted by the UI's ingest endpoint",
+      LogicalType::UBIGINT,
+      Value::UBIGINT(UI_MAX_INGEST_BYTES_SETTING_DEFAULT));
+
+  config.AddExtensionOption(
+      UI_MAX_EXPORT_BYTES_SETTING_NAME,
+      "Largest file (in bytes) written by the UI's export endpoint",
+      LogicalType::UBIGINT,
+      Value::UBIGINT(UI_MAX_EXPORT_BYTES_SETTING_DEFAULT));
+
   REGISTER_TF("start_ui", StartUIFunction);
   REGISTER_TF("start_ui_server", StartUIServerFunction);
   REGISTER_TF("stop_ui_server", StopUIServerFunction);
   REGISTER_TF("get_ui_url", GetUIURLFunction);
+  REGISTER_TF("ui_instance_id", GetUIInstanceIdFunction);
   {
     TableFunction tf("ui_is_started", {}, IsUIStartedTableFunc,
                      internal::SingleBoolResultBind,
@@ -145,6 +308,14 @@ static void LoadInternal(DatabaseInstance &instance) {
     loader.RegisterFunction(tf);
 #else
     ExtensionUtil::RegisterFunction(instance, tf);
+#endif
+  }
+  {
+    auto tf = ui::GetQueryLogFunction();
+#ifdef DUCKDB_CPP_EXTENSION_ENTRY
+    loader.RegisterFunction(tf);
+#else
+    ExtensionUtil::RegisterFunction(instance, tf);
 #endif
   }
 }
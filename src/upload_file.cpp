@@ -0,0 +1,73 @@
+#include "upload_file.hpp"
+
+#include <duckdb/common/types/uuid.hpp>
+#include <duckdb/storage/buffer_manager.hpp>
+
+#include <iostream>
+
+namespace duckdb {
+namespace ui {
+
+UploadFile::UploadFile(shared_ptr<DatabaseInstance> _db,
+                       const std::string &extension)
+    : db(std::move(_db)), buffer_offset(0), size(0) {
+  auto &buffer_manager = BufferManager::GetBufferManager(*db);
+  auto temp_directory = buffer_manager.GetTemporaryDirectory();
+  if (temp_directory.empty()) {
+    throw InvalidInputException(
+        "Uploads need a temp directory (SET temp_directory)");
+  }
+  buffer = buffer_manager.Allocate(MemoryTag::EXTENSION, BUFFER_SIZE, false);
+
+  auto &fs = FileSystem::GetFileSystem(*db);
+  if (!fs.DirectoryExists(temp_directory)) {
+    fs.CreateDirectory(temp_directory);
+  }
+  // Unique across processes sharing the temp directory.
+  file_path = fs.JoinPath(
+      temp_directory,
+      StringUtil::Format("ui_upload_%s%s",
+                         UUID::ToString(UUID::GenerateRandomUUID()),
+                         extension));
+  file_handle = fs.OpenFile(file_path,
+                            FileFlags::FILE_FLAGS_WRITE |
+                                FileFlags::FILE_FLAGS_FILE_CREATE_NEW);
+}
+
+UploadFile::~UploadFile() {
+  if (!file_handle) {
+    return;
+  }
+  file_handle->Close();
+  file_handle.reset();
+  try {
+    FileSystem::GetFileSystem(*db).RemoveFile(file_path);
+  } catch (std::exception &ex) {
+    std::cerr << "Could not remove " << file_path << ": " << ex.what()
+              << std::endl;
+  }
+}
+
+void UploadFile::Write(const char *data, idx_t write_size) {
+  while (write_size > 0) {
+    if (buffer_offset == BUFFER_SIZE) {
+      Finish();
+    }
+    const auto to_copy = MinValue(write_size, BUFFER_SIZE - buffer_offset);
+    memcpy(buffer.Ptr() + buffer_offset, data, to_copy);
+    buffer_offset += to_copy;
+    size += to_copy;
+    data += to_copy;
+    write_size -= to_copy;
+  }
+}
+
+void UploadFile::Finish() {
+  if (buffer_offset > 0) {
+    file_handle->Write(buffer.Ptr(), buffer_offset, size - buffer_offset);
+    buffer_offset = 0;
+  }
+}
+
+} // namespace ui
+} // namespace duckdb
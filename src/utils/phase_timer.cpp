@@ -0,0 +1,87 @@
+#include "utils/phase_timer.hpp"
+
+namespace duckdb {
+namespace ui {
+
+const char *RunPhaseName(RunPhase phase) {
+  switch (phase) {
+  case RunPhase::DECODE:
+    return "decode";
+  case RunPhase::PARSE:
+    return "parse";
+  case RunPhase::PREPARE:
+    return "prepare";
+  case RunPhase::EXECUTE:
+    return "execute";
+  case RunPhase::FETCH:
+    return "fetch";
+  case RunPhase::APPEND:
+    return "append";
+  case RunPhase::PROFILE:
+    return "profile";
+  case RunPhase::SERIALIZE:
+    return "serialize";
+  default:
+    return "unknown";
+  }
+}
+
+static double ToMs(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+PhaseTimer::PhaseTimer()
+    : start_time(clock::now()), total(clock::duration::zero()),
+      current_phase(RunPhase::DECODE), in_phase(false), stopped(false) {
+  durations.fill(clock::duration::zero());
+  entered.fill(false);
+}
+
+void PhaseTimer::Enter(RunPhase phase) {
+  const auto now = clock::now();
+  if (in_phase) {
+    durations[static_cast<idx_t>(current_phase)] += now - phase_start_time;
+  }
+  current_phase = phase;
+  phase_start_time = now;
+  entered[static_cast<idx_t>(phase)] = true;
+  in_phase = true;
+}
+
+void PhaseTimer::Stop() {
+  if (stopped) {
+    return;
+  }
+  const auto now = clock::now();
+  if (in_phase) {
+    durations[static_cast<idx_t>(current_phase)] += now - phase_start_time;
+    in_phase = false;
+  }
+  total = now - start_time;
+  stopped = true;
+}
+
+double PhaseTimer::ElapsedMs(RunPhase phase) const {
+  return ToMs(durations[static_cast<idx_t>(phase)]);
+}
+
+double PhaseTimer::TotalMs() const {
+  return ToMs(stopped ? total : clock::now() - start_time);
+}
+
+std::string PhaseTimer::ServerTimingHeader() const {
+  std::string header;
+  for (idx_t i = 0; i < RUN_PHASE_COUNT; ++i) {
+    if (!entered[i]) {
+      continue;
+    }
+    header += StringUtil::Format("%s;dur=%.3f, ",
+                                 RunPhaseName(static_cast<RunPhase>(i)),
+                                 ToMs(durations[i]));
+  }
+  header += StringUtil::Format("total;dur=%.3f", TotalMs());
+  return header;
+}
+
+} // namespace ui
+} // namespace duckdb
@@ -1,11 +1,66 @@
 #include "utils/serialization.hpp"
 
+#include "duckdb/common/serializer/binary_deserializer.hpp"
+#include "duckdb/common/serializer/binary_serializer.hpp"
 #include "duckdb/common/serializer/deserializer.hpp"
+#include "duckdb/common/serializer/memory_stream.hpp"
 #include "duckdb/common/serializer/serializer.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/parallel/task_executor.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
 
 namespace duckdb {
 namespace ui {
 
+RunRequest RunRequest::Deserialize(Deserializer &deserializer) {
+  RunRequest request;
+  deserializer.ReadProperty(100, "sql", request.sql);
+  deserializer.ReadPropertyWithDefault(101, "parameters", request.parameters);
+  return request;
+}
+
+BatchQuery BatchQuery::Deserialize(Deserializer &deserializer) {
+  BatchQuery query;
+  deserializer.ReadPropertyWithDefault(100, "connection_name",
+                                       query.connection_name);
+  deserializer.ReadProperty(101, "sql", query.sql);
+  deserializer.ReadPropertyWithDefault(102, "parameters", query.parameters);
+  deserializer.ReadPropertyWithExplicitDefault<idx_t>(
+      103, "row_limit", query.row_limit, NumericLimits<idx_t>::Maximum());
+  return query;
+}
+
+BatchRequest BatchRequest::Deserialize(Deserializer &deserializer) {
+  BatchRequest request;
+  deserializer.ReadPropertyWithDefault(100, "queries", request.queries);
+  return request;
+}
+
+template <class T>
+static T DeserializeRequest(ClientContext &context,
+                            const std::string &content) {
+  MemoryStream stream(
+      reinterpret_cast<data_ptr_t>(const_cast<char *>(content.data())),
+      content.size());
+  BinaryDeserializer deserializer(stream);
+  deserializer.Set<ClientContext &>(context);
+  deserializer.Begin();
+  auto request = T::Deserialize(deserializer);
+  deserializer.End();
+  deserializer.Unset<ClientContext>();
+  return request;
+}
+
+RunRequest DeserializeRunRequest(ClientContext &context,
+                                 const std::string &content) {
+  return DeserializeRequest<RunRequest>(context, content);
+}
+
+BatchRequest DeserializeBatchRequest(ClientContext &context,
+                                     const std::string &content) {
+  return DeserializeRequest<BatchRequest>(context, content);
+}
+
 void EmptyResult::Serialize(Serializer &) const {}
 
 void TokenizeResult::Serialize(Serializer &serializer) const {
@@ -34,13 +89,204 @@ void Chunk::Serialize(Serializer &serializer) const {
                        });
 }
 
+void ColumnProfile::Serialize(Serializer &serializer) const {
+  serializer.WriteProperty(100, "null_count", null_count);
+  serializer.WriteProperty(101, "distinct_count", distinct_count);
+  serializer.WriteProperty(102, "has_min_max", has_min_max);
+  if (has_min_max) {
+    serializer.WriteProperty(103, "min", min);
+    serializer.WriteProperty(104, "max", max);
+  }
+  serializer.WriteProperty(105, "has_histogram", has_histogram);
+  if (has_histogram) {
+    serializer.WriteProperty(106, "histogram_lower", histogram_lower);
+    serializer.WriteProperty(107, "histogram_bucket_width",
+                             histogram_bucket_width);
+    serializer.WriteProperty(108, "histogram_counts", histogram_counts);
+  }
+}
+
 void SuccessResult::Serialize(Serializer &serializer) const {
   serializer.WriteProperty(100, "success", true);
   serializer.WriteProperty(101, "column_names_and_types",
                            column_names_and_types);
-  serializer.WriteList(
-      102, "chunks", chunks.size(),
-      [&](Serializer::List &list, idx_t i) { list.WriteElement(chunks[i]); });
+  const idx_t chunk_count =
+      chunk_serializer ? chunk_serializer->GetChunkCount() : chunks.size();
+  serializer.WriteList(102, "chunks", chunk_count,
+                       [&](Serializer::List &list, idx_t i) {
+                         if (chunk_serializer) {
+                           chunk_serializer->SkipChunk(i);
+                         } else {
+                           list.WriteElement(chunks[i]);
+                         }
+                       });
+  if (total_row_count.IsValid()) {
+    serializer.WriteProperty(103, "total_row_count",
+                             total_row_count.GetIndex());
+    serializer.WriteProperty(104, "total_row_count_is_estimate",
+                             total_row_count_is_estimate);
+  }
+  if (!column_profiles.empty()) {
+    serializer.WriteList(105, "column_profiles", column_profiles.size(),
+                         [&](Serializer::List &list, idx_t i) {
+                           list.WriteElement(column_profiles[i]);
+                         });
+  }
+  if (!chunk_references.empty()) {
+    serializer.WriteProperty(106, "chunk_references", chunk_references);
+  }
+  if (result_version.IsValid()) {
+    serializer.WriteProperty(107, "result_version", result_version.GetIndex());
+  }
+}
+
+// Below this many chunks, scheduling tasks costs more than it saves.
+constexpr idx_t PARALLEL_SERIALIZATION_MIN_CHUNKS = 8;
+
+// Chunks per thread serialized ahead of time.
+constexpr idx_t PARALLEL_SERIALIZATION_CHUNKS_PER_THREAD = 4;
+
+class SerializeChunksTask : public BaseExecutorTask {
+public:
+  SerializeChunksTask(TaskExecutor &executor, const vector<Chunk> &chunks,
+                      vector<unique_ptr<MemoryStream>> &buffers,
+                      idx_t window_begin, idx_t begin, idx_t end)
+      : BaseExecutorTask(executor), chunks(chunks), buffers(buffers),
+        window_begin(window_begin), begin(begin), end(end) {}
+
+  void ExecuteTask() override {
+    for (idx_t i = begin; i < end; ++i) {
+      BinarySerializer::Serialize(chunks[i], *buffers[i - window_begin]);
+    }
+  }
+
+private:
+  const vector<Chunk> &chunks;
+  vector<unique_ptr<MemoryStream>> &buffers;
+  idx_t window_begin;
+  idx_t begin;
+  idx_t end;
+};
+
+// Serializes `count` chunks starting at `begin` to `buffers`, which are
+// reused. Unless there are too few of them, the chunks are encoded in
+// parallel.
+static void SerializeChunks(ClientContext &context, const vector<Chunk> &chunks,
+                            idx_t begin, idx_t count,
+                            vector<unique_ptr<MemoryStream>> &buffers) {
+  buffers.resize(count);
+  for (auto &buffer : buffers) {
+    if (buffer) {
+      buffer->Rewind();
+    } else {
+      buffer = make_uniq<MemoryStream>();
+    }
+  }
+
+  const idx_t thread_count = static_cast<idx_t>(
+      TaskScheduler::GetScheduler(context).NumberOfThreads());
+  if (thread_count <= 1 || count < PARALLEL_SERIALIZATION_MIN_CHUNKS) {
+    for (idx_t i = 0; i < count; ++i) {
+      BinarySerializer::Serialize(chunks[begin + i], *buffers[i]);
+    }
+    return;
+  }
+
+  // One task per contiguous range of chunks. The request thread works on the
+  // tasks too, until all are done.
+  TaskExecutor executor(context);
+  const idx_t task_count = MinValue(thread_count, count);
+  for (idx_t task = 0; task < task_count; ++task) {
+    executor.ScheduleTask(make_uniq<SerializeChunksTask>(
+        executor, chunks, buffers, begin, begin + count * task / task_count,
+        begin + count * (task + 1) / task_count));
+  }
+  executor.WorkOnTasks();
+}
+
+// Writes to `head` until `Split` is called, and to `tail` after.
+class SplitWriteStream : public WriteStream {
+public:
+  void WriteData(const_data_ptr_t buffer, idx_t write_size) override {
+    (split ? tail : head)
+        .append(reinterpret_cast<const char *>(buffer), write_size);
+  }
+  void Split() { split = true; }
+
+  std::string head;
+  std::string tail;
+
+private:
+  bool split = false;
+};
+
+ChunkSerializer::ChunkSerializer(ClientContext &context, WriteStream &target)
+    : context(context), target(target), chunk_count(0),
+      has_chunk_references(false), result_stream(nullptr) {
+  const idx_t thread_count = static_cast<idx_t>(
+      TaskScheduler::GetScheduler(context).NumberOfThreads());
+  window_size = thread_count <= 1
+                    ? 1
+                    : thread_count * PARALLEL_SERIALIZATION_CHUNKS_PER_THREAD;
+}
+
+void ChunkSerializer::SetReferenceFunction(ReferenceFunction function) {
+  reference_function = std::move(function);
+}
+
+void ChunkSerializer::Append(vector<Chunk> &new_chunks) {
+  for (auto &chunk : new_chunks) {
+    chunks.push_back(std::move(chunk));
+    if (chunks.size() >= window_size) {
+      Flush();
+    }
+  }
+  new_chunks.clear();
+}
+
+void ChunkSerializer::Flush() {
+  if (chunks.empty()) {
+    return;
+  }
+  // Chunks the client already has are matched first, so only the others are
+  // encoded.
+  for (auto &chunk : chunks) {
+    const idx_t reference = reference_function ? reference_function(chunk) : 0;
+    chunk_references.push_back(reference);
+    if (reference != 0) {
+      has_chunk_references = true;
+      chunk.vectors.clear();
+    }
+  }
+  SerializeChunks(context, chunks, 0, chunks.size(), buffers);
+  for (idx_t i = 0; i < chunks.size(); ++i) {
+    target.WriteData(buffers[i]->GetData(), buffers[i]->GetPosition());
+  }
+  chunk_count += chunks.size();
+  chunks.clear();
+}
+
+void ChunkSerializer::SerializeResult(SuccessResult &result, std::string &head,
+                                      std::string &tail) {
+  Flush();
+  if (has_chunk_references) {
+    result.chunk_references = std::move(chunk_references);
+  }
+  SplitWriteStream stream;
+  result_stream = &stream;
+  result.chunk_serializer = this;
+  BinarySerializer::Serialize(result, stream);
+  result.chunk_serializer = nullptr;
+  result_stream = nullptr;
+  head = std::move(stream.head);
+  tail = std::move(stream.tail);
+}
+
+void ChunkSerializer::SkipChunk(idx_t index) {
+  // The chunks go between the list's length and what follows the list.
+  if (index == 0 && result_stream) {
+    result_stream->Split();
+  }
 }
 
 void ErrorResult::Serialize(Serializer &serializer) const {
@@ -48,5 +294,15 @@ void ErrorResult::Serialize(Serializer &serializer) const {
   serializer.WriteProperty(101, "error", error);
 }
 
+void ScriptStatementResult::Serialize(Serializer &serializer) const {
+  serializer.WriteProperty(100, "statement_index", statement_index);
+  serializer.WriteProperty(101, "elapsed_ms", elapsed_ms);
+  if (success) {
+    serializer.WriteProperty(102, "result", success_result);
+  } else {
+    serializer.WriteProperty(102, "result", error_result);
+  }
+}
+
 } // namespace ui
 } // namespace duckdb
@@ -2,16 +2,19 @@
 
 #include <duckdb/main/attached_database.hpp>
 
+#include <algorithm>
+
 #include "utils/helpers.hpp"
 #include "utils/md_helpers.hpp"
 #include "http_server.hpp"
 #include "settings.hpp"
+#include "state.hpp"
 
 namespace duckdb {
 namespace ui {
 
 Watcher::Watcher(HttpServer &_server)
-    : should_run(false), server(_server), watched_database(nullptr) {}
+    : should_run(false), server(_server) {}
 
 bool WasCatalogUpdated(DatabaseInstance &db, Connection &connection,
                        CatalogState &last_state) {
@@ -60,43 +63,75 @@ bool WasCatalogUpdated(DatabaseInstance &db, Connection &connection,
   return has_change;
 }
 
+// One thread polls every database instance the server is used with, so
+// switching between them doesn't restart it.
 void Watcher::Watch() {
-  CatalogState last_state;
-  bool is_md_connected = false;
   while (should_run) {
-    auto db = server.LockDatabaseInstance();
-    if (!db) {
-      break; // DB went away, nothing to watch
-    }
-
-    if (watched_database == nullptr) {
-      watched_database = db.get();
-    } else if (watched_database != db.get()) {
-      break; // DB changed, stop watching, will be restarted
+    auto instances = server.LockDatabaseInstances();
+
+    // There is one thread, so the default instance's polling interval
+    // applies to all of them. Catalog event delays are per instance.
+    uint32_t polling_interval = UI_POLLING_INTERVAL_SETTING_DEFAULT;
+    auto default_db = server.LockDatabaseInstance();
+    if (default_db) {
+      duckdb::Connection con{*default_db};
+      polling_interval = GetPollingInterval(*con.context);
     }
-
-    duckdb::Connection con{*db};
-    auto polling_interval = GetPollingInterval(*con.context);
     if (polling_interval == 0) {
       return; // Disable watcher
     }
 
-    try {
-      if (WasCatalogUpdated(*db, con, last_state)) {
-        server.event_dispatcher->SendCatalogChangedEvent();
+    // Forget instances that are gone.
+    for (auto it = watched_instances.begin(); it != watched_instances.end();) {
+      auto found = std::find_if(
+          instances.begin(), instances.end(),
+          [&](const std::pair<std::string, shared_ptr<DatabaseInstance>> &i) {
+            return i.first == it->first;
+          });
+      if (found == instances.end()) {
+        it = watched_instances.erase(it);
+      } else {
+        ++it;
       }
+    }
 
-      if (!is_md_connected && IsMDConnected(con)) {
-        is_md_connected = true;
-        server.event_dispatcher->SendConnectedEvent(GetMDToken(con));
+    const auto poll_start = std::chrono::steady_clock::now();
+    for (auto &instance : instances) {
+      auto &db = *instance.second;
+      auto &watched = watched_instances[instance.first];
+      try {
+        duckdb::Connection con{db};
+        if (WasCatalogUpdated(db, con, watched.catalog_state)) {
+          server.event_dispatcher->SendCatalogChangedEvent(
+              instance.first,
+              std::chrono::milliseconds(GetCatalogEventDebounce(*con.context)),
+              std::chrono::milliseconds(
+                  GetCatalogEventMaxDelay(*con.context)));
+        }
+
+        if (!watched.is_md_connected && IsMDConnected(con)) {
+          watched.is_md_connected = true;
+          server.event_dispatcher->SendConnectedEvent(GetMDToken(con));
+        }
+        watched.has_error = false;
+      } catch (std::exception &ex) {
+        // Keep watching this and the other instances. Only report the first
+        // of consecutive errors, since the next poll likely fails the same
+        // way.
+        if (!watched.has_error) {
+          std::cerr << "Error in watcher for UI instance " << instance.first
+                    << ": " << ex.what() << std::endl;
+        }
+        watched.has_error = true;
       }
-    } catch (std::exception &ex) {
-      // Do not crash with uncaught exception, but quit.
-      std::cerr << "Error in watcher: " << ex.what() << std::endl;
-      std::cerr << "Will now terminate." << std::endl;
-      return;
     }
+    // Don't keep instances alive while waiting.
+    instances.clear();
+    default_db.reset();
+    server.metrics.RecordWatcherPoll(std::chrono::steady_clock::now() -
+                                     poll_start);
 
+    // Held back catalog change events are sent by the event dispatcher.
     {
       std::unique_lock<std::mutex> lock(mutex);
       cv.wait_for(lock, std::chrono::milliseconds(polling_interval));
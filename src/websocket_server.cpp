@@ -0,0 +1,919 @@
+#include "websocket_server.hpp"
+
+#include "http_server.hpp"
+
+#include <duckdb/common/types/blob.hpp>
+
+#include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <openssl/sha.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// macOS has no MSG_NOSIGNAL; sockets get SO_NOSIGPIPE instead.
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+namespace duckdb {
+namespace ui {
+
+// Threads running requests, shared by every connection.
+constexpr idx_t WORKER_THREADS = 8;
+// Connections open at the same time; more are turned away.
+constexpr idx_t MAX_CONNECTIONS = 16;
+// Requests running at the same time on one connection.
+constexpr idx_t MAX_REQUESTS_IN_FLIGHT = 4;
+// Requests queued or running on one connection before the server stops
+// reading.
+constexpr idx_t MAX_QUEUED_REQUESTS = 16;
+// Events waiting to be sent to one connection. Past this, the oldest is
+// dropped, as on `/localEvents`, and the client is told how many were.
+constexpr idx_t MAX_QUEUED_EVENTS = 64;
+// Largest request message accepted.
+constexpr idx_t MAX_MESSAGE_SIZE = 64 * 1024 * 1024;
+// Largest payload of a control frame (RFC 6455, section 5.5).
+constexpr idx_t MAX_CONTROL_FRAME_SIZE = 125;
+// Largest piece of a response body sent in one message.
+constexpr idx_t MAX_DATA_SIZE = 64 * 1024;
+// Sends blocked longer than this close the connection.
+constexpr int SEND_TIMEOUT_SECONDS = 30;
+// Time allowed for the upgrade request once a client connects.
+constexpr int HANDSHAKE_TIMEOUT_SECONDS = 10;
+// Time allowed for the rest of a frame once its first byte arrived.
+constexpr int RECEIVE_TIMEOUT_SECONDS = 30;
+
+constexpr const char *WEBSOCKET_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+enum class WebSocketOpcode : uint8_t {
+  CONTINUATION = 0x0,
+  TEXT = 0x1,
+  BINARY = 0x2,
+  CLOSE = 0x8,
+  PING = 0x9,
+  PONG = 0xA
+};
+
+enum class MessageKind : uint8_t {
+  DATA = 0,
+  END = 1,
+  EVENT = 2,
+  EVENTS_DROPPED = 3
+};
+
+struct WebSocketRequest {
+  std::string type;
+  uint32_t request_id = 0;
+  httplib::Headers headers;
+  std::string body;
+};
+
+// Threads running the requests of every connection. A connection is queued
+// once per request it may start, so connections take turns.
+class WebSocketWorkerPool {
+public:
+  void Start(idx_t thread_count) {
+    should_run = true;
+    for (idx_t i = 0; i < thread_count; ++i) {
+      threads.emplace_back(&WebSocketWorkerPool::Work, this);
+    }
+  }
+
+  // Connections must be done first; queued ones are dropped.
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      should_run = false;
+    }
+    cv.notify_all();
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    threads.clear();
+    ready.clear();
+  }
+
+  // Runs the next request of `connection` on a pool thread.
+  void Schedule(shared_ptr<WebSocketConnection> connection) {
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      ready.push_back(std::move(connection));
+    }
+    cv.notify_one();
+  }
+
+private:
+  void Work();
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool should_run = false;
+  std::deque<shared_ptr<WebSocketConnection>> ready;
+  vector<std::thread> threads;
+};
+
+// One client connection: a reader thread parses requests and queues them for
+// the worker pool, which runs them through the HTTP handlers. The reader also
+// handles interrupts and sends events. Queued events and Close wake it through
+// a pipe.
+class WebSocketConnection
+    : public enable_shared_from_this<WebSocketConnection> {
+public:
+  // Takes ownership of `socket` and of both ends of the non-blocking
+  // `wake_pipe`.
+  WebSocketConnection(HttpServer &server, WebSocketWorkerPool &pool,
+                      const std::string &origin, int socket,
+                      const int wake_pipe[2])
+      : server(server), pool(pool), origin(origin), socket(socket),
+        wake_read(wake_pipe[0]), wake_write(wake_pipe[1]), closed(false),
+        finished(false) {}
+
+  ~WebSocketConnection() {
+#ifndef _WIN32
+    close(wake_read);
+    close(wake_write);
+#endif
+  }
+
+  void Start() {
+    reader = make_uniq<std::thread>(&WebSocketConnection::Read,
+                                    shared_from_this());
+  }
+
+  // Stops reading and sending; requests in progress end at their next send.
+  void Close() {
+    closed = true;
+#ifndef _WIN32
+    shutdown(socket, SHUT_RDWR);
+    Wake();
+#endif
+    queue_cv.notify_all();
+  }
+
+  void Join() {
+    if (reader) {
+      reader->join();
+      reader.reset();
+    }
+  }
+
+  bool IsFinished() const { return finished; }
+
+  // Called by the worker pool, once per time the connection was scheduled.
+  void RunNext();
+
+private:
+  void Read();
+  // Returns false if the connection was closed first.
+  bool Queue(WebSocketRequest request);
+  void Handle(WebSocketRequest &request);
+  void QueueEvent(const std::string &message);
+  bool HasQueuedEvents();
+  // Returns false if the connection broke.
+  bool SendQueuedEvents();
+  // Makes the reader's poll return.
+  void Wake();
+  bool Handshake();
+  bool ReadExactly(char *buffer, idx_t size);
+  bool ReadFrame(std::string &message, bool &complete);
+  bool SendFrame(WebSocketOpcode opcode, const char *data, idx_t size);
+  bool SendMessage(uint32_t request_id, MessageKind kind, const char *data,
+                   idx_t size);
+  bool SendAll(const char *data, idx_t size);
+
+  HttpServer &server;
+  WebSocketWorkerPool &pool;
+  std::string origin;
+  int socket;
+  int wake_read;
+  int wake_write;
+  std::atomic<bool> closed;
+  std::atomic<bool> finished;
+  unique_ptr<std::thread> reader;
+
+  std::mutex queue_mutex;
+  std::condition_variable queue_cv;
+  std::deque<WebSocketRequest> queue;
+  // Requests being handled by the pool.
+  idx_t running = 0;
+  // Times the connection is queued in, or running on, the pool.
+  idx_t scheduled = 0;
+
+  std::mutex events_mutex;
+  std::deque<std::string> events;
+  // Events dropped since the last were sent.
+  uint32_t dropped_event_count = 0;
+
+  // Held while writing a frame, so frames of different requests don't mix.
+  std::mutex send_mutex;
+};
+
+#ifndef _WIN32
+
+static std::string ComputeAcceptKey(const std::string &key) {
+  const auto input = key + WEBSOCKET_GUID;
+  unsigned char digest[SHA_DIGEST_LENGTH];
+  SHA1(reinterpret_cast<const unsigned char *>(input.data()), input.size(),
+       digest);
+  return Blob::ToBase64(
+      string_t(reinterpret_cast<const char *>(digest), SHA_DIGEST_LENGTH));
+}
+
+// Parses `<type> <request id>`, the headers and the body of a request.
+static bool ParseRequest(const std::string &message,
+                         WebSocketRequest &request) {
+  auto line_end = message.find('\n');
+  if (line_end == std::string::npos) {
+    return false;
+  }
+  auto first_line = message.substr(0, line_end);
+  auto space = first_line.find(' ');
+  if (space == std::string::npos) {
+    return false;
+  }
+  request.type = first_line.substr(0, space);
+  try {
+    request.request_id =
+        static_cast<uint32_t>(std::stoul(first_line.substr(space + 1)));
+  } catch (std::exception &) {
+    return false;
+  }
+
+  auto position = line_end + 1;
+  while (true) {
+    line_end = message.find('\n', position);
+    if (line_end == std::string::npos) {
+      return false;
+    }
+    if (line_end == position) {
+      break;
+    }
+    auto line = message.substr(position, line_end - position);
+    auto colon = line.find(':');
+    if (colon == std::string::npos) {
+      return false;
+    }
+    auto name = line.substr(0, colon);
+    auto value = line.substr(colon + 1);
+    StringUtil::Trim(value);
+    request.headers.emplace(std::move(name), std::move(value));
+    position = line_end + 1;
+  }
+  request.body = message.substr(line_end + 1);
+  return true;
+}
+
+void WebSocketConnection::Read() {
+  uint64_t listener_id = 0;
+  bool listening = false;
+  // Like the pool's threads, this one must not let an exception escape.
+  try {
+    if (Handshake()) {
+      // The reader polls between frames, so this only bounds how long a
+      // client can stall in the middle of one.
+      timeval timeout{RECEIVE_TIMEOUT_SECONDS, 0};
+      setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+      if (server.event_dispatcher) {
+        auto self = shared_from_this();
+        listener_id = server.event_dispatcher->AddListener(
+            [self](const std::string &msg) { self->QueueEvent(msg); });
+        listening = true;
+      }
+
+      std::string message;
+      while (!closed) {
+        pollfd poll_fds[2] = {{socket, POLLIN, 0}, {wake_read, POLLIN, 0}};
+        auto ready = poll(poll_fds, 2, -1);
+        if (ready < 0 && errno != EINTR) {
+          break;
+        }
+        if (poll_fds[1].revents & POLLIN) {
+          char drained[64];
+          while (read(wake_read, drained, sizeof(drained)) > 0) {
+          }
+        }
+        if (!SendQueuedEvents()) {
+          break;
+        }
+        const auto readable = POLLIN | POLLHUP | POLLERR;
+        if (ready <= 0 || !(poll_fds[0].revents & readable)) {
+          continue;
+        }
+        bool complete = false;
+        if (!ReadFrame(message, complete)) {
+          break;
+        }
+        if (!complete) {
+          continue;
+        }
+        WebSocketRequest request;
+        const bool parsed = ParseRequest(message, request);
+        message.clear();
+        if (!parsed) {
+          // Can't answer a request we couldn't read the id of.
+          break;
+        }
+        if (request.type == "interrupt") {
+          // Not queued, so it isn't stuck behind the runs it should stop.
+          Handle(request);
+        } else if (!Queue(std::move(request))) {
+          break;
+        }
+      }
+    }
+  } catch (std::exception &ex) {
+    std::cerr << "Error in WebSocket connection: " << ex.what() << std::endl;
+  }
+
+  Close();
+  if (listening && server.event_dispatcher) {
+    server.event_dispatcher->RemoveListener(listener_id);
+  }
+  {
+    // Closed connections leave the pool at its next look at them.
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    queue_cv.wait(lock, [&] { return scheduled == 0; });
+  }
+  close(socket);
+  finished = true;
+}
+
+bool WebSocketConnection::Queue(WebSocketRequest request) {
+  std::unique_lock<std::mutex> lock(queue_mutex);
+  while (!closed && queue.size() + running >= MAX_QUEUED_REQUESTS) {
+    // Events keep going out while the reader waits for room.
+    queue_cv.wait(lock, [&] {
+      return closed || queue.size() + running < MAX_QUEUED_REQUESTS ||
+             HasQueuedEvents();
+    });
+    lock.unlock();
+    const bool sent = SendQueuedEvents();
+    lock.lock();
+    if (!sent) {
+      return false;
+    }
+  }
+  if (closed) {
+    return false;
+  }
+  queue.push_back(std::move(request));
+  const bool schedule = scheduled < MAX_REQUESTS_IN_FLIGHT;
+  if (schedule) {
+    ++scheduled;
+  }
+  lock.unlock();
+  if (schedule) {
+    pool.Schedule(shared_from_this());
+  }
+  return true;
+}
+
+void WebSocketConnection::RunNext() {
+  WebSocketRequest request;
+  {
+    std::lock_guard<std::mutex> guard(queue_mutex);
+    if (closed || queue.empty()) {
+      queue.clear();
+      --scheduled;
+      queue_cv.notify_all();
+      return;
+    }
+    request = std::move(queue.front());
+    queue.pop_front();
+    ++running;
+  }
+  try {
+    Handle(request);
+  } catch (std::exception &ex) {
+    std::cerr << "Error in WebSocket request: " << ex.what() << std::endl;
+    Close();
+  }
+  bool reschedule;
+  {
+    std::lock_guard<std::mutex> guard(queue_mutex);
+    --running;
+    reschedule = !closed && !queue.empty();
+    if (!reschedule) {
+      --scheduled;
+    }
+    queue_cv.notify_all();
+  }
+  // To the back of the pool's queue, behind other connections.
+  if (reschedule) {
+    pool.Schedule(shared_from_this());
+  }
+}
+
+void WebSocketWorkerPool::Work() {
+  while (true) {
+    shared_ptr<WebSocketConnection> connection;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [&] { return !should_run || !ready.empty(); });
+      if (!should_run) {
+        return;
+      }
+      connection = std::move(ready.front());
+      ready.pop_front();
+    }
+    connection->RunNext();
+  }
+}
+
+// Called on the thread raising the event, so it must not block on the client.
+void WebSocketConnection::QueueEvent(const std::string &message) {
+  {
+    std::lock_guard<std::mutex> guard(events_mutex);
+    if (events.size() >= MAX_QUEUED_EVENTS) {
+      events.pop_front();
+      ++dropped_event_count;
+    }
+    events.push_back(message);
+  }
+  Wake();
+  // The reader may be waiting for room in the request queue instead.
+  std::lock_guard<std::mutex> guard(queue_mutex);
+  queue_cv.notify_all();
+}
+
+bool WebSocketConnection::HasQueuedEvents() {
+  std::lock_guard<std::mutex> guard(events_mutex);
+  return !events.empty();
+}
+
+void WebSocketConnection::Wake() {
+  // The pipe is non-blocking; if it's full, the reader is already awake.
+  const char byte = 0;
+  auto written = write(wake_write, &byte, 1);
+  (void)written;
+}
+
+bool WebSocketConnection::SendQueuedEvents() {
+  std::deque<std::string> to_send;
+  uint32_t dropped;
+  {
+    std::lock_guard<std::mutex> guard(events_mutex);
+    to_send.swap(events);
+    dropped = dropped_event_count;
+    dropped_event_count = 0;
+  }
+  // The client missed some events, so it must resync whatever they keep up
+  // to date before applying the ones that follow.
+  if (dropped > 0) {
+    const char dropped_bytes[4] = {
+        static_cast<char>(dropped & 0xFF),
+        static_cast<char>((dropped >> 8) & 0xFF),
+        static_cast<char>((dropped >> 16) & 0xFF),
+        static_cast<char>((dropped >> 24) & 0xFF)};
+    if (!SendMessage(0, MessageKind::EVENTS_DROPPED, dropped_bytes, 4)) {
+      return false;
+    }
+  }
+  for (auto &message : to_send) {
+    if (!SendMessage(0, MessageKind::EVENT, message.data(), message.size())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void WebSocketConnection::Handle(WebSocketRequest &request) {
+  httplib::Request req;
+  req.method = "POST";
+  req.path = "/ddb/" + request.type;
+  req.headers = std::move(request.headers);
+  // The origin was checked once, during the handshake.
+  req.headers.erase("Origin");
+  req.headers.emplace("Origin", origin);
+  req.body = std::move(request.body);
+  const auto &body = req.body;
+  httplib::ContentReader content_reader(
+      [&](httplib::ContentReceiver receiver) {
+        return receiver(body.data(), body.size());
+      },
+      [](httplib::MultipartContentHeader, httplib::ContentReceiver) {
+        return false;
+      });
+
+  httplib::Response res;
+  try {
+    if (request.type == "run") {
+      ScopedRequestTimer timer(server.metrics, MetricsRoute::RUN);
+      server.HandleRun(req, res, content_reader);
+    } else if (request.type == "tokenize") {
+      ScopedRequestTimer timer(server.metrics, MetricsRoute::TOKENIZE);
+      server.HandleTokenize(req, res, content_reader);
+    } else if (request.type == "interrupt") {
+      ScopedRequestTimer timer(server.metrics, MetricsRoute::INTERRUPT);
+      server.HandleInterrupt(req, res);
+    } else if (request.type == "window") {
+      ScopedRequestTimer timer(server.metrics, MetricsRoute::WINDOW);
+      server.HandleWindow(req, res);
+    } else if (request.type == "batch") {
+      ScopedRequestTimer timer(server.metrics, MetricsRoute::BATCH);
+      server.HandleBatch(req, res, content_reader);
+    } else {
+      res.status = 404;
+    }
+  } catch (std::exception &ex) {
+    std::cerr << "Error in WebSocket request: " << ex.what() << std::endl;
+    res.status = 500;
+  }
+  if (res.status == -1) {
+    res.status = 200;
+  }
+
+  const auto request_id = request.request_id;
+  httplib::DataSink sink;
+  idx_t offset = 0;
+  bool done = false;
+  sink.write = [&](const char *data, size_t size) {
+    while (size > 0) {
+      const auto piece = MinValue<idx_t>(size, MAX_DATA_SIZE);
+      if (!SendMessage(request_id, MessageKind::DATA, data, piece)) {
+        return false;
+      }
+      data += piece;
+      size -= piece;
+      offset += piece;
+    }
+    return true;
+  };
+  sink.is_writable = [&] { return !closed.load(); };
+  sink.done = [&] { done = true; };
+
+  bool success = true;
+  if (res.content_provider_) {
+    if (res.content_length_ > 0) {
+      while (success && offset < res.content_length_) {
+        success = res.content_provider_(
+            offset, res.content_length_ - offset, sink);
+      }
+    } else {
+      while (success && !done && !closed) {
+        success = res.content_provider_(offset, 0, sink);
+      }
+    }
+    // Released when `res` goes out of scope.
+    res.content_provider_success_ = success && !closed;
+  } else if (!res.body.empty()) {
+    success = sink.write(res.body.data(), res.body.size());
+  }
+
+  if (success) {
+    const uint16_t status = static_cast<uint16_t>(res.status);
+    const char status_bytes[2] = {static_cast<char>(status & 0xFF),
+                                  static_cast<char>(status >> 8)};
+    SendMessage(request_id, MessageKind::END, status_bytes, 2);
+  }
+}
+
+bool WebSocketConnection::Handshake() {
+  // Read the HTTP upgrade request.
+  std::string request;
+  char buffer[1024];
+  while (request.find("\r\n\r\n") == std::string::npos) {
+    if (request.size() > 16 * 1024) {
+      return false;
+    }
+    auto received = recv(socket, buffer, sizeof(buffer), 0);
+    if (received <= 0) {
+      return false;
+    }
+    request.append(buffer, static_cast<size_t>(received));
+  }
+
+  auto lines = StringUtil::Split(request.substr(0, request.find("\r\n\r\n")),
+                                 "\r\n");
+  if (lines.empty()) {
+    return false;
+  }
+  const auto request_line = StringUtil::Split(lines[0], ' ');
+  case_insensitive_map_t<std::string> headers;
+  for (idx_t i = 1; i < lines.size(); ++i) {
+    auto colon = lines[i].find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    auto value = lines[i].substr(colon + 1);
+    StringUtil::Trim(value);
+    headers[lines[i].substr(0, colon)] = value;
+  }
+
+  const char *error_status = nullptr;
+  if (request_line.size() < 2 || request_line[0] != "GET" ||
+      request_line[1] != "/ddb/ws") {
+    error_status = "404 Not Found";
+  } else if (headers["Origin"] != origin) {
+    error_status = "401 Unauthorized";
+  } else if (!StringUtil::CIEquals(headers["Upgrade"], "websocket") ||
+             headers["Sec-WebSocket-Key"].empty()) {
+    error_status = "400 Bad Request";
+  }
+  if (error_status) {
+    auto response = StringUtil::Format(
+        "HTTP/1.1 %s\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",
+        error_status);
+    SendAll(response.data(), response.size());
+    return false;
+  }
+
+  auto response = StringUtil::Format(
+      "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+      "Connection: Upgrade\r\nSec-WebSocket-Accept: %s\r\n\r\n",
+      ComputeAcceptKey(headers["Sec-WebSocket-Key"]));
+  std::lock_guard<std::mutex> guard(send_mutex);
+  return SendAll(response.data(), response.size());
+}
+
+bool WebSocketConnection::ReadExactly(char *buffer, idx_t size) {
+  while (size > 0) {
+    auto received = recv(socket, buffer, size, 0);
+    if (received <= 0) {
+      return false;
+    }
+    buffer += received;
+    size -= static_cast<idx_t>(received);
+  }
+  return true;
+}
+
+// Reads the next frame, answering control frames. Appends the payload of
+// data frames to `message`, and sets `complete` once it holds a whole message.
+// Returns false once the connection is closed or broken.
+bool WebSocketConnection::ReadFrame(std::string &message, bool &complete) {
+  uint8_t header[2];
+  if (!ReadExactly(reinterpret_cast<char *>(header), 2)) {
+    return false;
+  }
+  const bool fin = header[0] & 0x80;
+  const auto opcode = static_cast<WebSocketOpcode>(header[0] & 0x0F);
+  const bool masked = header[1] & 0x80;
+  uint64_t length = header[1] & 0x7F;
+  if (length == 126) {
+    uint8_t extended[2];
+    if (!ReadExactly(reinterpret_cast<char *>(extended), 2)) {
+      return false;
+    }
+    length = (uint64_t(extended[0]) << 8) | extended[1];
+  } else if (length == 127) {
+    uint8_t extended[8];
+    if (!ReadExactly(reinterpret_cast<char *>(extended), 8)) {
+      return false;
+    }
+    length = 0;
+    for (auto byte : extended) {
+      length = (length << 8) | byte;
+    }
+  }
+  // Clients must mask their frames. Control frames are short and never
+  // fragmented; they can come between the frames of a message.
+  const bool is_control = static_cast<uint8_t>(opcode) & 0x8;
+  if (!masked) {
+    return false;
+  }
+  if (is_control ? (!fin || length > MAX_CONTROL_FRAME_SIZE)
+                 : length > MAX_MESSAGE_SIZE - message.size()) {
+    return false;
+  }
+  uint8_t mask[4];
+  if (!ReadExactly(reinterpret_cast<char *>(mask), 4)) {
+    return false;
+  }
+  std::string payload(length, '\0');
+  if (!ReadExactly(&payload[0], length)) {
+    return false;
+  }
+  for (idx_t i = 0; i < length; ++i) {
+    payload[i] = static_cast<char>(payload[i] ^ mask[i % 4]);
+  }
+
+  switch (opcode) {
+  case WebSocketOpcode::PING:
+    SendFrame(WebSocketOpcode::PONG, payload.data(), payload.size());
+    return true;
+  case WebSocketOpcode::PONG:
+    return true;
+  case WebSocketOpcode::CLOSE:
+    SendFrame(WebSocketOpcode::CLOSE, payload.data(),
+              MinValue<idx_t>(payload.size(), 2));
+    return false;
+  case WebSocketOpcode::TEXT:
+  case WebSocketOpcode::BINARY:
+  case WebSocketOpcode::CONTINUATION:
+    message += payload;
+    complete = fin;
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool WebSocketConnection::SendFrame(WebSocketOpcode opcode, const char *data,
+                                    idx_t size) {
+  std::lock_guard<std::mutex> guard(send_mutex);
+  char header[10];
+  idx_t header_size = 2;
+  header[0] = static_cast<char>(0x80 | static_cast<uint8_t>(opcode));
+  if (size < 126) {
+    header[1] = static_cast<char>(size);
+  } else if (size <= 0xFFFF) {
+    header[1] = 126;
+    header[2] = static_cast<char>(size >> 8);
+    header[3] = static_cast<char>(size & 0xFF);
+    header_size = 4;
+  } else {
+    header[1] = 127;
+    for (idx_t i = 0; i < 8; ++i) {
+      header[2 + i] = static_cast<char>((size >> (56 - 8 * i)) & 0xFF);
+    }
+    header_size = 10;
+  }
+  return SendAll(header, header_size) && SendAll(data, size);
+}
+
+bool WebSocketConnection::SendMessage(uint32_t request_id, MessageKind kind,
+                                      const char *data, idx_t size) {
+  if (closed) {
+    return false;
+  }
+  std::string message;
+  message.reserve(5 + size);
+  for (idx_t i = 0; i < 4; ++i) {
+    message += static_cast<char>((request_id >> (8 * i)) & 0xFF);
+  }
+  message += static_cast<char>(kind);
+  message.append(data, size);
+  if (!SendFrame(WebSocketOpcode::BINARY, message.data(), message.size())) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+bool WebSocketConnection::SendAll(const char *data, idx_t size) {
+  while (size > 0) {
+    auto sent = send(socket, data, size, MSG_NOSIGNAL);
+    if (sent <= 0) {
+      return false;
+    }
+    data += sent;
+    size -= static_cast<idx_t>(sent);
+  }
+  return true;
+}
+
+#endif
+
+WebSocketServer::WebSocketServer(HttpServer &_server, std::string _origin)
+    : server(_server), origin(std::move(_origin)), listen_socket(-1),
+      should_run(false) {}
+
+WebSocketServer::~WebSocketServer() { Stop(); }
+
+void WebSocketServer::Start(uint16_t port) {
+#ifdef _WIN32
+  throw NotImplementedException(
+      "The UI WebSocket transport is not supported on Windows");
+#else
+  listen_socket = socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_socket < 0) {
+    throw IOException("Could not create the UI WebSocket socket");
+  }
+  int reuse = 1;
+  setsockopt(listen_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  if (bind(listen_socket, reinterpret_cast<sockaddr *>(&address),
+           sizeof(address)) != 0 ||
+      listen(listen_socket, SOMAXCONN) != 0) {
+    close(listen_socket);
+    listen_socket = -1;
+    throw IOException("Could not listen on port %d for UI WebSockets", port);
+  }
+  pool = make_uniq<WebSocketWorkerPool>();
+  pool->Start(WORKER_THREADS);
+  should_run = true;
+  accept_thread = make_uniq<std::thread>(&WebSocketServer::Accept, this);
+#endif
+}
+
+void WebSocketServer::Stop() {
+#ifndef _WIN32
+  should_run = false;
+  if (accept_thread) {
+    accept_thread->join();
+    accept_thread.reset();
+  }
+  if (listen_socket >= 0) {
+    close(listen_socket);
+    listen_socket = -1;
+  }
+  vector<shared_ptr<WebSocketConnection>> to_close;
+  {
+    std::lock_guard<std::mutex> guard(connections_mutex);
+    to_close = std::move(connections);
+    connections.clear();
+  }
+  for (auto &connection : to_close) {
+    connection->Close();
+  }
+  for (auto &connection : to_close) {
+    connection->Join();
+  }
+  if (pool) {
+    pool->Stop();
+    pool.reset();
+  }
+#endif
+}
+
+void WebSocketServer::Accept() {
+#ifndef _WIN32
+  while (should_run) {
+    // Poll with a timeout, so Stop doesn't depend on closing the socket
+    // waking up `accept`.
+    pollfd poll_fd{listen_socket, POLLIN, 0};
+    auto ready = poll(&poll_fd, 1, 100);
+    RemoveClosedConnections();
+    if (ready <= 0) {
+      continue;
+    }
+    auto client_socket = accept(listen_socket, nullptr, nullptr);
+    if (client_socket < 0) {
+      continue;
+    }
+    bool at_capacity;
+    {
+      std::lock_guard<std::mutex> guard(connections_mutex);
+      at_capacity = connections.size() >= MAX_CONNECTIONS;
+    }
+    if (at_capacity) {
+      static const char response[] =
+          "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n"
+          "Connection: close\r\n\r\n";
+      send(client_socket, response, sizeof(response) - 1,
+           MSG_NOSIGNAL | MSG_DONTWAIT);
+      close(client_socket);
+      continue;
+    }
+    timeval send_timeout{SEND_TIMEOUT_SECONDS, 0};
+    setsockopt(client_socket, SOL_SOCKET, SO_SNDTIMEO, &send_timeout,
+               sizeof(send_timeout));
+    // Until the upgrade request is read; the reader changes it after.
+    timeval receive_timeout{HANDSHAKE_TIMEOUT_SECONDS, 0};
+    setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &receive_timeout,
+               sizeof(receive_timeout));
+#ifdef SO_NOSIGPIPE
+    int no_sigpipe = 1;
+    setsockopt(client_socket, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe,
+               sizeof(no_sigpipe));
+#endif
+
+    int wake_pipe[2];
+    if (pipe(wake_pipe) != 0) {
+      close(client_socket);
+      continue;
+    }
+    for (auto fd : wake_pipe) {
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    auto connection = make_shared_ptr<WebSocketConnection>(
+        server, *pool, origin, client_socket, wake_pipe);
+    {
+      std::lock_guard<std::mutex> guard(connections_mutex);
+      connections.push_back(connection);
+    }
+    connection->Start();
+  }
+#endif
+}
+
+void WebSocketServer::RemoveClosedConnections() {
+  std::lock_guard<std::mutex> guard(connections_mutex);
+  for (auto it = connections.begin(); it != connections.end();) {
+    if ((*it)->IsFinished()) {
+      (*it)->Join();
+      it = connections.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+} // namespace ui
+} // namespace duckdb
@@ -0,0 +1,83 @@
+#include "catch.hpp"
+
+#include "chunk_coalescer.hpp"
+#include "test_helpers.hpp"
+
+using namespace duckdb;
+using namespace duckdb::ui;
+
+// Checks that `batches` hold the integers from 0 on, in order.
+static void CheckSequence(const duckdb::vector<Chunk> &batches) {
+  int32_t expected = 0;
+  for (auto &batch : batches) {
+    REQUIRE(batch.vectors.size() == 1);
+    for (idx_t row = 0; row < batch.row_count; ++row) {
+      REQUIRE(batch.vectors[0].GetValue(row).GetValue<int32_t>() ==
+              expected++);
+    }
+  }
+}
+
+TEST_CASE("Small chunks are combined up to the target rows", "[ui]") {
+  ChunkCoalescer coalescer({LogicalType::INTEGER}, 1000, 0);
+  duckdb::vector<Chunk> batches;
+  DataChunk chunk;
+  for (idx_t i = 0; i < 25; ++i) {
+    FillIntegerChunk(chunk, static_cast<int32_t>(i * 100), 100);
+    coalescer.Append(chunk, batches);
+  }
+  REQUIRE(batches.size() == 2);
+  coalescer.Finish(batches);
+  REQUIRE(batches.size() == 3);
+  REQUIRE(batches[0].row_count == 1000);
+  REQUIRE(batches[1].row_count == 1000);
+  REQUIRE(batches[2].row_count == 500);
+  CheckSequence(batches);
+}
+
+TEST_CASE("Large chunks are passed through after the pending batch", "[ui]") {
+  ChunkCoalescer coalescer({LogicalType::INTEGER}, 1000, 0);
+  duckdb::vector<Chunk> batches;
+  DataChunk chunk;
+  FillIntegerChunk(chunk, 0, 100);
+  coalescer.Append(chunk, batches);
+  FillIntegerChunk(chunk, 100, 2000);
+  coalescer.Append(chunk, batches);
+  FillIntegerChunk(chunk, 2100, 10);
+  coalescer.Append(chunk, batches);
+  coalescer.Finish(batches);
+  REQUIRE(batches.size() == 3);
+  REQUIRE(batches[0].row_count == 100);
+  REQUIRE(batches[1].row_count == 2000);
+  REQUIRE(batches[2].row_count == 10);
+  CheckSequence(batches);
+}
+
+TEST_CASE("Batches end at the target bytes", "[ui]") {
+  // 50 INTEGERs are 200 bytes.
+  ChunkCoalescer coalescer({LogicalType::INTEGER}, 10000, 400);
+  duckdb::vector<Chunk> batches;
+  DataChunk chunk;
+  for (idx_t i = 0; i < 4; ++i) {
+    FillIntegerChunk(chunk, static_cast<int32_t>(i * 50), 50);
+    coalescer.Append(chunk, batches);
+  }
+  coalescer.Finish(batches);
+  REQUIRE(batches.size() == 2);
+  REQUIRE(batches[0].row_count == 100);
+  REQUIRE(batches[1].row_count == 100);
+  CheckSequence(batches);
+
+  FillIntegerChunk(chunk, 0, 100);
+  REQUIRE(ChunkCoalescer::EstimateSize(chunk) == 400);
+}
+
+TEST_CASE("Empty chunks produce no batch", "[ui]") {
+  ChunkCoalescer coalescer({LogicalType::INTEGER}, 1000, 0);
+  duckdb::vector<Chunk> batches;
+  DataChunk chunk;
+  FillIntegerChunk(chunk, 0, 0);
+  coalescer.Append(chunk, batches);
+  coalescer.Finish(batches);
+  REQUIRE(batches.empty());
+}
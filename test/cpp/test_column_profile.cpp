@@ -0,0 +1,103 @@
+#include "catch.hpp"
+
+#include "column_profile.hpp"
+
+#include <duckdb/common/types/hash.hpp>
+
+#include <limits>
+
+using namespace duckdb;
+using namespace duckdb::ui;
+
+TEST_CASE("Distinct count sketch estimates within its error", "[ui]") {
+  DistinctCountSketch empty;
+  REQUIRE(empty.Estimate() == 0);
+
+  // Small counts use linear counting, which is close to exact.
+  DistinctCountSketch small;
+  for (uint64_t i = 0; i < 100; ++i) {
+    small.Insert(Hash(i));
+    small.Insert(Hash(i));
+  }
+  REQUIRE(small.Estimate() >= 97);
+  REQUIRE(small.Estimate() <= 103);
+
+  // Standard error is ~1.6%; allow several of it.
+  DistinctCountSketch large;
+  for (uint64_t i = 0; i < 100000; ++i) {
+    large.Insert(Hash(i));
+  }
+  REQUIRE(large.Estimate() >= 92000);
+  REQUIRE(large.Estimate() <= 108000);
+}
+
+TEST_CASE("Streaming histogram keeps exact counts as it grows", "[ui]") {
+  StreamingHistogram histogram;
+  double lower;
+  double bucket_width;
+  duckdb::vector<idx_t> counts;
+  REQUIRE(!histogram.Finalize(lower, bucket_width, counts));
+
+  // More values than the initial buffer, then values on both sides of its
+  // range, so the buckets are doubled both ways.
+  idx_t added = 0;
+  for (int i = 0; i < 4000; ++i) {
+    histogram.Add(static_cast<double>(i));
+    ++added;
+  }
+  histogram.Add(-10000);
+  histogram.Add(50000);
+  histogram.Add(std::numeric_limits<double>::quiet_NaN());
+  added += 2;
+
+  REQUIRE(histogram.Finalize(lower, bucket_width, counts));
+  REQUIRE(counts.size() == StreamingHistogram::BUCKET_COUNT);
+  idx_t total = 0;
+  for (auto count : counts) {
+    total += count;
+  }
+  REQUIRE(total == added);
+  REQUIRE(lower <= -10000);
+  REQUIRE(lower + bucket_width * StreamingHistogram::BUCKET_COUNT > 50000);
+  REQUIRE(counts.front() >= 1);
+  REQUIRE(counts.back() >= 1);
+}
+
+TEST_CASE("Column profiles count nulls and find min and max", "[ui]") {
+  ColumnProfiler profiler({LogicalType::INTEGER, LogicalType::VARCHAR});
+  DataChunk chunk;
+  chunk.Initialize(Allocator::DefaultAllocator(),
+                   {LogicalType::INTEGER, LogicalType::VARCHAR});
+  for (idx_t i = 0; i < 100; ++i) {
+    chunk.SetValue(0, i,
+                   i % 10 == 0 ? Value(LogicalType::INTEGER)
+                               : Value::INTEGER(static_cast<int32_t>(i)));
+    chunk.SetValue(1, i, Value(i % 2 == 0 ? "even" : "odd"));
+  }
+  chunk.SetCardinality(100);
+  profiler.Update(chunk);
+
+  auto profiles = profiler.Finalize();
+  REQUIRE(profiles.size() == 2);
+
+  auto &integers = profiles[0];
+  REQUIRE(integers.null_count == 10);
+  REQUIRE(integers.distinct_count >= 86);
+  REQUIRE(integers.distinct_count <= 94);
+  REQUIRE(integers.has_min_max);
+  REQUIRE(integers.min == "1");
+  REQUIRE(integers.max == "99");
+  REQUIRE(integers.has_histogram);
+  idx_t histogram_total = 0;
+  for (auto count : integers.histogram_counts) {
+    histogram_total += count;
+  }
+  REQUIRE(histogram_total == 90);
+
+  auto &strings = profiles[1];
+  REQUIRE(strings.null_count == 0);
+  REQUIRE(strings.distinct_count == 2);
+  REQUIRE(strings.min == "even");
+  REQUIRE(strings.max == "odd");
+  REQUIRE(!strings.has_histogram);
+}
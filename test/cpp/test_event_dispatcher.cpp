@@ -0,0 +1,133 @@
+#include "catch.hpp"
+
+#include "event_dispatcher.hpp"
+
+#include <thread>
+
+using namespace duckdb;
+using namespace duckdb::ui;
+
+using std::chrono::milliseconds;
+
+// Sends catalog change events of one instance with its delays.
+struct CatalogChanges {
+  EventDispatcher &dispatcher;
+  std::string instance_id;
+  milliseconds debounce;
+  milliseconds max_delay;
+
+  void Send() {
+    dispatcher.SendCatalogChangedEvent(instance_id, debounce, max_delay);
+  }
+};
+
+// Counts the catalog change events sent for each instance.
+struct CatalogEventCounter {
+  std::mutex mutex;
+  std::map<std::string, idx_t> counts;
+
+  void OnEvent(const std::string &message) {
+    const std::string prefix = "event: CatalogChangeEvent\ndata: ";
+    if (message.compare(0, prefix.size(), prefix) != 0) {
+      return;
+    }
+    auto instance_id = message.substr(prefix.size());
+    instance_id = instance_id.substr(0, instance_id.find('\n'));
+    std::lock_guard<std::mutex> guard(mutex);
+    counts[instance_id]++;
+  }
+
+  idx_t Get(const std::string &instance_id) {
+    std::lock_guard<std::mutex> guard(mutex);
+    return counts[instance_id];
+  }
+};
+
+TEST_CASE("Catalog change events are debounced per instance", "[ui]") {
+  ServerMetrics metrics;
+  EventDispatcher dispatcher(metrics);
+  CatalogEventCounter counter;
+  dispatcher.AddListener(
+      [&](const std::string &message) { counter.OnEvent(message); });
+  CatalogChanges a{dispatcher, "a", milliseconds(200), milliseconds(10000)};
+  CatalogChanges b{dispatcher, "b", milliseconds(200), milliseconds(10000)};
+
+  // The first change is sent at once.
+  a.Send();
+  REQUIRE(counter.Get("a") == 1);
+
+  // Later ones wait for a quiet period.
+  a.Send();
+  a.Send();
+  const auto next_due = dispatcher.FlushCatalogChangedEvents();
+  REQUIRE(counter.Get("a") == 1);
+  REQUIRE(next_due != EventDispatcher::clock::time_point::max());
+  REQUIRE(next_due > EventDispatcher::clock::now());
+
+  // Other instances aren't held back.
+  b.Send();
+  REQUIRE(counter.Get("b") == 1);
+
+  // The dispatcher sends the held back changes as one event once they're
+  // due, without being asked to.
+  std::this_thread::sleep_for(milliseconds(400));
+  REQUIRE(counter.Get("a") == 2);
+  REQUIRE(counter.Get("b") == 1);
+  REQUIRE(dispatcher.FlushCatalogChangedEvents() ==
+          EventDispatcher::clock::time_point::max());
+}
+
+TEST_CASE("Held back catalog change events wait at most the max delay",
+          "[ui]") {
+  ServerMetrics metrics;
+  EventDispatcher dispatcher(metrics);
+  CatalogEventCounter counter;
+  dispatcher.AddListener(
+      [&](const std::string &message) { counter.OnEvent(message); });
+  CatalogChanges a{dispatcher, "a", milliseconds(10000), milliseconds(100)};
+
+  a.Send();
+  a.Send();
+  REQUIRE(counter.Get("a") == 1);
+  std::this_thread::sleep_for(milliseconds(50));
+  a.Send();
+  // Still not quiet for the debounce, but held back for the max delay.
+  std::this_thread::sleep_for(milliseconds(250));
+  REQUIRE(counter.Get("a") == 2);
+}
+
+TEST_CASE("Each instance's catalog events use its own delays", "[ui]") {
+  ServerMetrics metrics;
+  EventDispatcher dispatcher(metrics);
+  CatalogEventCounter counter;
+  dispatcher.AddListener(
+      [&](const std::string &message) { counter.OnEvent(message); });
+  CatalogChanges slow{dispatcher, "slow", milliseconds(10000),
+                      milliseconds(10000)};
+  CatalogChanges fast{dispatcher, "fast", milliseconds(50),
+                      milliseconds(10000)};
+
+  slow.Send();
+  slow.Send();
+  fast.Send();
+  fast.Send();
+  std::this_thread::sleep_for(milliseconds(300));
+  REQUIRE(counter.Get("slow") == 1);
+  REQUIRE(counter.Get("fast") == 2);
+  // "slow" is still held back; stop before the counter goes away.
+  dispatcher.Close();
+}
+
+TEST_CASE("Without a debounce every catalog change is sent", "[ui]") {
+  ServerMetrics metrics;
+  EventDispatcher dispatcher(metrics);
+  CatalogEventCounter counter;
+  dispatcher.AddListener(
+      [&](const std::string &message) { counter.OnEvent(message); });
+  CatalogChanges a{dispatcher, "a", milliseconds(0), milliseconds(0)};
+
+  for (idx_t i = 0; i < 5; ++i) {
+    a.Send();
+  }
+  REQUIRE(counter.Get("a") == 5);
+}
@@ -0,0 +1,65 @@
+#include "catch.hpp"
+
+#include "test_helpers.hpp"
+
+#include <duckdb/common/file_system.hpp>
+
+using namespace duckdb;
+using namespace duckdb::ui;
+
+static const char *const TEMP_DIRECTORY = "ui_export_test.tmp";
+
+static duckdb_httplib_openssl::Result Export(TestServer &server,
+                                             const std::string &sql) {
+  auto headers = server.Headers("export");
+  headers.emplace("X-DuckDB-UI-Export-Format", "csv");
+  return server.Post("/ddb/export", headers, sql);
+}
+
+static idx_t CountExportFiles() {
+  idx_t count = 0;
+  FileSystem::CreateLocal()->ListFiles(
+      TEMP_DIRECTORY, [&](const std::string &name, bool) {
+        if (StringUtil::StartsWith(name, "ui_export_")) {
+          ++count;
+        }
+      });
+  return count;
+}
+
+TEST_CASE("Exports send the result as a file", "[ui]") {
+  TestServer server(14307);
+  server.Query(std::string("SET temp_directory = '") + TEMP_DIRECTORY + "'");
+  server.Start();
+
+  const auto bytes_before = server.Metric("ui_export_bytes_total");
+  auto res = Export(server, "SELECT range AS i FROM range(5) ORDER BY i;");
+  REQUIRE(res);
+  REQUIRE(res->status == 200);
+  REQUIRE(res->body == "i\n0\n1\n2\n3\n4\n");
+  REQUIRE(server.Metric("ui_export_bytes_total") - bytes_before ==
+          static_cast<double>(res->body.size()));
+  FileSystem::CreateLocal()->RemoveDirectory(TEMP_DIRECTORY);
+}
+
+TEST_CASE("Exports over the size limit are stopped", "[ui]") {
+  TestServer server(14307);
+  server.Query(std::string("SET temp_directory = '") + TEMP_DIRECTORY + "'");
+  server.Query("SET ui_max_export_bytes = 1000");
+  server.Start();
+
+  // Past the limit before anything is sent, so the error is the response.
+  auto res = Export(server, "SELECT range AS i FROM range(100000)");
+  REQUIRE(res);
+  REQUIRE(res->status == 200);
+  REQUIRE(res->body.find("The export is larger than 1000 bytes") !=
+          std::string::npos);
+  // The partial file was removed before the error was sent.
+  REQUIRE(CountExportFiles() == 0);
+
+  // Smaller exports still go through.
+  res = Export(server, "SELECT 42 AS answer");
+  REQUIRE(res);
+  REQUIRE(res->body == "answer\n42\n");
+  FileSystem::CreateLocal()->RemoveDirectory(TEMP_DIRECTORY);
+}
@@ -0,0 +1,173 @@
+#include "catch.hpp"
+
+#include "held_result.hpp"
+#include "test_helpers.hpp"
+
+using namespace duckdb;
+using namespace duckdb::ui;
+
+// Rows (i, s): (2, a), (1, b), (2, c), (1, d), (0, e), (NULL, f).
+static unique_ptr<HeldResult> MakeHeldResult(ClientContext &context) {
+  auto held = make_uniq<HeldResult>(
+      context, duckdb::vector<std::string>{"i", "s"},
+      duckdb::vector<LogicalType>{LogicalType::INTEGER, LogicalType::VARCHAR});
+  DataChunk chunk;
+  chunk.Initialize(Allocator::DefaultAllocator(),
+                   {LogicalType::INTEGER, LogicalType::VARCHAR});
+  const int32_t integers[] = {2, 1, 2, 1, 0};
+  const char *strings[] = {"a", "b", "c", "d", "e", "f"};
+  for (idx_t row = 0; row < 6; ++row) {
+    chunk.SetValue(0, row,
+                   row < 5 ? Value::INTEGER(integers[row])
+                           : Value(LogicalType::INTEGER));
+    chunk.SetValue(1, row, Value(strings[row]));
+  }
+  chunk.SetCardinality(6);
+  held->Append(chunk);
+  return held;
+}
+
+static WindowSortKey SortKey(idx_t column, bool descending) {
+  WindowSortKey sort_key;
+  sort_key.column = column;
+  sort_key.descending = descending;
+  return sort_key;
+}
+
+static WindowFilter Filter(idx_t column, WindowFilterOperator op,
+                           const std::string &value = std::string()) {
+  WindowFilter filter;
+  filter.column = column;
+  filter.op = op;
+  filter.value = value;
+  return filter;
+}
+
+// The `s` column of the window, concatenated.
+static std::string FetchLetters(HeldResult &held, const WindowSpec &spec,
+                                idx_t offset = 0, idx_t limit = 100) {
+  SuccessResult result;
+  held.FetchWindow(spec, offset, limit, result);
+  std::string letters;
+  for (auto &chunk : result.chunks) {
+    for (idx_t row = 0; row < chunk.row_count; ++row) {
+      letters += chunk.vectors[1].GetValue(row).ToString();
+    }
+  }
+  return letters;
+}
+
+TEST_CASE("Held results sort stably with nulls last", "[ui]") {
+  DuckDB db(nullptr);
+  Connection con(db);
+  auto held = MakeHeldResult(*con.context);
+  REQUIRE(held->GetRowCount() == 6);
+
+  WindowSpec identity;
+  REQUIRE(FetchLetters(*held, identity) == "abcdef");
+
+  WindowSpec ascending;
+  ascending.sort_keys.push_back(SortKey(0, false));
+  REQUIRE(FetchLetters(*held, ascending) == "ebdacf");
+
+  WindowSpec descending;
+  descending.sort_keys.push_back(SortKey(0, true));
+  REQUIRE(FetchLetters(*held, descending) == "acbdef");
+
+  WindowSpec two_keys;
+  two_keys.sort_keys.push_back(SortKey(0, false));
+  two_keys.sort_keys.push_back(SortKey(1, true));
+  REQUIRE(FetchLetters(*held, two_keys) == "edbcaf");
+}
+
+TEST_CASE("Held results filter before sorting", "[ui]") {
+  DuckDB db(nullptr);
+  Connection con(db);
+  auto held = MakeHeldResult(*con.context);
+
+  WindowSpec spec;
+  spec.filters.push_back(Filter(0, WindowFilterOperator::NOT_EQUAL, "0"));
+  // NULL never matches a comparison.
+  REQUIRE(FetchLetters(*held, spec) == "abcd");
+
+  spec.sort_keys.push_back(SortKey(0, true));
+  REQUIRE(FetchLetters(*held, spec) == "acbd");
+
+  // Filters are combined with AND.
+  spec.filters.push_back(Filter(1, WindowFilterOperator::CONTAINS, "C"));
+  REQUIRE(FetchLetters(*held, spec) == "c");
+
+  WindowSpec nulls;
+  nulls.filters.push_back(Filter(0, ParseWindowFilterOperator("is_null")));
+  REQUIRE(FetchLetters(*held, nulls) == "f");
+
+  WindowSpec at_least_one;
+  at_least_one.filters.push_back(
+      Filter(0, ParseWindowFilterOperator(">="), "1"));
+  REQUIRE(FetchLetters(*held, at_least_one) == "abcd");
+}
+
+TEST_CASE("Held result windows are slices of the view", "[ui]") {
+  DuckDB db(nullptr);
+  Connection con(db);
+  auto held = MakeHeldResult(*con.context);
+
+  WindowSpec spec;
+  spec.sort_keys.push_back(SortKey(0, false));
+  SuccessResult result;
+  held->FetchWindow(spec, 1, 2, result);
+  REQUIRE(result.total_row_count.GetIndex() == 6);
+  REQUIRE(FetchLetters(*held, spec, 1, 2) == "bd");
+  // The cached view gives the same rows.
+  REQUIRE(FetchLetters(*held, spec, 1, 2) == "bd");
+  REQUIRE(FetchLetters(*held, spec, 5, 10) == "f");
+  REQUIRE(FetchLetters(*held, spec, 10, 10).empty());
+
+  WindowSpec invalid;
+  invalid.sort_keys.push_back(SortKey(2, false));
+  REQUIRE_THROWS(FetchLetters(*held, invalid));
+}
+
+TEST_CASE("Held result windows cross chunks of any size", "[ui]") {
+  DuckDB db(nullptr);
+  Connection con(db);
+  auto held = make_uniq<HeldResult>(
+      *con.context, duckdb::vector<std::string>{"i"},
+      duckdb::vector<LogicalType>{LogicalType::INTEGER});
+  // Appended in chunks of uneven sizes: 0, 1, ..., 9999.
+  const idx_t row_count = 10000;
+  DataChunk chunk;
+  for (idx_t start = 0; start < row_count;) {
+    const auto count = MinValue<idx_t>(1 + start % 1500, row_count - start);
+    FillIntegerChunk(chunk, static_cast<int32_t>(start), count);
+    held->Append(chunk);
+    start += count;
+  }
+
+  WindowSpec descending;
+  descending.sort_keys.push_back(SortKey(0, true));
+  // Filtered too, though every row passes.
+  WindowSpec filtered;
+  filtered.filters.push_back(
+      Filter(0, WindowFilterOperator::GREATER_THAN, "-1"));
+  filtered.sort_keys.push_back(SortKey(0, true));
+
+  // Windows starting inside a chunk and spanning several.
+  for (auto &spec : {descending, filtered}) {
+    for (idx_t offset : {0, 2000, 2047, 2048, 4095, 9000}) {
+      SuccessResult result;
+      held->FetchWindow(spec, offset, 3000, result);
+      REQUIRE(result.total_row_count.GetIndex() == row_count);
+      int64_t expected = static_cast<int64_t>(row_count - 1 - offset);
+      idx_t fetched = 0;
+      for (auto &result_chunk : result.chunks) {
+        for (idx_t row = 0; row < result_chunk.row_count; ++row) {
+          REQUIRE(result_chunk.vectors[0].GetValue(row).GetValue<int64_t>() ==
+                  expected--);
+          ++fetched;
+        }
+      }
+      REQUIRE(fetched == MinValue<idx_t>(3000, row_count - offset));
+    }
+  }
+}
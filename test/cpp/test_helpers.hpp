@@ -0,0 +1,87 @@
+#pragma once
+
+#include <duckdb.hpp>
+
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#include "httplib.hpp"
+
+#include "ui_extension.hpp"
+
+#include <string>
+
+namespace duckdb {
+namespace ui {
+
+// A chunk with one INTEGER column holding `count` values from `start`.
+inline void FillIntegerChunk(DataChunk &chunk, int32_t start, idx_t count) {
+  chunk.Destroy();
+  chunk.Initialize(Allocator::DefaultAllocator(), {LogicalType::INTEGER},
+                   MaxValue<idx_t>(count, STANDARD_VECTOR_SIZE));
+  auto data = FlatVector::GetData<int32_t>(chunk.data[0]);
+  for (idx_t i = 0; i < count; ++i) {
+    data[i] = start + static_cast<int32_t>(i);
+  }
+  chunk.SetCardinality(count);
+}
+
+// Runs the UI server in-process on a local port for the lifetime of the
+// object. Only one can exist at a time.
+class TestServer {
+public:
+  explicit TestServer(uint16_t port) : port(port), db(nullptr), con(db) {
+    db.LoadStaticExtension<UiExtension>();
+    Query(StringUtil::Format("SET ui_local_port = %d", port));
+  }
+
+  ~TestServer() { con.Query("CALL stop_ui_server()"); }
+
+  // Settings such as `ui_websocket_port` are read when the server starts.
+  void Start() { Query("CALL start_ui_server()"); }
+
+  void Query(const std::string &sql) {
+    auto result = con.Query(sql);
+    if (result->HasError()) {
+      result->ThrowError();
+    }
+  }
+
+  std::string Url() const {
+    return StringUtil::Format("http://localhost:%d", port);
+  }
+
+  // The headers the UI sends with a run on `connection_name`.
+  duckdb_httplib_openssl::Headers
+  Headers(const std::string &connection_name) const {
+    return {{"Origin", Url()},
+            {"X-DuckDB-UI-Connection-Name", connection_name}};
+  }
+
+  duckdb_httplib_openssl::Result Post(const std::string &path,
+                                      duckdb_httplib_openssl::Headers headers,
+                                      const std::string &body) {
+    duckdb_httplib_openssl::Client client("localhost", port);
+    return client.Post(path, headers, body, "text/plain");
+  }
+
+  // The value of the metric `name` from /metrics.
+  double Metric(const std::string &name) {
+    duckdb_httplib_openssl::Client client("localhost", port);
+    auto res = client.Get("/metrics", {{"Referer", Url() + "/"}});
+    if (!res || res->status != 200) {
+      throw InternalException("Could not read /metrics");
+    }
+    for (auto &line : StringUtil::Split(res->body, '\n')) {
+      if (StringUtil::StartsWith(line, name + " ")) {
+        return std::stod(line.substr(name.size() + 1));
+      }
+    }
+    throw InternalException("No metric named %s", name);
+  }
+
+  uint16_t port;
+  DuckDB db;
+  Connection con;
+};
+
+} // namespace ui
+} // namespace duckdb
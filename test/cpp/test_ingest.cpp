@@ -0,0 +1,89 @@
+#include "catch.hpp"
+
+#include "test_helpers.hpp"
+
+#include <duckdb/common/file_system.hpp>
+
+using namespace duckdb;
+using namespace duckdb::ui;
+
+static const char *const TEMP_DIRECTORY = "ui_ingest_test.tmp";
+
+static bool Contains(const std::string &body, const std::string &text) {
+  return body.find(text) != std::string::npos;
+}
+
+// The headers of an upload of CSV into the new table `t`.
+static duckdb_httplib_openssl::Headers IngestHeaders(TestServer &server) {
+  auto headers = server.Headers("ingest");
+  headers.emplace("X-DuckDB-UI-Ingest-Format", "csv");
+  headers.emplace("X-DuckDB-UI-Ingest-Table-Name", "dA=="); // "t"
+  return headers;
+}
+
+static std::string MakeCsv(idx_t row_count) {
+  std::string csv = "i,s\n";
+  for (idx_t i = 0; i < row_count; ++i) {
+    csv += std::to_string(i) + ",row " + std::to_string(i) + "\n";
+  }
+  return csv;
+}
+
+TEST_CASE("Uploads are loaded into a table", "[ui]") {
+  TestServer server(14306);
+  server.Query(std::string("SET temp_directory = '") + TEMP_DIRECTORY + "'");
+  server.Start();
+
+  const auto csv = MakeCsv(1000);
+  const auto bytes_before = server.Metric("ui_ingest_bytes_total");
+  auto res = server.Post("/ddb/ingest", IngestHeaders(server), csv);
+  REQUIRE(res);
+  REQUIRE(res->status == 200);
+  auto count = server.con.Query("SELECT count(*) FROM t");
+  REQUIRE(!count->HasError());
+  REQUIRE(count->GetValue(0, 0).GetValue<int64_t>() == 1000);
+
+  // Throughput is the bytes over the time spent on them.
+  REQUIRE(server.Metric("ui_ingest_bytes_total") - bytes_before ==
+          static_cast<double>(csv.size()));
+  REQUIRE(server.Metric("ui_ingest_upload_seconds_total") >= 0);
+  REQUIRE(server.Metric("ui_ingest_load_seconds_total") > 0);
+  FileSystem::CreateLocal()->RemoveDirectory(TEMP_DIRECTORY);
+}
+
+TEST_CASE("Uploads over the size limit are refused", "[ui]") {
+  TestServer server(14306);
+  server.Query(std::string("SET temp_directory = '") + TEMP_DIRECTORY + "'");
+  server.Query("SET ui_max_ingest_bytes = 1000");
+  server.Start();
+  const auto csv = MakeCsv(1000);
+
+  SECTION("with a length") {
+    auto res = server.Post("/ddb/ingest", IngestHeaders(server), csv);
+    REQUIRE(res);
+    REQUIRE(res->status == 200);
+    REQUIRE(Contains(res->body, "The upload is larger than 1000 bytes"));
+  }
+
+  SECTION("in chunks") {
+    duckdb_httplib_openssl::Client client("localhost", server.port);
+    auto res = client.Post(
+        "/ddb/ingest", IngestHeaders(server),
+        [&](size_t offset, duckdb_httplib_openssl::DataSink &sink) {
+          if (offset == csv.size()) {
+            sink.done();
+            return true;
+          }
+          const auto size = MinValue<size_t>(300, csv.size() - offset);
+          return sink.write(csv.data() + offset, size);
+        },
+        "text/csv");
+    // The status is httplib's: the body wasn't read to its end.
+    REQUIRE(res);
+    REQUIRE(Contains(res->body, "The upload is larger than 1000 bytes"));
+  }
+
+  // Nothing was loaded.
+  REQUIRE(server.con.Query("SELECT * FROM t")->HasError());
+  FileSystem::CreateLocal()->RemoveDirectory(TEMP_DIRECTORY);
+}
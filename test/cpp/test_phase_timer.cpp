@@ -0,0 +1,56 @@
+#include "catch.hpp"
+
+#include "utils/phase_timer.hpp"
+
+#include <thread>
+
+using namespace duckdb;
+using namespace duckdb::ui;
+
+using std::chrono::milliseconds;
+
+TEST_CASE("Phase timer sums the time of each phase", "[ui]") {
+  PhaseTimer timer;
+  timer.Enter(RunPhase::FETCH);
+  std::this_thread::sleep_for(milliseconds(20));
+  timer.Enter(RunPhase::APPEND);
+  std::this_thread::sleep_for(milliseconds(20));
+  // Fetching and appending alternate; both are summed.
+  timer.Enter(RunPhase::FETCH);
+  std::this_thread::sleep_for(milliseconds(20));
+  timer.Stop();
+
+  REQUIRE(timer.ElapsedMs(RunPhase::FETCH) >= 40);
+  REQUIRE(timer.ElapsedMs(RunPhase::APPEND) >= 20);
+  REQUIRE(timer.ElapsedMs(RunPhase::EXECUTE) == 0);
+  REQUIRE(timer.TotalMs() >= timer.ElapsedMs(RunPhase::FETCH) +
+                                 timer.ElapsedMs(RunPhase::APPEND));
+
+  // Stopped: the total no longer grows.
+  const auto total = timer.TotalMs();
+  std::this_thread::sleep_for(milliseconds(10));
+  REQUIRE(timer.TotalMs() == total);
+}
+
+TEST_CASE("Server-Timing header lists the entered phases in order", "[ui]") {
+  PhaseTimer timer;
+  timer.Enter(RunPhase::EXECUTE);
+  timer.Enter(RunPhase::PARSE);
+  timer.Stop();
+
+  const auto header = timer.ServerTimingHeader();
+  const auto parse = header.find("parse;dur=");
+  const auto execute = header.find("execute;dur=");
+  const auto total = header.find("total;dur=");
+  REQUIRE(parse == 0);
+  REQUIRE(execute != std::string::npos);
+  REQUIRE(total != std::string::npos);
+  REQUIRE(parse < execute);
+  REQUIRE(execute < total);
+  REQUIRE(header.find("fetch") == std::string::npos);
+  REQUIRE(header.find("decode") == std::string::npos);
+
+  PhaseTimer empty;
+  empty.Stop();
+  REQUIRE(empty.ServerTimingHeader().compare(0, 10, "total;dur=") == 0);
+}
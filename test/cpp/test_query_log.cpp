@@ -0,0 +1,128 @@
+#include "catch.hpp"
+
+#include "query_log.hpp"
+#include "state.hpp"
+#include "ui_extension.hpp"
+
+#include <duckdb/common/types/timestamp.hpp>
+
+using namespace duckdb;
+using namespace duckdb::ui;
+
+static QueryLogRecord MakeRecord(const std::string &connection_name,
+                                 idx_t row_count,
+                                 const std::string &error = std::string()) {
+  QueryLogRecord record;
+  record.start_time = Timestamp::GetCurrentTimestamp();
+  record.connection_name = connection_name;
+  record.sql_hash = 42;
+  record.phase_ms.fill(0);
+  record.phase_ms[static_cast<idx_t>(RunPhase::EXECUTE)] = 1.5;
+  record.total_ms = 2;
+  record.row_count = row_count;
+  record.byte_count = 100;
+  record.error = error;
+  return record;
+}
+
+TEST_CASE("Query log keeps the most recent records in order", "[ui]") {
+  QueryLog log;
+  REQUIRE(!log.IsEnabled());
+  log.Append(MakeRecord("ignored", 0));
+  REQUIRE(log.Snapshot().empty());
+
+  log.SetCapacity(3);
+  for (idx_t i = 0; i < 5; ++i) {
+    log.Append(MakeRecord("c", i));
+  }
+  auto records = log.Snapshot();
+  REQUIRE(records.size() == 3);
+  REQUIRE(records[0].row_count == 2);
+  REQUIRE(records[1].row_count == 3);
+  REQUIRE(records[2].row_count == 4);
+
+  // Shrinking keeps the newest.
+  log.SetCapacity(2);
+  records = log.Snapshot();
+  REQUIRE(records.size() == 2);
+  REQUIRE(records[0].row_count == 3);
+  REQUIRE(records[1].row_count == 4);
+}
+
+TEST_CASE("Query log asks for a flush once enough records are queued",
+          "[ui]") {
+  QueryLog log;
+  log.SetCapacity(4);
+  // Nothing is queued without a table.
+  for (idx_t i = 0; i < 8; ++i) {
+    REQUIRE(!log.Append(MakeRecord("c", i)));
+  }
+  log.SetTableName("log");
+  REQUIRE(!log.Append(MakeRecord("c", 0)));
+  REQUIRE(!log.Append(MakeRecord("c", 1)));
+  REQUIRE(!log.Append(MakeRecord("c", 2)));
+  REQUIRE(log.Append(MakeRecord("c", 3)));
+}
+
+TEST_CASE("Query log flushes its columns to the log table", "[ui]") {
+  DuckDB db(nullptr);
+  Connection con(db);
+  QueryLog log;
+  log.SetCapacity(10);
+  log.SetTableName("ui_log");
+  log.Append(MakeRecord("first", 10));
+  log.Append(MakeRecord("second", 0, "boom"));
+  log.Flush(con);
+
+  const duckdb::vector<std::string> expected_columns = {
+      "start_time", "connection_name", "description", "sql_hash",
+      "decode_ms",  "parse_ms",        "prepare_ms",  "execute_ms",
+      "fetch_ms",   "append_ms",       "profile_ms",  "serialize_ms",
+      "total_ms",   "row_count",       "byte_count",  "error"};
+  auto columns = con.Query("SELECT * FROM _duckdb_ui.ui_log LIMIT 0");
+  REQUIRE(!columns->HasError());
+  REQUIRE(columns->names == expected_columns);
+  // Nothing is created in the user's own schema.
+  REQUIRE(con.Query("SELECT * FROM main.ui_log")->HasError());
+
+  auto rows = con.Query("SELECT connection_name, execute_ms, row_count, error "
+                        "FROM _duckdb_ui.ui_log ORDER BY connection_name");
+  REQUIRE(!rows->HasError());
+  REQUIRE(rows->RowCount() == 2);
+  REQUIRE(rows->GetValue(0, 0).ToString() == "first");
+  REQUIRE(rows->GetValue(1, 0).GetValue<double>() == 1.5);
+  REQUIRE(rows->GetValue(2, 0).GetValue<uint64_t>() == 10);
+  REQUIRE(rows->GetValue(3, 0).IsNull());
+  REQUIRE(rows->GetValue(3, 1).ToString() == "boom");
+
+  // Flushed records aren't written again.
+  log.Flush(con);
+  auto count = con.Query("SELECT count(*) FROM _duckdb_ui.ui_log");
+  REQUIRE(count->GetValue(0, 0).GetValue<int64_t>() == 2);
+}
+
+TEST_CASE("ui_query_log() returns the logged records", "[ui]") {
+  DuckDB db(nullptr);
+  db.LoadStaticExtension<UiExtension>();
+  Connection con(db);
+  REQUIRE(!con.Query("SET ui_query_log_size = 10")->HasError());
+  auto &log = UIStorageExtensionInfo::GetState(*db.instance).GetQueryLog();
+  log.Append(MakeRecord("first", 10));
+  log.Append(MakeRecord("second", 0, "boom"));
+
+  auto rows = con.Query("SELECT connection_name, description, sql_hash, "
+                        "execute_ms, total_ms, row_count, byte_count, error "
+                        "FROM ui_query_log()");
+  REQUIRE(!rows->HasError());
+  REQUIRE(rows->RowCount() == 2);
+  REQUIRE(rows->GetValue(0, 0).ToString() == "first");
+  REQUIRE(rows->GetValue(1, 0).IsNull());
+  REQUIRE(rows->GetValue(2, 0).GetValue<uint64_t>() == 42);
+  REQUIRE(rows->GetValue(3, 0).GetValue<double>() == 1.5);
+  REQUIRE(rows->GetValue(4, 0).GetValue<double>() == 2);
+  REQUIRE(rows->GetValue(5, 0).GetValue<uint64_t>() == 10);
+  REQUIRE(rows->GetValue(6, 0).GetValue<uint64_t>() == 100);
+  REQUIRE(rows->GetValue(7, 0).IsNull());
+  REQUIRE(rows->GetValue(0, 1).ToString() == "second");
+  REQUIRE(rows->GetValue(7, 1).ToString() == "boom");
+}
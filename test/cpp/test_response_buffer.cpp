@@ -0,0 +1,83 @@
+#include "catch.hpp"
+
+#include "response_buffer.hpp"
+
+#include <duckdb/common/file_system.hpp>
+
+using namespace duckdb;
+using namespace duckdb::ui;
+
+static const char *const TEMP_DIRECTORY = "ui_response_buffer_test.tmp";
+
+// Bytes that differ from one offset to the next.
+static std::string MakeBytes(idx_t size) {
+  std::string bytes(size, '\0');
+  for (idx_t i = 0; i < size; ++i) {
+    bytes[i] = static_cast<char>(i * 31 % 251);
+  }
+  return bytes;
+}
+
+// Writes `bytes` in pieces of uneven sizes, then reads them all back,
+// between `head` and `tail`, in pieces of another size.
+static std::string WriteAndRead(ResponseBuffer &buffer,
+                                const std::string &bytes,
+                                const std::string &head,
+                                const std::string &tail) {
+  for (idx_t offset = 0; offset < bytes.size();) {
+    const auto size =
+        MinValue<idx_t>(1000 + offset % 7919, bytes.size() - offset);
+    buffer.WriteData(reinterpret_cast<const_data_ptr_t>(bytes.data()) + offset,
+                     size);
+    offset += size;
+  }
+  buffer.SetHeadAndTail(head, tail);
+  buffer.Finish();
+
+  std::string read(buffer.GetSize(), '\0');
+  for (idx_t offset = 0; offset < read.size();) {
+    const auto size = MinValue<idx_t>(65536, read.size() - offset);
+    buffer.Read(offset, reinterpret_cast<data_ptr_t>(&read[offset]), size);
+    offset += size;
+  }
+  return read;
+}
+
+static idx_t CountResponseFiles(FileSystem &fs) {
+  idx_t count = 0;
+  fs.ListFiles(TEMP_DIRECTORY, [&](const std::string &name, bool) {
+    if (StringUtil::StartsWith(name, "ui_response_")) {
+      ++count;
+    }
+  });
+  return count;
+}
+
+TEST_CASE("Response buffers within their budget stay in memory", "[ui]") {
+  DuckDB db(nullptr);
+  const auto bytes = MakeBytes(600 * 1024);
+  ResponseBuffer buffer(db.instance, 1024 * 1024);
+  REQUIRE(WriteAndRead(buffer, bytes, "head", "tail") ==
+          "head" + bytes + "tail");
+  REQUIRE(!buffer.IsSpilled());
+}
+
+TEST_CASE("Response buffers over their budget spill to a file", "[ui]") {
+  DuckDB db(nullptr);
+  Connection con(db);
+  REQUIRE(!con.Query(std::string("SET temp_directory = '") + TEMP_DIRECTORY +
+                     "'")
+               ->HasError());
+  auto &fs = FileSystem::GetFileSystem(*db.instance);
+
+  const auto bytes = MakeBytes(2 * 1024 * 1024 + 12345);
+  {
+    ResponseBuffer buffer(db.instance, 512 * 1024);
+    REQUIRE(WriteAndRead(buffer, bytes, "", "the end") == bytes + "the end");
+    REQUIRE(buffer.IsSpilled());
+    REQUIRE(CountResponseFiles(fs) == 1);
+  }
+  // The file is removed with the buffer.
+  REQUIRE(CountResponseFiles(fs) == 0);
+  fs.RemoveDirectory(TEMP_DIRECTORY);
+}
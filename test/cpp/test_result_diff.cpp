@@ -0,0 +1,158 @@
+#include "catch.hpp"
+
+#include "result_diff.hpp"
+#include "test_helpers.hpp"
+
+#include <duckdb/common/serializer/binary_serializer.hpp>
+#include <duckdb/common/serializer/memory_stream.hpp>
+
+using namespace duckdb;
+using namespace duckdb::ui;
+
+static Chunk MakeIntegerChunk(int32_t start, idx_t count) {
+  DataChunk chunk;
+  FillIntegerChunk(chunk, start, count);
+  return Chunk{static_cast<uint16_t>(count), std::move(chunk.data)};
+}
+
+// A chunk with one row holding `value`.
+static Chunk MakeValueChunk(const Value &value) {
+  Vector vector(value.type(), 1);
+  vector.SetValue(0, value);
+  duckdb::vector<Vector> vectors;
+  vectors.push_back(std::move(vector));
+  return Chunk{1, std::move(vectors)};
+}
+
+static Chunk MakeDoubleChunk(double value) {
+  return MakeValueChunk(Value::DOUBLE(value));
+}
+
+TEST_CASE("Result diff references chunks the client has", "[ui]") {
+  ResultDiffCache cache;
+  const std::string key = "connection\nresult";
+
+  auto first = cache.Begin(key, optional_idx());
+  REQUIRE(first.AddChunk(MakeIntegerChunk(0, 100)) == 0);
+  REQUIRE(first.AddChunk(MakeIntegerChunk(100, 100)) == 0);
+  const auto version = cache.Finish(key, first);
+  // Fits in a JavaScript number.
+  REQUIRE(version < (uint64_t(1) << 53));
+
+  // A chunk was inserted in front; the others moved.
+  auto second = cache.Begin(key, version);
+  REQUIRE(second.AddChunk(MakeIntegerChunk(-100, 100)) == 0);
+  REQUIRE(second.AddChunk(MakeIntegerChunk(0, 100)) == 1);
+  REQUIRE(second.AddChunk(MakeIntegerChunk(100, 100)) == 2);
+  REQUIRE(second.GetReferenceCount() == 2);
+  const auto second_version = cache.Finish(key, second);
+  REQUIRE(second_version != version);
+
+  // The client missed the second response.
+  auto stale = cache.Begin(key, version);
+  REQUIRE(stale.AddChunk(MakeIntegerChunk(0, 100)) == 0);
+  REQUIRE(stale.GetReferenceCount() == 0);
+
+  auto other_key = cache.Begin("connection\nother", second_version);
+  REQUIRE(other_key.AddChunk(MakeIntegerChunk(0, 100)) == 0);
+}
+
+TEST_CASE("Result diff tells apart values that hash the same", "[ui]") {
+  // DuckDB's value hash treats 0.0 and -0.0 as equal.
+  REQUIRE(HashChunk(MakeDoubleChunk(0.0)) == HashChunk(MakeDoubleChunk(-0.0)));
+  REQUIRE(HashChunkFloatBits(MakeDoubleChunk(0.0)) !=
+          HashChunkFloatBits(MakeDoubleChunk(-0.0)));
+  // Also when nested.
+  auto list = [](double value) {
+    return MakeValueChunk(
+        Value::LIST({Value::DOUBLE(1), Value::DOUBLE(value)}));
+  };
+  REQUIRE(HashChunkFloatBits(list(0.0)) != HashChunkFloatBits(list(-0.0)));
+  // Columns without floating point values don't count.
+  REQUIRE(HashChunkFloatBits(MakeIntegerChunk(0, 100)) ==
+          HashChunkFloatBits(MakeIntegerChunk(100, 100)));
+
+  ResultDiffCache cache;
+  const std::string key = "connection\nresult";
+  auto first = cache.Begin(key, optional_idx());
+  first.AddChunk(MakeDoubleChunk(0.0));
+  first.AddChunk(list(0.0));
+  const auto version = cache.Finish(key, first);
+
+  auto second = cache.Begin(key, version);
+  REQUIRE(second.AddChunk(MakeDoubleChunk(-0.0)) == 0);
+  REQUIRE(second.AddChunk(list(-0.0)) == 0);
+  REQUIRE(second.AddChunk(MakeDoubleChunk(0.0)) == 1);
+  REQUIRE(second.AddChunk(list(0.0)) == 2);
+}
+
+static const idx_t CHUNK_COUNT = 20;
+
+static SuccessResult MakeResult(uint64_t version) {
+  SuccessResult result;
+  result.column_names_and_types.names.push_back("i");
+  result.column_names_and_types.types.push_back(LogicalType::INTEGER);
+  result.result_version = version;
+  return result;
+}
+
+static std::string ToString(MemoryStream &stream) {
+  return std::string(reinterpret_cast<const char *>(stream.GetData()),
+                     stream.GetPosition());
+}
+
+// Serializes the same chunks with a ChunkSerializer, compared with the
+// client's result at `client_version`. Sets `version` to the new one.
+static std::string Run(ClientContext &context, ResultDiffCache &cache,
+                       optional_idx client_version, uint64_t &version) {
+  const std::string key = "connection\nresult";
+  auto diff = cache.Begin(key, client_version);
+  MemoryStream chunk_stream;
+  ChunkSerializer serializer(context, chunk_stream);
+  serializer.SetReferenceFunction(
+      [&](const Chunk &chunk) { return diff.AddChunk(chunk); });
+  duckdb::vector<Chunk> chunks;
+  for (idx_t i = 0; i < CHUNK_COUNT; ++i) {
+    chunks.push_back(MakeIntegerChunk(static_cast<int32_t>(i * 100), 100));
+  }
+  serializer.Append(chunks);
+  serializer.Flush();
+  version = cache.Finish(key, diff);
+
+  auto result = MakeResult(version);
+  std::string head;
+  std::string tail;
+  serializer.SerializeResult(result, head, tail);
+  return head + ToString(chunk_stream) + tail;
+}
+
+TEST_CASE("A re-run sends references to the chunks the client has", "[ui]") {
+  DuckDB db(nullptr);
+  Connection con(db);
+  ResultDiffCache cache;
+
+  uint64_t first_version;
+  const auto first = Run(*con.context, cache, optional_idx(), first_version);
+  auto expected_first = MakeResult(first_version);
+  for (idx_t i = 0; i < CHUNK_COUNT; ++i) {
+    expected_first.chunks.push_back(
+        MakeIntegerChunk(static_cast<int32_t>(i * 100), 100));
+  }
+  MemoryStream expected_first_stream;
+  BinarySerializer::Serialize(expected_first, expected_first_stream);
+  REQUIRE(first == ToString(expected_first_stream));
+
+  // Every chunk is a reference, and only its row count is sent.
+  uint64_t second_version;
+  const auto second = Run(*con.context, cache, first_version, second_version);
+  REQUIRE(second_version == first_version);
+  auto expected_second = MakeResult(second_version);
+  for (idx_t i = 0; i < CHUNK_COUNT; ++i) {
+    expected_second.chunks.push_back(Chunk{100, {}});
+    expected_second.chunk_references.push_back(i + 1);
+  }
+  MemoryStream expected_second_stream;
+  BinarySerializer::Serialize(expected_second, expected_second_stream);
+  REQUIRE(second == ToString(expected_second_stream));
+  REQUIRE(second.size() < first.size() / 10);
+}
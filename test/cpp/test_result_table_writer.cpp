@@ -0,0 +1,71 @@
+#include "catch.hpp"
+
+#include "result_table_writer.hpp"
+#include "utils/helpers.hpp"
+
+#include <duckdb/main/appender.hpp>
+
+using namespace duckdb;
+using namespace duckdb::ui;
+
+// A writer filling `table` from the rest of `sql`'s result. The row count is
+// set once it's done, or to -1 on error; Catch assertions aren't safe on
+// the pool's thread.
+static unique_ptr<ResultTableWriter>
+MakeWriter(DuckDB &db, ResultTableWriterPool &pool, const std::string &table,
+           const std::string &sql, int64_t &row_count) {
+  auto user_connection = make_shared_ptr<Connection>(db);
+  auto appender_connection = make_uniq<Connection>(db);
+  REQUIRE(!appender_connection
+               ->Query("CREATE TABLE " + table + " (i BIGINT)")
+               ->HasError());
+  auto appender =
+      make_uniq<Appender>(*appender_connection, AsCatalogIdentifier(table));
+  auto writer = make_uniq<ResultTableWriter>(
+      pool, user_connection, std::move(appender_connection),
+      std::move(appender), 1000000,
+      [&row_count](idx_t rows, const std::string &error) {
+        row_count = error.empty() ? static_cast<int64_t>(rows) : -1;
+      });
+  writer->Finish(user_connection->SendQuery(sql));
+  return writer;
+}
+
+TEST_CASE("Result table writers share the pool's threads", "[ui]") {
+  DuckDB db(nullptr);
+  ResultTableWriterPool pool;
+  pool.Start(1);
+
+  // The second writer waits for the first on the only thread.
+  int64_t first_rows = 0;
+  int64_t second_rows = 0;
+  auto first = MakeWriter(db, pool, "t1", "SELECT * FROM range(5000)",
+                          first_rows);
+  auto second = MakeWriter(db, pool, "t2", "SELECT * FROM range(3000)",
+                           second_rows);
+  second->Wait();
+  first->Wait();
+  REQUIRE(first->IsDone());
+  REQUIRE(first_rows == 5000);
+  REQUIRE(second_rows == 3000);
+
+  Connection con(db);
+  auto count = con.Query("SELECT (SELECT count(*) FROM t1), "
+                         "(SELECT count(*) FROM t2)");
+  REQUIRE(count->GetValue(0, 0).GetValue<int64_t>() == 5000);
+  REQUIRE(count->GetValue(1, 0).GetValue<int64_t>() == 3000);
+
+  pool.Stop();
+}
+
+TEST_CASE("Stopping the pool runs the queued writers", "[ui]") {
+  DuckDB db(nullptr);
+  ResultTableWriterPool pool;
+  pool.Start(1);
+  int64_t row_count = 0;
+  auto writer =
+      MakeWriter(db, pool, "t", "SELECT * FROM range(100)", row_count);
+  pool.Stop();
+  REQUIRE(writer->IsDone());
+  REQUIRE(row_count == 100);
+}
@@ -0,0 +1,56 @@
+#include "catch.hpp"
+
+#include "test_helpers.hpp"
+
+using namespace duckdb;
+using namespace duckdb::ui;
+
+// Runs `sql` returning at most `row_limit` rows. Returns the response body,
+// and sets `rows_fetched` to the rows the server fetched from the result.
+static std::string RunWithRowLimit(TestServer &server, const std::string &sql,
+                                   int row_limit, double &rows_fetched) {
+  const auto before = server.Metric("ui_rows_fetched_total");
+  auto headers = server.Headers("row_limit");
+  headers.emplace("X-DuckDB-UI-Result-Row-Limit", std::to_string(row_limit));
+  auto res = server.Post("/ddb/run", headers, sql);
+  REQUIRE(res);
+  REQUIRE(res->status == 200);
+  rows_fetched = server.Metric("ui_rows_fetched_total") - before;
+  return res->body;
+}
+
+TEST_CASE("Row limits are pushed into the plan of plain queries", "[ui]") {
+  TestServer server(14302);
+  server.Start();
+
+  const std::string sql = "SELECT range FROM range(100000) ORDER BY range DESC";
+  double pushed_rows = 0;
+  const auto pushed = RunWithRowLimit(server, sql, 10, pushed_rows);
+  // The query itself stops after the limit: no whole chunk is fetched.
+  REQUIRE(pushed_rows == 10);
+
+  server.Query("SET ui_push_row_limits = false");
+  double fetched_rows = 0;
+  const auto fetched = RunWithRowLimit(server, sql, 10, fetched_rows);
+  REQUIRE(fetched_rows > 10);
+  // Either way, the client gets the same rows.
+  REQUIRE(pushed == fetched);
+}
+
+TEST_CASE("A query's own LIMIT is kept", "[ui]") {
+  TestServer server(14302);
+  server.Start();
+
+  double rows_fetched = 0;
+  RunWithRowLimit(server,
+                  "SELECT range FROM range(100000) ORDER BY range LIMIT 5", 10,
+                  rows_fetched);
+  REQUIRE(rows_fetched == 5);
+
+  // A LIMIT larger than the row limit still runs; only the row limit's worth
+  // is returned.
+  RunWithRowLimit(server,
+                  "SELECT range FROM range(100000) ORDER BY range LIMIT 50000",
+                  10, rows_fetched);
+  REQUIRE(rows_fetched > 10);
+}
@@ -0,0 +1,40 @@
+#include "catch.hpp"
+
+#include "test_helpers.hpp"
+
+using namespace duckdb;
+using namespace duckdb::ui;
+
+static bool Contains(const std::string &body, const std::string &text) {
+  return body.find(text) != std::string::npos;
+}
+
+TEST_CASE("Script runs refuse parameters", "[ui]") {
+  TestServer server(14301);
+  server.Start();
+
+  auto headers = server.Headers("script");
+  headers.emplace("X-DuckDB-UI-Run-Mode", "script");
+  headers.emplace("X-DuckDB-UI-Parameter-Count", "1");
+  headers.emplace("X-DuckDB-UI-Parameter-Value-0", "NDI="); // "42"
+  auto res = server.Post("/ddb/run", headers,
+                         "CREATE TABLE t AS SELECT ?::INTEGER AS i; "
+                         "SELECT * FROM t;");
+  REQUIRE(res);
+  REQUIRE(res->status == 200);
+  REQUIRE(Contains(res->body, "Parameters are not supported in script mode"));
+  // Nothing ran.
+  REQUIRE(server.con.Query("SELECT * FROM t")->HasError());
+
+  // Without parameters, every statement runs.
+  headers = server.Headers("script");
+  headers.emplace("X-DuckDB-UI-Run-Mode", "script");
+  res = server.Post("/ddb/run", headers,
+                    "CREATE TABLE t AS SELECT 42 AS i; SELECT * FROM t;");
+  REQUIRE(res);
+  REQUIRE(res->status == 200);
+  REQUIRE(!Contains(res->body, "Parameters are not supported"));
+  auto count = server.con.Query("SELECT count(*) FROM t");
+  REQUIRE(!count->HasError());
+  REQUIRE(count->GetValue(0, 0).GetValue<int64_t>() == 1);
+}
@@ -0,0 +1,90 @@
+#include "catch.hpp"
+
+#include "test_helpers.hpp"
+#include "utils/serialization.hpp"
+
+#include <duckdb/common/serializer/binary_serializer.hpp>
+#include <duckdb/common/serializer/memory_stream.hpp>
+
+using namespace duckdb;
+using namespace duckdb::ui;
+
+static duckdb::vector<Chunk> MakeIntegerChunks(idx_t chunk_count,
+                                               idx_t rows_per_chunk) {
+  duckdb::vector<Chunk> chunks;
+  for (idx_t i = 0; i < chunk_count; ++i) {
+    DataChunk chunk;
+    FillIntegerChunk(chunk, static_cast<int32_t>(i * rows_per_chunk),
+                     rows_per_chunk);
+    chunks.push_back(
+        {static_cast<uint16_t>(rows_per_chunk), std::move(chunk.data)});
+  }
+  return chunks;
+}
+
+static SuccessResult MakeResult() {
+  SuccessResult result;
+  result.column_names_and_types.names.push_back("i");
+  result.column_names_and_types.types.push_back(LogicalType::INTEGER);
+  result.total_row_count = 10000;
+  return result;
+}
+
+static std::string ToString(MemoryStream &stream) {
+  return std::string(reinterpret_cast<const char *>(stream.GetData()),
+                     stream.GetPosition());
+}
+
+TEST_CASE("Chunks encoded in parallel match a sequential encoding", "[ui]") {
+  DuckDB db(nullptr);
+  Connection con(db);
+
+  // Encoded on one thread, in the order of the result.
+  auto expected_result = MakeResult();
+  expected_result.chunks = MakeIntegerChunks(100, 100);
+  MemoryStream expected_stream;
+  BinarySerializer::Serialize(expected_result, expected_stream);
+  const auto expected = ToString(expected_stream);
+
+  for (auto threads : {1, 8}) {
+    REQUIRE(!con.Query("SET threads = " + std::to_string(threads))
+                 ->HasError());
+    MemoryStream chunk_stream;
+    ChunkSerializer serializer(*con.context, chunk_stream);
+    // Appended a few at a time, like batches from the fetch loop.
+    auto chunks = MakeIntegerChunks(100, 100);
+    for (idx_t i = 0; i < chunks.size(); i += 3) {
+      duckdb::vector<Chunk> batch;
+      for (idx_t j = i; j < MinValue<idx_t>(i + 3, chunks.size()); ++j) {
+        batch.push_back(std::move(chunks[j]));
+      }
+      serializer.Append(batch);
+      REQUIRE(batch.empty());
+    }
+
+    auto result = MakeResult();
+    std::string head;
+    std::string tail;
+    serializer.SerializeResult(result, head, tail);
+    REQUIRE(serializer.GetChunkCount() == 100);
+    REQUIRE(head + ToString(chunk_stream) + tail == expected);
+  }
+}
+
+TEST_CASE("A result without chunks has an empty chunk list", "[ui]") {
+  DuckDB db(nullptr);
+  Connection con(db);
+
+  auto expected_result = MakeResult();
+  MemoryStream expected_stream;
+  BinarySerializer::Serialize(expected_result, expected_stream);
+
+  MemoryStream chunk_stream;
+  ChunkSerializer serializer(*con.context, chunk_stream);
+  auto result = MakeResult();
+  std::string head;
+  std::string tail;
+  serializer.SerializeResult(result, head, tail);
+  REQUIRE(chunk_stream.GetPosition() == 0);
+  REQUIRE(head + tail == ToString(expected_stream));
+}
@@ -0,0 +1,34 @@
+#include "catch.hpp"
+
+#include "test_helpers.hpp"
+
+#ifndef _WIN32
+#include <sys/stat.h>
+
+using namespace duckdb;
+using namespace duckdb::ui;
+
+TEST_CASE("Only the owner can use the socket file", "[ui]") {
+  const std::string path = "ui_socket_test.sock";
+  const auto umask_before = umask(S_IWGRP | S_IWOTH);
+  umask(umask_before);
+
+  TestServer server(14303);
+  server.Query("SET ui_socket_path = '" + path + "'");
+  server.Start();
+
+  struct stat info;
+  REQUIRE(lstat(path.c_str(), &info) == 0);
+  REQUIRE(S_ISSOCK(info.st_mode));
+  REQUIRE((info.st_mode & (S_IRWXU | S_IRWXG | S_IRWXO)) ==
+          (S_IRUSR | S_IWUSR));
+  // Binding left the process's umask as it was.
+  REQUIRE(umask(umask_before) == umask_before);
+
+  duckdb_httplib_openssl::Client client(path, 80);
+  client.set_address_family(AF_UNIX);
+  auto res = client.Get("/info");
+  REQUIRE(res);
+  REQUIRE(res->status == 200);
+}
+#endif
@@ -0,0 +1,130 @@
+#include "catch.hpp"
+
+#include "statement_cache.hpp"
+
+using namespace duckdb;
+using namespace duckdb::ui;
+
+TEST_CASE("Statement cache hits return independent copies", "[ui]") {
+  DuckDB db(nullptr);
+  Connection con(db);
+  StatementCache cache;
+  cache.SetCapacity(2);
+
+  auto first = cache.ExtractStatements(con, "SELECT 42 AS answer");
+  REQUIRE(first.size() == 1);
+  const auto text = first[0]->ToString();
+  // The caller may consume what it gets.
+  first.clear();
+
+  auto second = cache.ExtractStatements(con, "SELECT 42 AS answer");
+  REQUIRE(second.size() == 1);
+  REQUIRE(second[0]->ToString() == text);
+
+  auto stats = cache.GetStats();
+  REQUIRE(stats.hits == 1);
+  REQUIRE(stats.misses == 1);
+  REQUIRE(stats.entries == 1);
+
+  auto result = con.Query(std::move(second[0]));
+  REQUIRE(!result->HasError());
+  REQUIRE(result->GetValue(0, 0).GetValue<int32_t>() == 42);
+}
+
+TEST_CASE("Statement cache evicts the least recently used", "[ui]") {
+  DuckDB db(nullptr);
+  Connection con(db);
+  StatementCache cache;
+  cache.SetCapacity(2);
+
+  cache.ExtractStatements(con, "SELECT 1");
+  cache.ExtractStatements(con, "SELECT 2");
+  // Makes "SELECT 2" the least recently used.
+  cache.ExtractStatements(con, "SELECT 1");
+  cache.ExtractStatements(con, "SELECT 3");
+  REQUIRE(cache.GetStats().entries == 2);
+  REQUIRE(cache.GetStats().hits == 1);
+
+  cache.ExtractStatements(con, "SELECT 1");
+  REQUIRE(cache.GetStats().hits == 2);
+  cache.ExtractStatements(con, "SELECT 2");
+  REQUIRE(cache.GetStats().hits == 2);
+  REQUIRE(cache.GetStats().misses == 4);
+
+  cache.SetCapacity(0);
+  REQUIRE(cache.GetStats().entries == 0);
+  cache.ExtractStatements(con, "SELECT 1");
+  REQUIRE(cache.GetStats().entries == 0);
+}
+
+TEST_CASE("Statement cache is invalidated by parser settings", "[ui]") {
+  DuckDB db(nullptr);
+  Connection con(db);
+  StatementCache cache;
+  cache.SetCapacity(8);
+
+  const std::string sql = "SELECT 7 / 2";
+  cache.ExtractStatements(con, sql);
+  cache.ExtractStatements(con, sql);
+  REQUIRE(cache.GetStats().hits == 1);
+
+  REQUIRE(!con.Query("SET integer_division = true")->HasError());
+  auto statements = cache.ExtractStatements(con, sql);
+  REQUIRE(cache.GetStats().hits == 1);
+  REQUIRE(cache.GetStats().misses == 2);
+  // Replaced, not added.
+  REQUIRE(cache.GetStats().entries == 1);
+  auto result = con.Query(std::move(statements[0]));
+  REQUIRE(result->GetValue(0, 0).GetValue<int32_t>() == 3);
+}
+
+TEST_CASE("Statement cache doesn't keep PRAGMA statements", "[ui]") {
+  DuckDB db(nullptr);
+  Connection con(db);
+  REQUIRE(!con.Query("CREATE TABLE t (i INTEGER)")->HasError());
+  StatementCache cache;
+  cache.SetCapacity(8);
+
+  // Expanded to a query, which depends on the state of the database.
+  auto statements = cache.ExtractStatements(con, "PRAGMA table_info('t')");
+  REQUIRE(statements.size() == 1);
+  REQUIRE(cache.GetStats().entries == 0);
+}
+
+TEST_CASE("Statement cache is bounded by bytes", "[ui]") {
+  DuckDB db(nullptr);
+  Connection con(db);
+  StatementCache cache;
+  cache.SetCapacity(100);
+
+  const std::string first = "SELECT 1 AS first_column";
+  const std::string second = "SELECT 2 AS second_column";
+  const idx_t per_byte = StatementCache::ENTRY_BYTES_PER_SQL_BYTE;
+  // Room for one of them only.
+  const idx_t max_bytes = (first.size() + second.size()) * per_byte - 1;
+  cache.SetMaxBytes(max_bytes);
+
+  cache.ExtractStatements(con, first);
+  REQUIRE(cache.GetStats().entries == 1);
+  REQUIRE(cache.GetStats().bytes == first.size() * per_byte);
+  cache.ExtractStatements(con, second);
+  REQUIRE(cache.GetStats().entries == 1);
+  REQUIRE(cache.GetStats().bytes == second.size() * per_byte);
+  // The first was evicted.
+  cache.ExtractStatements(con, first);
+  REQUIRE(cache.GetStats().hits == 0);
+
+  // SQL larger than the limit is parsed, but not cached.
+  std::string large = "SELECT 1";
+  while (large.size() * per_byte <= max_bytes) {
+    large += " + 1";
+  }
+  auto statements = cache.ExtractStatements(con, large);
+  REQUIRE(statements.size() == 1);
+  REQUIRE(cache.GetStats().entries == 1);
+  REQUIRE(cache.GetStats().bytes == first.size() * per_byte);
+
+  cache.SetMaxBytes(0);
+  REQUIRE(cache.GetStats().entries == 0);
+  REQUIRE(cache.GetStats().bytes == 0);
+}
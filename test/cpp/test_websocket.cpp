@@ -0,0 +1,231 @@
+#include "catch.hpp"
+
+#include "test_helpers.hpp"
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace duckdb;
+using namespace duckdb::ui;
+
+static const uint16_t WEBSOCKET_PORT = 14305;
+
+// A message from the server: `<request id> <kind> <payload>`.
+struct ServerMessage {
+  uint32_t request_id = 0;
+  uint8_t kind = 0;
+  std::string payload;
+};
+
+// A minimal client: enough of RFC 6455 to exchange unfragmented messages.
+class TestWebSocket {
+public:
+  TestWebSocket() : socket(::socket(AF_INET, SOCK_STREAM, 0)) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(WEBSOCKET_PORT);
+    connected = connect(socket, reinterpret_cast<sockaddr *>(&address),
+                        sizeof(address)) == 0;
+    timeval timeout{10, 0};
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  }
+
+  ~TestWebSocket() { close(socket); }
+
+  // Returns the server's response to the upgrade request.
+  std::string Handshake(const std::string &origin) {
+    const auto request = StringUtil::Format(
+        "GET /ddb/ws HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\n"
+        "Connection: Upgrade\r\nSec-WebSocket-Version: 13\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nOrigin: %s\r\n\r\n",
+        origin);
+    SendAll(request);
+    std::string response;
+    char byte;
+    while (response.find("\r\n\r\n") == std::string::npos &&
+           recv(socket, &byte, 1, 0) == 1) {
+      response += byte;
+    }
+    return response;
+  }
+
+  // Sends one masked frame.
+  void Send(uint8_t opcode, const std::string &payload) {
+    std::string frame;
+    frame += static_cast<char>(0x80 | opcode);
+    if (payload.size() < 126) {
+      frame += static_cast<char>(0x80 | payload.size());
+    } else {
+      frame += static_cast<char>(0x80 | 126);
+      frame += static_cast<char>(payload.size() >> 8);
+      frame += static_cast<char>(payload.size() & 0xFF);
+    }
+    const char mask[4] = {0x12, 0x34, 0x56, 0x78};
+    frame.append(mask, 4);
+    for (idx_t i = 0; i < payload.size(); ++i) {
+      frame += static_cast<char>(payload[i] ^ mask[i % 4]);
+    }
+    SendAll(frame);
+  }
+
+  // Reads the next binary message. Returns false once the server closed the
+  // connection, or sent nothing in time.
+  bool Receive(ServerMessage &message) {
+    uint8_t header[2];
+    if (!ReceiveExactly(reinterpret_cast<char *>(header), 2)) {
+      return false;
+    }
+    uint64_t length = header[1] & 0x7F;
+    if (length >= 126) {
+      const idx_t size = length == 126 ? 2 : 8;
+      uint8_t extended[8];
+      if (!ReceiveExactly(reinterpret_cast<char *>(extended), size)) {
+        return false;
+      }
+      length = 0;
+      for (idx_t i = 0; i < size; ++i) {
+        length = (length << 8) | extended[i];
+      }
+    }
+    std::string payload(length, '\0');
+    if (!ReceiveExactly(&payload[0], length)) {
+      return false;
+    }
+    if ((header[0] & 0x0F) == 0x8) {
+      server_closed = true;
+      return false;
+    }
+    if ((header[0] & 0x0F) != 0x2) {
+      return Receive(message);
+    }
+    REQUIRE(payload.size() >= 5);
+    message.request_id = 0;
+    for (idx_t i = 0; i < 4; ++i) {
+      message.request_id |= static_cast<uint32_t>(
+                                static_cast<uint8_t>(payload[i]))
+                            << (8 * i);
+    }
+    message.kind = static_cast<uint8_t>(payload[4]);
+    message.payload = payload.substr(5);
+    return true;
+  }
+
+  bool connected;
+  // Whether the server closed the connection, rather than going quiet.
+  bool server_closed = false;
+
+private:
+  void SendAll(const std::string &data) {
+    REQUIRE(send(socket, data.data(), data.size(), 0) ==
+            static_cast<ssize_t>(data.size()));
+  }
+
+  bool ReceiveExactly(char *buffer, idx_t size) {
+    while (size > 0) {
+      auto received = recv(socket, buffer, size, 0);
+      if (received <= 0) {
+        server_closed = server_closed || received == 0;
+        return false;
+      }
+      buffer += received;
+      size -= static_cast<idx_t>(received);
+    }
+    return true;
+  }
+
+  int socket;
+};
+
+static void StartServer(TestServer &server) {
+  server.Query(StringUtil::Format("SET ui_websocket_port = %d",
+                                  static_cast<int>(WEBSOCKET_PORT)));
+  server.Start();
+}
+
+TEST_CASE("WebSocket requests are answered with data and a status", "[ui]") {
+  TestServer server(14304);
+  StartServer(server);
+
+  TestWebSocket client;
+  REQUIRE(client.connected);
+  const auto response = client.Handshake(server.Url());
+  REQUIRE(StringUtil::StartsWith(response, "HTTP/1.1 101"));
+  // The accept key of the example in RFC 6455, section 1.3.
+  REQUIRE(response.find("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzhZRbK+xOo=") !=
+          std::string::npos);
+
+  client.Send(0x1, "run 7\nX-DuckDB-UI-Connection-Name: websocket\n\n"
+                   "SELECT 42 AS answer");
+  ServerMessage message;
+  idx_t data_size = 0;
+  while (true) {
+    REQUIRE(client.Receive(message));
+    if (message.request_id == 0) {
+      // Events can arrive at any time.
+      continue;
+    }
+    REQUIRE(message.request_id == 7);
+    if (message.kind != 0) {
+      break;
+    }
+    data_size += message.payload.size();
+  }
+  REQUIRE(message.kind == 1);
+  REQUIRE(message.payload.size() == 2);
+  REQUIRE((static_cast<uint8_t>(message.payload[0]) |
+           static_cast<uint8_t>(message.payload[1]) << 8) == 200);
+  REQUIRE(data_size > 0);
+}
+
+TEST_CASE("WebSocket clients receive events as they happen", "[ui]") {
+  TestServer server(14304);
+  StartServer(server);
+
+  TestWebSocket client;
+  REQUIRE(client.connected);
+  REQUIRE(StringUtil::StartsWith(client.Handshake(server.Url()),
+                                 "HTTP/1.1 101"));
+
+  // No request is in flight; the catalog watcher's event wakes the reader.
+  server.Query("CREATE TABLE t (i INTEGER)");
+  ServerMessage message;
+  bool received_event = false;
+  while (!received_event && client.Receive(message)) {
+    REQUIRE(message.request_id == 0);
+    REQUIRE(message.kind == 2);
+    received_event = message.payload.find("event: CatalogChangeEvent") !=
+                     std::string::npos;
+  }
+  REQUIRE(received_event);
+}
+
+TEST_CASE("WebSocket connections refuse malformed frames", "[ui]") {
+  TestServer server(14304);
+  StartServer(server);
+
+  SECTION("the wrong origin") {
+    TestWebSocket client;
+    REQUIRE(client.connected);
+    REQUIRE(StringUtil::StartsWith(client.Handshake("http://example.com"),
+                                   "HTTP/1.1 401"));
+  }
+
+  SECTION("a control frame over 125 bytes") {
+    TestWebSocket client;
+    REQUIRE(client.connected);
+    REQUIRE(StringUtil::StartsWith(client.Handshake(server.Url()),
+                                   "HTTP/1.1 101"));
+    client.Send(0x9, std::string(126, 'x'));
+    ServerMessage message;
+    while (client.Receive(message)) {
+      // Only events can come before the connection closes.
+      REQUIRE(message.request_id == 0);
+    }
+    REQUIRE(client.server_closed);
+  }
+}
+#endif
@@ -45,8 +45,28 @@ export class DuckDBUIClient {
     this.eventSource.removeEventListener(type, listener);
   }
 
-  public connect() {
-    return new DuckDBUIClientConnection();
+  /**
+   * Calls `listener` with the id of each database instance whose catalog
+   * changed. Returns a function removing the listener.
+   */
+  public addCatalogChangeEventListener(
+    listener: (instanceId: string) => void,
+  ): () => void {
+    const messageListener = (event: MessageEvent) => {
+      listener(String(event.data));
+    };
+    this.eventSource.addEventListener('CatalogChangeEvent', messageListener);
+    return () => {
+      this.eventSource.removeEventListener(
+        'CatalogChangeEvent',
+        messageListener,
+      );
+    };
+  }
+
+  /** Connects to the given database instance, or the server's default one. */
+  public connect(instanceId?: string) {
+    return new DuckDBUIClientConnection(instanceId);
   }
 
   public get connection(): DuckDBUIClientConnection {
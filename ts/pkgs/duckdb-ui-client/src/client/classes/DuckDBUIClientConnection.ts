@@ -12,6 +12,9 @@ export class DuckDBUIClientConnection {
   private readonly requestQueue: DuckDBUIHttpRequestQueue =
     new DuckDBUIHttpRequestQueue();
 
+  /** Runs on the given database instance, or the server's default one. */
+  public constructor(private readonly instanceId?: string) {}
+
   public async run(
     sql: string,
     options?: DuckDBUIRunOptions,
@@ -63,6 +66,7 @@ export class DuckDBUIClientConnection {
     return makeDuckDBUIHttpRequestHeaders({
       ...options,
       connectionName: this.connectionName,
+      instanceId: this.instanceId,
     });
   }
 }
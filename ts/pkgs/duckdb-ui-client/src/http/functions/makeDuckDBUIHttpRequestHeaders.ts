@@ -3,11 +3,14 @@ import { toBase64 } from '../../util/functions/toBase64.js';
 
 export interface DuckDBUIHttpRequestHeaderOptions extends DuckDBUIRunOptions {
   connectionName?: string;
+  /** The database instance to use, as in CatalogChangeEvent. Defaults to the server's default instance. */
+  instanceId?: string;
 }
 
 export function makeDuckDBUIHttpRequestHeaders({
   description,
   connectionName,
+  instanceId,
   databaseName,
   schemaName,
   errorsAsJson,
@@ -26,6 +29,9 @@ export function makeDuckDBUIHttpRequestHeaders({
   if (connectionName) {
     headers.append('X-DuckDB-UI-Connection-Name', connectionName);
   }
+  if (instanceId) {
+    headers.append('X-DuckDB-UI-Instance', instanceId);
+  }
   if (databaseName) {
     headers.append('X-DuckDB-UI-Database-Name', toBase64(databaseName));
   }
@@ -16,6 +16,13 @@ suite('makeDuckDBUIHttpRequestHeaders', () => {
       }).entries(),
     ]).toEqual([['x-duckdb-ui-connection-name', 'example connection name']]);
   });
+  test('instance id', () => {
+    expect([
+      ...makeDuckDBUIHttpRequestHeaders({
+        instanceId: 'example instance id',
+      }).entries(),
+    ]).toEqual([['x-duckdb-ui-instance', 'example instance id']]);
+  });
   test('database name', () => {
     // should be base64 encoded
     expect([